@@ -25,11 +25,18 @@
 
 #import "MUK.h"
 
+@class MUKArrayPipeline, MUKArrayView, MUKArrayDiff;
+
 typedef enum : NSUInteger {
     MUKArrayTransformIdentity   =   0,
     MUKArrayTransformReverse
 } MUKArrayTransform;
 
+typedef enum : NSUInteger {
+    MUKArrayDiffAlgorithmHash   =   0,
+    MUKArrayDiffAlgorithmMyers
+} MUKArrayDiffAlgorithm;
+
 /**
  Methods involving arrays.
  
@@ -40,7 +47,26 @@ typedef enum : NSUInteger {
  `MUKArrayTransform` enumerates kinds of transform you can apply to an
  array:
  * `MUKArrayTransformIdentity` returns array untouched.
- * `MUKArrayTransformReverse` reverses the array.
+ * `MUKArrayTransformReverse` reverses the array. Returned array is a 
+ MUKArrayView, so objects are not moved. Immutable arrays are reversed in
+ constant time; mutable arrays are copied first (in linear time), so later
+ mutations do not affect returned array. `nil` gives `nil`.
+ 
+ ### MUKArrayDiffAlgorithm
+ 
+ `MUKArrayDiffAlgorithm` enumerates algorithms you can use to compare arrays:
+ * `MUKArrayDiffAlgorithmHash` pairs objects with the same identity wherever
+ they are, in linear time, and reports objects which changed relative order as
+ moves.
+ * `MUKArrayDiffAlgorithmMyers` pairs objects of a longest common subsequence,
+ in O(ND) time (D is the number of inserted and deleted objects). It never 
+ reports moves: an object which changed relative order is deleted and 
+ inserted again.
+ 
+ ## Pipelines
+ 
+ If you need to chain many operations use pipelineWithArray:, which fuses
+ them without building intermediate arrays (see MUKArrayPipeline).
  
  */
 @interface MUK (Array)
@@ -75,6 +101,30 @@ typedef enum : NSUInteger {
  @return Given `array` mapped with `block`.
  */
 + (NSArray *)array:(NSArray *)array map:(id (^)(id obj, NSInteger index, BOOL *exclude, BOOL *stop))block;
+/**
+ Map an array with a block, running it concurrently on every core.
+ 
+ This method has the same semantics of array:map: and returned array is in
+ the same order of given `array`, but `block` is invoked concurrently from
+ many threads and in no particular order. Use it when mapping of single
+ objects is expensive (parsing, hashing, and so on).
+ 
+ Input is split in chunks which are dispatched on a global concurrent queue.
+ Chunk size is computed measuring how long `block` takes on first objects:
+ if whole mapping is estimated to be cheap, it is completed serially.
+ 
+ When `block` sets `*stop` to `YES` at a given index, pending chunks are 
+ cancelled and returned array contains only mapped objects which come before
+ that index. Objects coming after could have been mapped anyway by chunks
+ which were already running, but they are discarded.
+ 
+ @param array Array to map.
+ @param block A thread-safe block which returns an object mapped on an object
+ contained into given `array`. See array:map: for parameters.
+ @return Given `array` mapped with `block`.
+ @see array:map:
+ */
++ (NSArray *)array:(NSArray *)array concurrentlyMap:(id (^)(id obj, NSInteger index, BOOL *exclude, BOOL *stop))block;
 /**
  It transforms a given array.
  
@@ -85,5 +135,53 @@ typedef enum : NSUInteger {
  @return An array produced applying transform on given array.
  */
 + (NSArray *)array:(NSArray *)array applyingTransform:(MUKArrayTransform)transform;
+/**
+ Creates a view over an array, without copying objects.
+ 
+ This is the way to show last objects of a big array in reverse order:
+ 
+    NSRange range = NSMakeRange([messages count] - 30, 30);
+    NSArray *newest = [MUK array:messages viewWithRange:range stride:-1];
+ 
+ @param array Base array.
+ @param range Range of `array` to present. An exception is raised if range is
+ out of bounds.
+ @param stride Distance between presented objects. Negative values read
+ `range` backwards. `0` is considered `1`.
+ @return A MUKArrayView over `array`.
+ @see MUKArrayView
+ */
++ (NSArray *)array:(NSArray *)array viewWithRange:(NSRange)range stride:(NSInteger)stride;
+/**
+ Creates a lazy pipeline over an array.
+ @param array Source array.
+ @return A pipeline without stages. Append stages to it and then ask for
+ results.
+ @see MUKArrayPipeline
+ */
++ (MUKArrayPipeline *)pipelineWithArray:(NSArray *)array;
+/**
+ Computes changes which turn an array into another.
+ 
+ Use it to update a list incrementally instead of reloading it:
+ 
+    MUKArrayDiff *diff = [MUK diffFromArray:oldItems toArray:newItems
+        algorithm:MUKArrayDiffAlgorithmHash identity:^id(id item) {
+            return [item identifier];
+        } equality:nil];
+ 
+ @param oldArray Original array.
+ @param newArray Updated array.
+ @param algorithm Algorithm used to pair objects.
+ @param identityBlock A block which returns a key identifying an object across
+ arrays. Keys are compared with `isEqual:` and they must implement `hash`
+ consistently. If `nil` (or if block returns `nil`), object itself is the key.
+ @param equalityBlock A block which tells if a paired object did not change.
+ When it returns `NO` object is reported as updated. If `nil`, objects are
+ compared with `isEqual:`.
+ @return Changes between arrays.
+ @see MUKArrayDiff
+ */
++ (MUKArrayDiff *)diffFromArray:(NSArray *)oldArray toArray:(NSArray *)newArray algorithm:(MUKArrayDiffAlgorithm)algorithm identity:(id (^)(id obj))identityBlock equality:(BOOL (^)(id oldObj, id newObj))equalityBlock;
 
 @end
@@ -24,6 +24,24 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #import "MUK+Array.h"
+#import "MUKArrayPipeline.h"
+#import "MUKArrayView.h"
+#import "MUKArrayDiff.h"
+
+// Target duration of a single chunk during concurrent mapping
+static CFTimeInterval const kConcurrentMapChunkDuration = 0.001;
+// Maximum number of objects mapped serially to measure cost
+static NSUInteger const kConcurrentMapProbeCount = 16;
+// Minimum number of chunks per core, to balance load
+static NSUInteger const kConcurrentMapChunksPerCore = 4;
+
+static inline void MUKArrayAtomicMinimum(volatile long *value, long candidate) {
+    long current;
+    do {
+        current = *value;
+        if (candidate >= current) return;
+    } while (!__sync_bool_compare_and_swap(value, current, candidate));
+}
 
 @implementation MUK (Array)
 
@@ -57,15 +75,125 @@
     return mappedArray;
 }
 
++ (NSArray *)array:(NSArray *)array concurrentlyMap:(id (^)(id, NSInteger, BOOL *, BOOL *))block
+{
+    NSUInteger const count = [array count];
+    if (block == nil || count == 0) return array;
+    
+    __unsafe_unretained id *objects = (__unsafe_unretained id *)malloc(count * sizeof(id));
+    __strong id *mappedObjects = (__strong id *)calloc(count, sizeof(id));
+    BOOL *exclusions = (BOOL *)calloc(count, sizeof(BOOL));
+    
+    if (!objects || !mappedObjects || !exclusions) {
+        free(objects);
+        free(mappedObjects);
+        free(exclusions);
+        return [self array:array map:block];
+    }
+    
+    // Objects are retained by array: take them once, so threads do not
+    // message array
+    [array getObjects:objects range:NSMakeRange(0, count)];
+    
+    // Lowest index where stop has been requested
+    __block volatile long stopIndex = (long)count;
+    
+    void (^mapObjectAtIndex)(NSUInteger) = ^(NSUInteger idx) {
+        BOOL exclusionRequested = NO, stopRequested = NO;
+        id mappedObject = block(objects[idx], idx, &exclusionRequested, &stopRequested);
+        
+        if (stopRequested) {
+            MUKArrayAtomicMinimum(&stopIndex, (long)idx);
+        }
+        else {
+            mappedObjects[idx] = mappedObject;
+            exclusions[idx] = exclusionRequested;
+        }
+    };
+    
+    // Measure cost mapping first objects serially
+    NSUInteger mappedCount = 0;
+    CFAbsoluteTime probeStartTime = CFAbsoluteTimeGetCurrent();
+    CFTimeInterval probeDuration = 0.0;
+    
+    while (mappedCount < count && mappedCount < kConcurrentMapProbeCount &&
+           probeDuration < kConcurrentMapChunkDuration && stopIndex == (long)count)
+    {
+        mapObjectAtIndex(mappedCount);
+        mappedCount++;
+        probeDuration = CFAbsoluteTimeGetCurrent() - probeStartTime;
+    }
+    
+    if (mappedCount < count && stopIndex == (long)count) {
+        NSUInteger const remainingCount = count - mappedCount;
+        CFTimeInterval const costPerObject = probeDuration / (CFTimeInterval)mappedCount;
+        
+        if (costPerObject * remainingCount < kConcurrentMapChunkDuration) {
+            // Too cheap to pay dispatch overhead
+            for (NSUInteger i = mappedCount; i < count && (long)i < stopIndex; i++) {
+                mapObjectAtIndex(i);
+            }
+        }
+        else {
+            NSUInteger const minimumChunksCount = [[NSProcessInfo processInfo] activeProcessorCount] * kConcurrentMapChunksPerCore;
+            NSUInteger chunkSize = (NSUInteger)(kConcurrentMapChunkDuration / costPerObject);
+            chunkSize = MIN(chunkSize, (remainingCount + minimumChunksCount - 1) / minimumChunksCount);
+            chunkSize = MAX(chunkSize, (NSUInteger)1);
+            
+            NSUInteger const firstIndex = mappedCount;
+            NSUInteger const chunksCount = (remainingCount + chunkSize - 1) / chunkSize;
+            
+            dispatch_apply(chunksCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t chunk)
+            {
+                NSUInteger const chunkStart = firstIndex + chunk * chunkSize;
+                NSUInteger const chunkEnd = MIN(chunkStart + chunkSize, count);
+                
+                @autoreleasepool {
+                    // Pending chunks after stop index are skipped entirely
+                    for (NSUInteger i = chunkStart; i < chunkEnd && (long)i < stopIndex; i++) {
+                        mapObjectAtIndex(i);
+                    }
+                }
+            });
+        }
+    }
+    
+    // Compact results in order
+    NSUInteger const validCount = (NSUInteger)stopIndex;
+    NSMutableArray *mappedArray = [NSMutableArray arrayWithCapacity:validCount];
+    
+    for (NSUInteger i = 0; i < validCount; i++) {
+        if (exclusions[i] == NO) {
+            [mappedArray addObject:(mappedObjects[i] ?: [NSNull null])];
+        }
+    }
+    
+    // Release mapped objects before freeing buffer
+    for (NSUInteger i = 0; i < count; i++) {
+        mappedObjects[i] = nil;
+    }
+    
+    free(objects);
+    free(mappedObjects);
+    free(exclusions);
+    
+    return mappedArray;
+}
+
 + (NSArray *)array:(NSArray *)array applyingTransform:(MUKArrayTransform)transform
 {
     NSArray *output = array;
     
     switch (transform) {
-        case MUKArrayTransformReverse:
-            // Elegant solution from http://stackoverflow.com/a/586529
-            output = [[array reverseObjectEnumerator] allObjects];
+        case MUKArrayTransformReverse: {
+            if (array == nil) break;
+            
+            // Copy is free for immutable arrays and it protects view from
+            // mutations of mutable ones
+            NSArray *baseArray = [array copy];
+            output = [[MUKArrayView alloc] initWithArray:baseArray range:NSMakeRange(0, [baseArray count]) stride:-1];
             break;
+        }
             
         default:
             break;
@@ -74,4 +202,18 @@
     return output;
 }
 
++ (NSArray *)array:(NSArray *)array viewWithRange:(NSRange)range stride:(NSInteger)stride
+{
+    return [[MUKArrayView alloc] initWithArray:array range:range stride:stride];
+}
+
++ (MUKArrayPipeline *)pipelineWithArray:(NSArray *)array {
+    return [[MUKArrayPipeline alloc] initWithArray:array];
+}
+
++ (MUKArrayDiff *)diffFromArray:(NSArray *)oldArray toArray:(NSArray *)newArray algorithm:(MUKArrayDiffAlgorithm)algorithm identity:(id (^)(id))identityBlock equality:(BOOL (^)(id, id))equalityBlock
+{
+    return [[MUKArrayDiff alloc] initWithOldArray:oldArray newArray:newArray algorithm:algorithm identity:identityBlock equality:equalityBlock];
+}
+
 @end
@@ -0,0 +1,109 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUK+Array.h"
+
+/**
+ Changes which turn an array (old array) into another (new array).
+ 
+ Objects of old array are paired with objects of new array which have the 
+ same identity. Then:
+ 
+ * unpaired objects of old array are deleted;
+ * unpaired objects of new array are inserted;
+ * paired objects which are not equal are updated;
+ * paired objects which changed their relative order are moved (only with
+ `MUKArrayDiffAlgorithmHash`).
+ 
+ Moves are kept to a minimum: objects which are not moved keep their relative
+ order, and they only shift because of other changes.
+ 
+ Changes are expressed like batch updates of `UITableView` want them: deleted,
+ updated and moved indexes refer to old array, inserted indexes and move 
+ destinations refer to new array.
+ 
+ @warning `UITableView` does not let you reload and move the same row in a
+ batch update: reload moved rows (movedIndexes intersected with 
+ updatedIndexes) after the batch update.
+ */
+@interface MUKArrayDiff : NSObject
+/**
+ Indexes of old array which have been deleted.
+ */
+@property (nonatomic, strong, readonly) NSIndexSet *deletedIndexes;
+/**
+ Indexes of new array which have been inserted.
+ */
+@property (nonatomic, strong, readonly) NSIndexSet *insertedIndexes;
+/**
+ Indexes of old array whose objects have been updated.
+ */
+@property (nonatomic, strong, readonly) NSIndexSet *updatedIndexes;
+/**
+ Indexes of old array whose objects have been moved.
+ */
+@property (nonatomic, strong, readonly) NSIndexSet *movedIndexes;
+
+/**
+ Compares two arrays.
+ 
+ See diffFromArray:toArray:algorithm:identity:equality: in MUK(Array).
+ 
+ @param oldArray Original array.
+ @param newArray Updated array.
+ @param algorithm Algorithm used to pair objects.
+ @param identityBlock A block which returns a key identifying an object.
+ @param equalityBlock A block which tells if a paired object did not change.
+ @return A new diff.
+ */
+- (id)initWithOldArray:(NSArray *)oldArray newArray:(NSArray *)newArray algorithm:(MUKArrayDiffAlgorithm)algorithm identity:(id (^)(id obj))identityBlock equality:(BOOL (^)(id oldObj, id newObj))equalityBlock;
+
+/**
+ Tells if arrays are different.
+ @return `YES` if there is at least a change.
+ */
+- (BOOL)hasChanges;
+/**
+ Enumerates moves, in ascending order of destination.
+ @param block A block which takes index of moved object into old array,
+ index of moved object into new array and a pointer to `BOOL` you could set to
+ `YES` to stop enumeration.
+ */
+- (void)enumerateMovesUsingBlock:(void (^)(NSUInteger fromIndex, NSUInteger toIndex, BOOL *stop))block;
+/**
+ Index where an object of old array went.
+ @param oldIndex Index into old array.
+ @return Index into new array or `NSNotFound` if object has been deleted (or
+ if `oldIndex` is out of bounds).
+ */
+- (NSUInteger)newIndexForOldIndex:(NSUInteger)oldIndex;
+/**
+ Index where an object of new array came from.
+ @param newIndex Index into new array.
+ @return Index into old array or `NSNotFound` if object has been inserted (or
+ if `newIndex` is out of bounds).
+ */
+- (NSUInteger)oldIndexForNewIndex:(NSUInteger)newIndex;
+@end
@@ -0,0 +1,441 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUKArrayDiff.h"
+
+#pragma mark - Matching
+
+// Matches equal ids in order of appearance; duplicated ids are paired
+// first-come first-served
+static void MUKArrayDiffMatchByHash(NSUInteger const *oldIds, NSUInteger oldCount, NSUInteger const *newIds, NSUInteger newCount, NSUInteger idCount, NSUInteger *oldToNew, NSUInteger *newToOld)
+{
+    // Every id has a stack of old indexes, linked through nextOldIndexes
+    NSUInteger *heads = malloc(idCount * sizeof(NSUInteger));
+    NSUInteger *nextOldIndexes = malloc(oldCount * sizeof(NSUInteger));
+    
+    for (NSUInteger i = 0; i < idCount; i++) {
+        heads[i] = NSNotFound;
+    } // for
+    
+    for (NSUInteger i = oldCount; i > 0; i--) {
+        NSUInteger const identifier = oldIds[i - 1];
+        nextOldIndexes[i - 1] = heads[identifier];
+        heads[identifier] = i - 1;
+    } // for
+    
+    for (NSUInteger j = 0; j < newCount; j++) {
+        NSUInteger const identifier = newIds[j];
+        NSUInteger const oldIndex = heads[identifier];
+        
+        if (oldIndex != NSNotFound) {
+            heads[identifier] = nextOldIndexes[oldIndex];
+            oldToNew[oldIndex] = j;
+            newToOld[j] = oldIndex;
+        }
+    } // for
+    
+    free(heads);
+    free(nextOldIndexes);
+}
+
+typedef struct {
+    NSUInteger const *oldIds;
+    NSUInteger const *newIds;
+    NSUInteger *oldToNew;
+    NSUInteger *newToOld;
+    long *forwardV;
+    long *backwardV;
+} MUKArrayDiffMyersContext;
+
+static void MUKArrayDiffMyers(MUKArrayDiffMyersContext *context, long oldStart, long oldEnd, long newStart, long newEnd);
+
+// Recurses on both sides of split point
+static void MUKArrayDiffMyersSplit(MUKArrayDiffMyersContext *context, long oldStart, long oldEnd, long newStart, long newEnd, long x, long y)
+{
+    MUKArrayDiffMyers(context, oldStart, oldStart + x, newStart, newStart + y);
+    MUKArrayDiffMyers(context, oldStart + x, oldEnd, newStart + y, newEnd);
+}
+
+// Linear space Myers' algorithm: finds middle snake and recurses on both
+// halves, matching elements of a longest common subsequence
+static void MUKArrayDiffMyers(MUKArrayDiffMyersContext *context, long oldStart, long oldEnd, long newStart, long newEnd)
+{
+    NSUInteger const *a = context->oldIds;
+    NSUInteger const *b = context->newIds;
+    
+    // Common prefix and suffix
+    while (oldStart < oldEnd && newStart < newEnd && a[oldStart] == b[newStart]) {
+        context->oldToNew[oldStart] = (NSUInteger)newStart;
+        context->newToOld[newStart] = (NSUInteger)oldStart;
+        oldStart++;
+        newStart++;
+    } // while
+    
+    while (oldStart < oldEnd && newStart < newEnd && a[oldEnd - 1] == b[newEnd - 1]) {
+        oldEnd--;
+        newEnd--;
+        context->oldToNew[oldEnd] = (NSUInteger)newEnd;
+        context->newToOld[newEnd] = (NSUInteger)oldEnd;
+    } // while
+    
+    long const n = oldEnd - oldStart, m = newEnd - newStart;
+    if (n == 0 || m == 0) return;
+    
+    if (n == 1 || m == 1) {
+        // Single element can match once, at most
+        for (long i = oldStart; i < oldEnd; i++) {
+            for (long j = newStart; j < newEnd; j++) {
+                if (a[i] == b[j]) {
+                    context->oldToNew[i] = (NSUInteger)j;
+                    context->newToOld[j] = (NSUInteger)i;
+                    return;
+                }
+            } // for
+        } // for
+        
+        return;
+    }
+    
+    long const maxD = (n + m + 1) / 2;
+    long const offset = maxD;
+    long const length = 2 * maxD + 2;
+    long *v1 = context->forwardV, *v2 = context->backwardV;
+    
+    for (long i = 0; i < length; i++) {
+        v1[i] = v2[i] = -1;
+    } // for
+    v1[offset + 1] = 0;
+    v2[offset + 1] = 0;
+    
+    long const delta = n - m;
+    BOOL const front = (delta % 2 != 0);
+    long k1Start = 0, k1End = 0, k2Start = 0, k2End = 0;
+    
+    for (long d = 0; d < maxD; d++) {
+        // Forward path
+        for (long k1 = -d + k1Start; k1 <= d - k1End; k1 += 2) {
+            long const k1Offset = offset + k1;
+            long x1 = (k1 == -d || (k1 != d && v1[k1Offset - 1] < v1[k1Offset + 1]) ? v1[k1Offset + 1] : v1[k1Offset - 1] + 1);
+            long y1 = x1 - k1;
+            
+            while (x1 < n && y1 < m && a[oldStart + x1] == b[newStart + y1]) {
+                x1++;
+                y1++;
+            } // while
+            
+            v1[k1Offset] = x1;
+            
+            if (x1 > n) {
+                k1End += 2;
+            }
+            else if (y1 > m) {
+                k1Start += 2;
+            }
+            else if (front) {
+                long const k2Offset = offset + delta - k1;
+                if (k2Offset >= 0 && k2Offset < length && v2[k2Offset] != -1) {
+                    if (x1 >= n - v2[k2Offset]) {
+                        MUKArrayDiffMyersSplit(context, oldStart, oldEnd, newStart, newEnd, x1, y1);
+                        return;
+                    }
+                }
+            }
+        } // for
+        
+        // Backward path
+        for (long k2 = -d + k2Start; k2 <= d - k2End; k2 += 2) {
+            long const k2Offset = offset + k2;
+            long x2 = (k2 == -d || (k2 != d && v2[k2Offset - 1] < v2[k2Offset + 1]) ? v2[k2Offset + 1] : v2[k2Offset - 1] + 1);
+            long y2 = x2 - k2;
+            
+            while (x2 < n && y2 < m && a[oldEnd - x2 - 1] == b[newEnd - y2 - 1]) {
+                x2++;
+                y2++;
+            } // while
+            
+            v2[k2Offset] = x2;
+            
+            if (x2 > n) {
+                k2End += 2;
+            }
+            else if (y2 > m) {
+                k2Start += 2;
+            }
+            else if (!front) {
+                long const k1Offset = offset + delta - k2;
+                if (k1Offset >= 0 && k1Offset < length && v1[k1Offset] != -1) {
+                    long const x1 = v1[k1Offset];
+                    long const y1 = offset + x1 - k1Offset;
+                    
+                    if (x1 >= n - x2) {
+                        MUKArrayDiffMyersSplit(context, oldStart, oldEnd, newStart, newEnd, x1, y1);
+                        return;
+                    }
+                }
+            }
+        } // for
+    } // for
+    
+    // Nothing in common
+}
+
+static void MUKArrayDiffMatchByMyers(NSUInteger const *oldIds, NSUInteger oldCount, NSUInteger const *newIds, NSUInteger newCount, NSUInteger *oldToNew, NSUInteger *newToOld)
+{
+    long const length = 2 * (long)((oldCount + newCount + 1) / 2) + 2;
+    
+    MUKArrayDiffMyersContext context;
+    context.oldIds = oldIds;
+    context.newIds = newIds;
+    context.oldToNew = oldToNew;
+    context.newToOld = newToOld;
+    context.forwardV = malloc((size_t)length * sizeof(long));
+    context.backwardV = malloc((size_t)length * sizeof(long));
+    
+    MUKArrayDiffMyers(&context, 0, (long)oldCount, 0, (long)newCount);
+    
+    free(context.forwardV);
+    free(context.backwardV);
+}
+
+#pragma mark - Moves
+
+// Marks matched new indexes which keep their relative order, using a longest
+// increasing subsequence of old indexes: every other match is a move
+static void MUKArrayDiffMarkStableMatches(NSUInteger const *newToOld, NSUInteger newCount, BOOL *stable)
+{
+    // tails[l] is new index ending the smallest increasing subsequence
+    // of length l + 1
+    NSUInteger *tails = malloc((newCount + 1) * sizeof(NSUInteger));
+    NSUInteger *predecessors = malloc((newCount + 1) * sizeof(NSUInteger));
+    NSUInteger length = 0;
+    
+    for (NSUInteger j = 0; j < newCount; j++) {
+        stable[j] = NO;
+        
+        NSUInteger const oldIndex = newToOld[j];
+        if (oldIndex == NSNotFound) continue;
+        
+        NSUInteger low = 0, high = length;
+        while (low < high) {
+            NSUInteger const middle = (low + high) / 2;
+            if (newToOld[tails[middle]] < oldIndex) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        } // while
+        
+        predecessors[j] = (low > 0 ? tails[low - 1] : NSNotFound);
+        tails[low] = j;
+        if (low == length) length++;
+    } // for
+    
+    NSUInteger j = (length > 0 ? tails[length - 1] : NSNotFound);
+    while (j != NSNotFound) {
+        stable[j] = YES;
+        j = predecessors[j];
+    } // while
+    
+    free(tails);
+    free(predecessors);
+}
+
+#pragma mark -
+
+@implementation MUKArrayDiff {
+    NSUInteger oldCount_, newCount_;
+    NSUInteger *oldToNew_, *newToOld_;
+    BOOL *movedNewIndexes_;
+}
+
+@synthesize deletedIndexes = deletedIndexes_;
+@synthesize insertedIndexes = insertedIndexes_;
+@synthesize updatedIndexes = updatedIndexes_;
+@synthesize movedIndexes = movedIndexes_;
+
+- (id)initWithOldArray:(NSArray *)oldArray newArray:(NSArray *)newArray algorithm:(MUKArrayDiffAlgorithm)algorithm identity:(id (^)(id))identityBlock equality:(BOOL (^)(id, id))equalityBlock
+{
+    self = [super init];
+    if (self) {
+        oldCount_ = [oldArray count];
+        newCount_ = [newArray count];
+        oldToNew_ = malloc((oldCount_ + 1) * sizeof(NSUInteger));
+        newToOld_ = malloc((newCount_ + 1) * sizeof(NSUInteger));
+        movedNewIndexes_ = calloc(newCount_ + 1, sizeof(BOOL));
+        
+        for (NSUInteger i = 0; i < oldCount_; i++) {
+            oldToNew_[i] = NSNotFound;
+        } // for
+        
+        for (NSUInteger j = 0; j < newCount_; j++) {
+            newToOld_[j] = NSNotFound;
+        } // for
+        
+        // Turn identities into small integers, so algorithms compare ids
+        NSUInteger *oldIds = malloc((oldCount_ + 1) * sizeof(NSUInteger));
+        NSUInteger *newIds = malloc((newCount_ + 1) * sizeof(NSUInteger));
+        NSUInteger idCount = [self assignIds_:oldIds newIds:newIds oldArray:oldArray newArray:newArray identity:identityBlock];
+        
+        switch (algorithm) {
+            case MUKArrayDiffAlgorithmMyers:
+                MUKArrayDiffMatchByMyers(oldIds, oldCount_, newIds, newCount_, oldToNew_, newToOld_);
+                break;
+            
+            default:
+                MUKArrayDiffMatchByHash(oldIds, oldCount_, newIds, newCount_, idCount, oldToNew_, newToOld_);
+                break;
+        }
+        
+        free(oldIds);
+        free(newIds);
+        
+        // Collect changes
+        BOOL *stableMatches = malloc((newCount_ + 1) * sizeof(BOOL));
+        MUKArrayDiffMarkStableMatches(newToOld_, newCount_, stableMatches);
+        
+        NSMutableIndexSet *deletedIndexes = [[NSMutableIndexSet alloc] init];
+        NSMutableIndexSet *insertedIndexes = [[NSMutableIndexSet alloc] init];
+        NSMutableIndexSet *updatedIndexes = [[NSMutableIndexSet alloc] init];
+        NSMutableIndexSet *movedIndexes = [[NSMutableIndexSet alloc] init];
+        
+        for (NSUInteger i = 0; i < oldCount_; i++) {
+            if (oldToNew_[i] == NSNotFound) {
+                [deletedIndexes addIndex:i];
+            }
+        } // for
+        
+        for (NSUInteger j = 0; j < newCount_; j++) {
+            NSUInteger const oldIndex = newToOld_[j];
+            
+            if (oldIndex == NSNotFound) {
+                [insertedIndexes addIndex:j];
+                continue;
+            }
+            
+            if (!stableMatches[j]) {
+                movedNewIndexes_[j] = YES;
+                [movedIndexes addIndex:oldIndex];
+            }
+            
+            id oldObject = [oldArray objectAtIndex:oldIndex];
+            id newObject = [newArray objectAtIndex:j];
+            BOOL const equal = (equalityBlock ? equalityBlock(oldObject, newObject) : (oldObject == newObject || [oldObject isEqual:newObject]));
+            
+            if (!equal) {
+                [updatedIndexes addIndex:oldIndex];
+            }
+        } // for
+        
+        free(stableMatches);
+        
+        deletedIndexes_ = [deletedIndexes copy];
+        insertedIndexes_ = [insertedIndexes copy];
+        updatedIndexes_ = [updatedIndexes copy];
+        movedIndexes_ = [movedIndexes copy];
+    }
+    
+    return self;
+}
+
+- (id)init {
+    return [self initWithOldArray:nil newArray:nil algorithm:MUKArrayDiffAlgorithmHash identity:nil equality:nil];
+}
+
+- (void)dealloc {
+    free(oldToNew_);
+    free(newToOld_);
+    free(movedNewIndexes_);
+}
+
+#pragma mark - Queries
+
+- (BOOL)hasChanges {
+    return [deletedIndexes_ count] > 0 || [insertedIndexes_ count] > 0 || [updatedIndexes_ count] > 0 || [movedIndexes_ count] > 0;
+}
+
+- (void)enumerateMovesUsingBlock:(void (^)(NSUInteger, NSUInteger, BOOL *))block
+{
+    if (block == nil || [movedIndexes_ count] == 0) return;
+    
+    BOOL stop = NO;
+    for (NSUInteger j = 0; j < newCount_ && !stop; j++) {
+        if (movedNewIndexes_[j]) {
+            block(newToOld_[j], j, &stop);
+        }
+    } // for
+}
+
+- (NSUInteger)newIndexForOldIndex:(NSUInteger)oldIndex {
+    return (oldIndex < oldCount_ ? oldToNew_[oldIndex] : NSNotFound);
+}
+
+- (NSUInteger)oldIndexForNewIndex:(NSUInteger)newIndex {
+    return (newIndex < newCount_ ? newToOld_[newIndex] : NSNotFound);
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p> deleted: %@, inserted: %@, updated: %@, moved: %@", NSStringFromClass([self class]), self, deletedIndexes_, insertedIndexes_, updatedIndexes_, movedIndexes_];
+}
+
+#pragma mark - Private
+
+- (NSUInteger)assignIds_:(NSUInteger *)oldIds newIds:(NSUInteger *)newIds oldArray:(NSArray *)oldArray newArray:(NSArray *)newArray identity:(id (^)(id))identityBlock
+{
+    // Keys are compared with -hash and -isEqual:, values are ids
+    CFMutableDictionaryRef idsByKey = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, &kCFTypeDictionaryKeyCallBacks, NULL);
+    __block NSUInteger idCount = 0;
+    
+    NSUInteger (^idOfObject)(id) = ^(id object) {
+        id key = (identityBlock ? identityBlock(object) : nil) ?: object;
+        void const *value = NULL;
+        
+        if (CFDictionaryGetValueIfPresent(idsByKey, (__bridge void const *)key, &value))
+        {
+            return (NSUInteger)(uintptr_t)value;
+        }
+        
+        NSUInteger const identifier = idCount++;
+        CFDictionarySetValue(idsByKey, (__bridge void const *)key, (void const *)(uintptr_t)identifier);
+        return identifier;
+    };
+    
+    NSUInteger i = 0;
+    for (id object in oldArray) {
+        oldIds[i++] = idOfObject(object);
+    } // for
+    
+    i = 0;
+    for (id object in newArray) {
+        newIds[i++] = idOfObject(object);
+    } // for
+    
+    CFRelease(idsByKey);
+    return idCount;
+}
+
+@end
@@ -0,0 +1,113 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUK+Array.h"
+
+/**
+ A lazy sequence of operations over an array.
+ 
+ Chaining array:map: and array:applyingTransform: builds a whole intermediate
+ array at every step. A pipeline, instead, only records stages (map, filter,
+ reverse, take and drop) and it runs them in a single fused pass when you ask
+ for results with array or enumerateObjectsUsingBlock:.
+ 
+    NSArray *titles = [[[[MUK pipelineWithArray:items] reverse] filter:^BOOL(id obj, NSInteger index) {
+        return [obj isVisible];
+    }] take:30].array;
+ 
+ Reverse, take and drop stages which come before any map or filter are
+ resolved as a window over source array, so they cost nothing. A reverse
+ which comes after a map or a filter needs to collect what has been produced 
+ so far, because that is the only stage which can not be run in streaming.
+ 
+ Pipelines are immutable: every stage method returns a new pipeline, so you
+ can share and extend them freely. Stages are run each time you ask for
+ results.
+ */
+@interface MUKArrayPipeline : NSObject
+/**
+ Source array.
+ */
+@property (nonatomic, strong, readonly) NSArray *sourceArray;
+
+/**
+ Creates a pipeline without stages.
+ @param array Source array. It is copied.
+ @return A new pipeline.
+ */
+- (id)initWithArray:(NSArray *)array;
+
+/**
+ Appends a map stage.
+ @param block A block with same semantics of the one taken by array:map:. 
+ `index` is the index of `obj` in the sequence which reaches this stage.
+ Setting `*stop` to `YES` ends the sequence which reaches this stage.
+ @return A new pipeline.
+ */
+- (MUKArrayPipeline *)map:(id (^)(id obj, NSInteger index, BOOL *exclude, BOOL *stop))block;
+/**
+ Appends a filter stage.
+ @param block A block which returns `YES` to keep `obj`. `index` is the index
+ of `obj` in the sequence which reaches this stage.
+ @return A new pipeline.
+ */
+- (MUKArrayPipeline *)filter:(BOOL (^)(id obj, NSInteger index))block;
+/**
+ Appends a reverse stage.
+ @return A new pipeline.
+ */
+- (MUKArrayPipeline *)reverse;
+/**
+ Appends a stage which keeps first objects only.
+ @param count Maximum number of objects to keep.
+ @return A new pipeline.
+ */
+- (MUKArrayPipeline *)take:(NSUInteger)count;
+/**
+ Appends a stage which skips first objects.
+ @param count Number of objects to skip.
+ @return A new pipeline.
+ */
+- (MUKArrayPipeline *)drop:(NSUInteger)count;
+/**
+ Appends a stage equivalent to array:applyingTransform:.
+ @param transform Kind of trasform to be applied.
+ @return A new pipeline.
+ */
+- (MUKArrayPipeline *)applyingTransform:(MUKArrayTransform)transform;
+
+/**
+ Runs the pipeline and collects results.
+ @return An array containing every object which exits from last stage.
+ */
+- (NSArray *)array;
+/**
+ Runs the pipeline without collecting results.
+ @param block A block called for every object which exits from last stage.
+ It takes the object, its index and a `BOOL *` you could set to `YES` in order 
+ to stop the pipeline.
+ */
+- (void)enumerateObjectsUsingBlock:(void (^)(id obj, NSUInteger idx, BOOL *stop))block;
+@end
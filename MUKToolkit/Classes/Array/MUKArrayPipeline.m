@@ -0,0 +1,333 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUKArrayPipeline.h"
+
+typedef enum : NSUInteger {
+    MUKArrayPipelineStageMap = 0,
+    MUKArrayPipelineStageFilter,
+    MUKArrayPipelineStageReverse,
+    MUKArrayPipelineStageTake,
+    MUKArrayPipelineStageDrop
+} MUKArrayPipelineStageKind;
+
+typedef id (^MUKArrayPipelineMapBlock)(id obj, NSInteger index, BOOL *exclude, BOOL *stop);
+typedef BOOL (^MUKArrayPipelineFilterBlock)(id obj, NSInteger index);
+typedef BOOL (^MUKArrayPipelineSink)(id obj);
+
+enum {
+    kPipelineBatchSize = 64
+};
+
+@interface MUKArrayPipelineStage : NSObject
+@property (nonatomic) MUKArrayPipelineStageKind kind;
+@property (nonatomic, copy) id block;
+@property (nonatomic) NSUInteger count;
+@end
+
+@implementation MUKArrayPipelineStage
+@end
+
+#pragma mark -
+
+@interface MUKArrayPipeline ()
+@property (nonatomic, strong, readwrite) NSArray *sourceArray;
+@property (nonatomic, strong) NSArray *stages;
+
+- (MUKArrayPipeline *)pipelineAppendingStage_:(MUKArrayPipelineStage *)stage;
+- (void)runWithSink_:(MUKArrayPipelineSink)sink;
+@end
+
+/*
+ Runs a segment of fused stages over a window of source array.
+ Window is [lowIndex, highIndex), read backwards if reversed.
+ Segment stages can not contain reverse stages.
+ Returns NO if sink asked to stop.
+ */
+static BOOL MUKArrayPipelineRunSegment(NSArray *source, NSUInteger lowIndex, NSUInteger highIndex, BOOL reversed, NSArray *stages, MUKArrayPipelineSink sink)
+{
+    NSUInteger const stagesCount = [stages count];
+    
+    // Flatten stages for the hot loop
+    MUKArrayPipelineStageKind *kinds = (MUKArrayPipelineStageKind *)malloc(MAX(stagesCount, (NSUInteger)1) * sizeof(MUKArrayPipelineStageKind));
+    NSUInteger *counters = (NSUInteger *)malloc(MAX(stagesCount, (NSUInteger)1) * sizeof(NSUInteger));
+    __unsafe_unretained id *blocks = (__unsafe_unretained id *)malloc(MAX(stagesCount, (NSUInteger)1) * sizeof(id));
+    
+    BOOL sinkContinues = YES;
+    BOOL segmentEnded = NO;
+    
+    for (NSUInteger s = 0; s < stagesCount; s++) {
+        MUKArrayPipelineStage *stage = [stages objectAtIndex:s];
+        kinds[s] = stage.kind;
+        blocks[s] = stage.block;
+        
+        // Map and filter count indexes, take and drop count remaining objects
+        counters[s] = (stage.kind == MUKArrayPipelineStageTake || stage.kind == MUKArrayPipelineStageDrop ? stage.count : 0);
+        
+        if (stage.kind == MUKArrayPipelineStageTake && stage.count == 0) {
+            // Nothing could pass
+            segmentEnded = YES;
+        }
+    }
+    
+    __unsafe_unretained id batch[kPipelineBatchSize];
+    NSUInteger const windowLength = highIndex - lowIndex;
+    
+    for (NSUInteger batchStart = 0; batchStart < windowLength && !segmentEnded; batchStart += kPipelineBatchSize)
+    {
+        NSUInteger const batchLength = MIN(kPipelineBatchSize, windowLength - batchStart);
+        NSRange const batchRange = (reversed ?
+                                    NSMakeRange(highIndex - batchStart - batchLength, batchLength) :
+                                    NSMakeRange(lowIndex + batchStart, batchLength));
+        [source getObjects:batch range:batchRange];
+        
+        for (NSUInteger n = 0; n < batchLength && !segmentEnded; n++) {
+            id obj = batch[reversed ? batchLength - 1 - n : n];
+            BOOL passed = YES;
+            
+            for (NSUInteger s = 0; s < stagesCount && passed; s++) {
+                switch (kinds[s]) {
+                    case MUKArrayPipelineStageMap: {
+                        BOOL exclusionRequested = NO, stopRequested = NO;
+                        id mappedObject = ((MUKArrayPipelineMapBlock)blocks[s])(obj, counters[s]++, &exclusionRequested, &stopRequested);
+                        
+                        if (stopRequested) {
+                            passed = NO;
+                            segmentEnded = YES;
+                        }
+                        else if (exclusionRequested) {
+                            passed = NO;
+                        }
+                        else {
+                            obj = mappedObject ?: [NSNull null];
+                        }
+                        
+                        break;
+                    }
+                    
+                    case MUKArrayPipelineStageFilter:
+                        passed = ((MUKArrayPipelineFilterBlock)blocks[s])(obj, counters[s]++);
+                        break;
+                    
+                    case MUKArrayPipelineStageDrop:
+                        if (counters[s] > 0) {
+                            counters[s]--;
+                            passed = NO;
+                        }
+                        break;
+                    
+                    case MUKArrayPipelineStageTake:
+                        counters[s]--;
+                        if (counters[s] == 0) {
+                            // This is the last object which could pass
+                            segmentEnded = YES;
+                        }
+                        break;
+                    
+                    default:
+                        break;
+                }
+            } // for stages
+            
+            if (passed && !sink(obj)) {
+                sinkContinues = NO;
+                segmentEnded = YES;
+            }
+        } // for batch
+    } // for batches
+    
+    free(kinds);
+    free(counters);
+    free(blocks);
+    
+    return sinkContinues;
+}
+
+@implementation MUKArrayPipeline
+@synthesize sourceArray = sourceArray_;
+@synthesize stages = stages_;
+
+- (id)initWithArray:(NSArray *)array {
+    self = [super init];
+    if (self) {
+        sourceArray_ = [array copy] ?: [NSArray array];
+        stages_ = [NSArray array];
+    }
+    
+    return self;
+}
+
+- (id)init {
+    return [self initWithArray:nil];
+}
+
+#pragma mark - Stages
+
+- (MUKArrayPipeline *)map:(id (^)(id, NSInteger, BOOL *, BOOL *))block {
+    if (!block) return self;
+    
+    MUKArrayPipelineStage *stage = [[MUKArrayPipelineStage alloc] init];
+    stage.kind = MUKArrayPipelineStageMap;
+    stage.block = block;
+    return [self pipelineAppendingStage_:stage];
+}
+
+- (MUKArrayPipeline *)filter:(BOOL (^)(id, NSInteger))block {
+    if (!block) return self;
+    
+    MUKArrayPipelineStage *stage = [[MUKArrayPipelineStage alloc] init];
+    stage.kind = MUKArrayPipelineStageFilter;
+    stage.block = block;
+    return [self pipelineAppendingStage_:stage];
+}
+
+- (MUKArrayPipeline *)reverse {
+    MUKArrayPipelineStage *stage = [[MUKArrayPipelineStage alloc] init];
+    stage.kind = MUKArrayPipelineStageReverse;
+    return [self pipelineAppendingStage_:stage];
+}
+
+- (MUKArrayPipeline *)take:(NSUInteger)count {
+    MUKArrayPipelineStage *stage = [[MUKArrayPipelineStage alloc] init];
+    stage.kind = MUKArrayPipelineStageTake;
+    stage.count = count;
+    return [self pipelineAppendingStage_:stage];
+}
+
+- (MUKArrayPipeline *)drop:(NSUInteger)count {
+    if (count == 0) return self;
+    
+    MUKArrayPipelineStage *stage = [[MUKArrayPipelineStage alloc] init];
+    stage.kind = MUKArrayPipelineStageDrop;
+    stage.count = count;
+    return [self pipelineAppendingStage_:stage];
+}
+
+- (MUKArrayPipeline *)applyingTransform:(MUKArrayTransform)transform {
+    switch (transform) {
+        case MUKArrayTransformReverse:
+            return [self reverse];
+        
+        default:
+            return self;
+    }
+}
+
+#pragma mark - Results
+
+- (NSArray *)array {
+    NSMutableArray *results = [NSMutableArray array];
+    [self runWithSink_:^BOOL(id obj) {
+        [results addObject:obj];
+        return YES;
+    }];
+    
+    return results;
+}
+
+- (void)enumerateObjectsUsingBlock:(void (^)(id, NSUInteger, BOOL *))block
+{
+    if (!block) return;
+    
+    __block NSUInteger idx = 0;
+    [self runWithSink_:^BOOL(id obj) {
+        BOOL stop = NO;
+        block(obj, idx++, &stop);
+        return !stop;
+    }];
+}
+
+#pragma mark - Private
+
+- (MUKArrayPipeline *)pipelineAppendingStage_:(MUKArrayPipelineStage *)stage {
+    MUKArrayPipeline *pipeline = [[[self class] alloc] init];
+    pipeline.sourceArray = self.sourceArray;
+    pipeline.stages = [self.stages arrayByAddingObject:stage];
+    return pipeline;
+}
+
+- (void)runWithSink_:(MUKArrayPipelineSink)sink {
+    NSArray *source = self.sourceArray;
+    NSUInteger lowIndex = 0, highIndex = [source count];
+    BOOL reversed = NO;
+    NSMutableArray *segmentStages = [[NSMutableArray alloc] init];
+    
+    for (MUKArrayPipelineStage *stage in self.stages) {
+        if ([segmentStages count] == 0) {
+            // Resolve window stages without touching objects
+            BOOL resolved = YES;
+            NSUInteger const windowLength = highIndex - lowIndex;
+            
+            switch (stage.kind) {
+                case MUKArrayPipelineStageReverse:
+                    reversed = !reversed;
+                    break;
+                
+                case MUKArrayPipelineStageDrop: {
+                    NSUInteger dropCount = MIN(stage.count, windowLength);
+                    if (reversed) highIndex -= dropCount;
+                    else lowIndex += dropCount;
+                    break;
+                }
+                
+                case MUKArrayPipelineStageTake: {
+                    NSUInteger takeCount = MIN(stage.count, windowLength);
+                    if (reversed) lowIndex = highIndex - takeCount;
+                    else highIndex = lowIndex + takeCount;
+                    break;
+                }
+                
+                default:
+                    resolved = NO;
+                    break;
+            }
+            
+            if (resolved) continue;
+        }
+        
+        if (stage.kind == MUKArrayPipelineStageReverse) {
+            // Collect what has been produced so far, then read it backwards
+            NSMutableArray *buffer = [[NSMutableArray alloc] init];
+            MUKArrayPipelineRunSegment(source, lowIndex, highIndex, reversed, segmentStages, ^BOOL(id obj)
+            {
+                [buffer addObject:obj];
+                return YES;
+            });
+            
+            source = buffer;
+            lowIndex = 0;
+            highIndex = [buffer count];
+            reversed = YES;
+            [segmentStages removeAllObjects];
+        }
+        else {
+            [segmentStages addObject:stage];
+        }
+    } // for
+    
+    MUKArrayPipelineRunSegment(source, lowIndex, highIndex, reversed, segmentStages, sink);
+}
+
+@end
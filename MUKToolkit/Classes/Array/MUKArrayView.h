@@ -0,0 +1,65 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import <Foundation/Foundation.h>
+
+/**
+ An array which presents a window over another array, without copying it.
+ 
+ A view selects objects of a base array in a range, optionally skipping some
+ of them (stride) and optionally reading them backwards (negative stride).
+ Creating a view and accessing its objects costs O(1), whatever the size of
+ base array is. Fast enumeration reads base array in batches.
+ 
+ Views of views are collapsed into a single view over the original base array.
+ 
+ Objects are copied only when you ask for it (e.g. sending `-copy` or 
+ `-mutableCopy` to the view).
+ 
+ @warning View retains base array but it does not copy it: if base array is
+ mutable, do not mutate it while using the view.
+ */
+@interface MUKArrayView : NSArray
+/**
+ Array whose objects are presented by the view.
+ */
+@property (nonatomic, strong, readonly) NSArray *baseArray;
+
+/**
+ Creates a view.
+ 
+    // Every other object, in reverse order, from the last 10 objects
+    [[MUKArrayView alloc] initWithArray:array 
+        range:NSMakeRange([array count]-10, 10) stride:-2];
+ 
+ @param array Base array.
+ @param range Range of `array` to present. An exception is raised if range is
+ out of bounds.
+ @param stride Distance between presented objects. Negative values read
+ `range` backwards, starting from its last object. `0` is considered `1`.
+ @return A new view.
+ */
+- (id)initWithArray:(NSArray *)array range:(NSRange)range stride:(NSInteger)stride;
+@end
@@ -0,0 +1,145 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUKArrayView.h"
+
+@implementation MUKArrayView {
+    // Presented index i is base index start_ + i * step_
+    NSUInteger start_;
+    NSInteger step_;
+    NSUInteger count_;
+}
+
+@synthesize baseArray = baseArray_;
+
+- (id)initWithArray:(NSArray *)array range:(NSRange)range stride:(NSInteger)stride
+{
+    if (NSMaxRange(range) > [array count] || NSMaxRange(range) < range.location) {
+        [NSException raise:NSRangeException format:@"Range %@ out of bounds [0, %lu)", NSStringFromRange(range), (unsigned long)[array count]];
+    }
+    
+    self = [super init];
+    if (self) {
+        if (stride == 0) stride = 1;
+        
+        NSUInteger const absoluteStride = (NSUInteger)(stride > 0 ? stride : -stride);
+        NSUInteger start = (stride > 0 || range.length == 0 ? range.location : NSMaxRange(range) - 1);
+        NSInteger step = stride;
+        NSUInteger count = (range.length + absoluteStride - 1) / absoluteStride;
+        
+        if ([array isKindOfClass:[MUKArrayView class]]) {
+            // Compose with view over the same base
+            MUKArrayView *view = (MUKArrayView *)array;
+            start = view->start_ + start * view->step_;
+            step = step * view->step_;
+            array = view->baseArray_;
+        }
+        
+        baseArray_ = array ?: [NSArray array];
+        start_ = start;
+        step_ = step;
+        count_ = count;
+    }
+    
+    return self;
+}
+
+- (id)init {
+    return [self initWithArray:nil range:NSMakeRange(0, 0) stride:1];
+}
+
+#pragma mark - NSArray
+
+- (NSUInteger)count {
+    return count_;
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    if (index >= count_) {
+        [NSException raise:NSRangeException format:@"Index %lu beyond bounds [0 .. %ld]", (unsigned long)index, (long)count_ - 1];
+    }
+    
+    return [baseArray_ objectAtIndex:start_ + index * step_];
+}
+
+- (void)getObjects:(__unsafe_unretained id [])objects range:(NSRange)range
+{
+    if (NSMaxRange(range) > count_ || NSMaxRange(range) < range.location) {
+        [NSException raise:NSRangeException format:@"Range %@ out of bounds [0, %lu)", NSStringFromRange(range), (unsigned long)count_];
+    }
+    
+    if (range.length == 0) return;
+    
+    if (step_ == 1) {
+        [baseArray_ getObjects:objects range:NSMakeRange(start_ + range.location, range.length)];
+    }
+    else if (step_ == -1) {
+        // Read contiguous objects, then reverse them in place
+        NSUInteger const lastIndex = start_ - range.location;
+        [baseArray_ getObjects:objects range:NSMakeRange(lastIndex - range.length + 1, range.length)];
+        
+        for (NSUInteger i = 0, j = range.length - 1; i < j; i++, j--) {
+            __unsafe_unretained id tmp = objects[i];
+            objects[i] = objects[j];
+            objects[j] = tmp;
+        }
+    }
+    else {
+        for (NSUInteger i = 0; i < range.length; i++) {
+            objects[i] = [baseArray_ objectAtIndex:start_ + (range.location + i) * step_];
+        }
+    }
+}
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(__unsafe_unretained id [])buffer count:(NSUInteger)len
+{
+    NSUInteger const index = state->state;
+    
+    if (index == 0) {
+        // Mutations are not tracked: base array must not change
+        state->mutationsPtr = &state->extra[0];
+    }
+    
+    if (index >= count_ || len == 0) {
+        return 0;
+    }
+    
+    NSUInteger const length = MIN(len, count_ - index);
+    [self getObjects:buffer range:NSMakeRange(index, length)];
+    
+    state->state = index + length;
+    state->itemsPtr = buffer;
+    
+    return length;
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    // Copy happens here, on demand
+    return [[NSArray allocWithZone:zone] initWithArray:self];
+}
+
+@end
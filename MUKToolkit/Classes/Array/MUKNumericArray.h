@@ -0,0 +1,210 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUK+Array.h"
+
+typedef enum : NSUInteger {
+    MUKNumericTypeInt32 = 0,
+    MUKNumericTypeInt64,
+    MUKNumericTypeFloat,
+    MUKNumericTypeDouble
+} MUKNumericType;
+
+/**
+ An array of unboxed numbers, stored in a contiguous buffer aligned for
+ vector instructions.
+ 
+ Use it instead of an array of `NSNumber` objects when you deal with lots
+ of numbers: values are not boxed and reductions (sum, minimum, maximum), 
+ scaling and reversing run with vector instructions (vDSP for floating point
+ types, auto-vectorized loops for integer types). Block based methods
+ (reduceWithInitialValue:usingBlock:, arrayByMappingWithBlock: and 
+ arrayByFilteringWithBlock:) are not vectorized: they call their block once
+ per value in a scalar loop. Prefer sum, minimum, maximum and
+ arrayByMultiplyingBy:adding: when they fit your computation.
+ 
+ Block based methods, setDouble:atIndex: and arrayByMultiplyingBy:adding:
+ work in double precision: values are converted to `double` before they are
+ passed to blocks or scaled, and results are converted back to array type
+ truncating towards zero. Integer types saturate: out-of-range
+ results become minimum or maximum value of type, and `NaN` becomes `0`. If you
+ need full 64-bit integer precision use bytes and mutableBytes directly.
+ 
+ ## Constants
+ 
+ `MUKNumericType` enumerates types of values you can store:
+ 
+ * `MUKNumericTypeInt32` stores `int32_t` values.
+ * `MUKNumericTypeInt64` stores `int64_t` values.
+ * `MUKNumericTypeFloat` stores `float` values.
+ * `MUKNumericTypeDouble` stores `double` values.
+ 
+ */
+@interface MUKNumericArray : NSObject <NSCopying>
+/**
+ Type of stored values.
+ */
+@property (nonatomic, readonly) MUKNumericType type;
+/**
+ Number of stored values.
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ Size in bytes of a single value of given type.
+ @param type Type of value.
+ @return Size of a single value.
+ */
++ (size_t)sizeOfValueOfType:(MUKNumericType)type;
+
+/**
+ Creates an array of zeros.
+ @param type Type of values.
+ @param count Number of values.
+ @return A new array.
+ */
+- (id)initWithType:(MUKNumericType)type count:(NSUInteger)count;
+/**
+ Creates an array copying values from a C array.
+ @param type Type of values.
+ @param bytes A C array of values of given `type`.
+ @param count Number of values.
+ @return A new array.
+ */
+- (id)initWithType:(MUKNumericType)type bytes:(void const *)bytes count:(NSUInteger)count;
+/**
+ Creates an array unboxing numbers.
+ @param type Type of values.
+ @param array An array of `NSNumber` objects. Other objects (e.g. `NSNull`) are
+ converted to `0`.
+ @return A new array.
+ */
+- (id)initWithType:(MUKNumericType)type array:(NSArray *)array;
+/**
+ Creates an array mapping objects to numbers, without boxing them.
+ @param type Type of values.
+ @param array Source array.
+ @param block A block which takes an object of `array` and its index and 
+ returns a value which is converted to `type`.
+ @return A new array with the same count of `array`.
+ */
+- (id)initWithType:(MUKNumericType)type array:(NSArray *)array map:(double (^)(id obj, NSInteger index))block;
+
+/**
+ Stored values.
+ @return A pointer to a C array of values of type. Pointer is aligned to 16 
+ bytes, at least.
+ */
+- (void const *)bytes;
+/**
+ Stored values, which you can modify.
+ @return A pointer to a C array of values of type.
+ */
+- (void *)mutableBytes;
+/**
+ Boxes stored values.
+ @return An array of `NSNumber` objects.
+ */
+- (NSArray *)array;
+
+/**
+ Value at given index.
+ @param index Index of value. An exception is raised if it is out of bounds.
+ @return Value at `index`, converted to `double`.
+ */
+- (double)doubleAtIndex:(NSUInteger)index;
+/**
+ Replaces value at given index.
+ @param value New value, which is converted to array type.
+ @param index Index of value. An exception is raised if it is out of bounds.
+ */
+- (void)setDouble:(double)value atIndex:(NSUInteger)index;
+
+/**
+ Sum of stored values.
+ 
+ Integer values are summed using 64-bit integers. `MUKNumericTypeInt64` sums
+ which do not fit 64 bits are approximated with doubles.
+ 
+ @return Sum of values or `0` if array is empty.
+ */
+- (double)sum;
+/**
+ Minimum stored value.
+ @return Minimum value or `NAN` if array is empty.
+ */
+- (double)minimum;
+/**
+ Maximum stored value.
+ @return Maximum value or `NAN` if array is empty.
+ */
+- (double)maximum;
+/**
+ Reduces stored values with a block.
+ @param initialValue Initial value of accumulator.
+ @param block A block which takes accumulator, a value and its index and
+ returns new value of accumulator.
+ @return Last value of accumulator.
+ */
+- (double)reduceWithInitialValue:(double)initialValue usingBlock:(double (^)(double accumulator, double value, NSUInteger index))block;
+
+/**
+ Inclusive prefix sums (`result[i] = values[0] + ... + values[i]`).
+ 
+ `MUKNumericTypeInt32` sums are accumulated using 64-bit integers and 
+ clamped to 32-bit range when they are stored. `MUKNumericTypeInt64` sums
+ wrap around on overflow.
+ 
+ @return A new array of same type.
+ */
+- (MUKNumericArray *)prefixSums;
+/**
+ Multiplies every value and adds an offset (`result[i] = values[i] * scale + offset`).
+ @param scale Multiplier.
+ @param offset Addend.
+ @return A new array of same type.
+ */
+- (MUKNumericArray *)arrayByMultiplyingBy:(double)scale adding:(double)offset;
+/**
+ Maps every value with a block.
+ @param block A block which takes a value and its index and returns mapped 
+ value.
+ @return A new array of same type.
+ */
+- (MUKNumericArray *)arrayByMappingWithBlock:(double (^)(double value, NSUInteger index))block;
+/**
+ Keeps values which pass a test.
+ @param block A block which takes a value and its index and returns `YES` to
+ keep that value.
+ @return A new array of same type.
+ */
+- (MUKNumericArray *)arrayByFilteringWithBlock:(BOOL (^)(double value, NSUInteger index))block;
+/**
+ Transforms the array, like array:applyingTransform: does.
+ @param transform Kind of trasform to be applied.
+ @return A new array of same type.
+ */
+- (MUKNumericArray *)arrayByApplyingTransform:(MUKArrayTransform)transform;
+@end
@@ -0,0 +1,545 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUKNumericArray.h"
+#import <Accelerate/Accelerate.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define MUK_NUMERIC_ALIGNMENT   64
+
+// Casting NaN or out-of-range doubles to integers is undefined: saturate
+NS_INLINE int32_t MUKNumericInt32FromDouble(double value) {
+    if (isnan(value)) return 0;
+    if (value <= (double)INT32_MIN) return INT32_MIN;
+    if (value >= (double)INT32_MAX) return INT32_MAX;
+    return (int32_t)value;
+}
+
+NS_INLINE int64_t MUKNumericInt64FromDouble(double value) {
+    if (isnan(value)) return 0;
+    if (value <= -0x1p63) return INT64_MIN;
+    if (value >= 0x1p63) return INT64_MAX;
+    return (int64_t)value;
+}
+
+NS_INLINE float MUKNumericFloatFromDouble(double value) {
+    return (float)value;
+}
+
+NS_INLINE double MUKNumericDoubleFromDouble(double value) {
+    return value;
+}
+
+#define MUK_NUMERIC_CONVERSION(function) \
+    MUKValue (* const MUKValueFromDouble)(double) __attribute__((unused)) = function;
+
+// Runs body with MUKValue typedef'd to C type of values and MUKValueFromDouble
+// pointing to conversion from double
+#define MUK_NUMERIC_DISPATCH(numericType, ...) \
+    switch (numericType) { \
+        case MUKNumericTypeInt32: { typedef int32_t MUKValue; MUK_NUMERIC_CONVERSION(MUKNumericInt32FromDouble) __VA_ARGS__ } break; \
+        case MUKNumericTypeInt64: { typedef int64_t MUKValue; MUK_NUMERIC_CONVERSION(MUKNumericInt64FromDouble) __VA_ARGS__ } break; \
+        case MUKNumericTypeFloat: { typedef float MUKValue; MUK_NUMERIC_CONVERSION(MUKNumericFloatFromDouble) __VA_ARGS__ } break; \
+        case MUKNumericTypeDouble: { typedef double MUKValue; MUK_NUMERIC_CONVERSION(MUKNumericDoubleFromDouble) __VA_ARGS__ } break; \
+    }
+
+static void *MUKNumericAllocate(size_t size) {
+    void *buffer = NULL;
+    
+    if (posix_memalign(&buffer, MUK_NUMERIC_ALIGNMENT, size > 0 ? size : 1) != 0)
+    {
+        [NSException raise:NSMallocException format:@"Cannot allocate %lu bytes", (unsigned long)size];
+    }
+    
+    return buffer;
+}
+
+@implementation MUKNumericArray {
+    void *buffer_;
+}
+
+@synthesize type = type_;
+@synthesize count = count_;
+
++ (size_t)sizeOfValueOfType:(MUKNumericType)type {
+    switch (type) {
+        case MUKNumericTypeInt32:
+            return sizeof(int32_t);
+        
+        case MUKNumericTypeInt64:
+            return sizeof(int64_t);
+        
+        case MUKNumericTypeFloat:
+            return sizeof(float);
+        
+        case MUKNumericTypeDouble:
+            return sizeof(double);
+    }
+    
+    return 0;
+}
+
+- (id)initWithType:(MUKNumericType)type count:(NSUInteger)count {
+    self = [super init];
+    if (self) {
+        size_t const valueSize = [[self class] sizeOfValueOfType:type];
+        if (valueSize > 0 && count > SIZE_MAX / valueSize) {
+            [NSException raise:NSMallocException format:@"Cannot allocate %lu values", (unsigned long)count];
+        }
+        
+        size_t const size = count * valueSize;
+        
+        type_ = type;
+        count_ = count;
+        buffer_ = MUKNumericAllocate(size);
+        memset(buffer_, 0, size);
+    }
+    
+    return self;
+}
+
+- (id)initWithType:(MUKNumericType)type bytes:(void const *)bytes count:(NSUInteger)count
+{
+    self = [self initWithType:type count:count];
+    if (self && bytes && count > 0) {
+        memcpy(buffer_, bytes, count * [[self class] sizeOfValueOfType:type]);
+    }
+    
+    return self;
+}
+
+- (id)initWithType:(MUKNumericType)type array:(NSArray *)array {
+    self = [self initWithType:type count:[array count]];
+    if (self) {
+        MUK_NUMERIC_DISPATCH(type_, {
+            MUKValue *values = buffer_;
+            BOOL const integers = (type_ == MUKNumericTypeInt32 || type_ == MUKNumericTypeInt64);
+            NSUInteger i = 0;
+            
+            for (id object in array) {
+                if ([object isKindOfClass:[NSNumber class]]) {
+                    values[i] = (integers ? (MUKValue)[object longLongValue] : MUKValueFromDouble([object doubleValue]));
+                }
+                
+                i++;
+            } // for
+        });
+    }
+    
+    return self;
+}
+
+- (id)initWithType:(MUKNumericType)type array:(NSArray *)array map:(double (^)(id, NSInteger))block
+{
+    if (block == nil) {
+        return [self initWithType:type array:array];
+    }
+    
+    self = [self initWithType:type count:[array count]];
+    if (self) {
+        MUK_NUMERIC_DISPATCH(type_, {
+            MUKValue *values = buffer_;
+            NSInteger i = 0;
+            
+            for (id object in array) {
+                values[i] = MUKValueFromDouble(block(object, i));
+                i++;
+            } // for
+        });
+    }
+    
+    return self;
+}
+
+- (id)init {
+    return [self initWithType:MUKNumericTypeDouble count:0];
+}
+
+- (void)dealloc {
+    free(buffer_);
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    return [[[self class] allocWithZone:zone] initWithType:type_ bytes:buffer_ count:count_];
+}
+
+#pragma mark - Accessors
+
+- (void const *)bytes {
+    return buffer_;
+}
+
+- (void *)mutableBytes {
+    return buffer_;
+}
+
+- (NSArray *)array {
+    NSMutableArray *array = [[NSMutableArray alloc] initWithCapacity:count_];
+    
+    MUK_NUMERIC_DISPATCH(type_, {
+        MUKValue const *values = buffer_;
+        for (NSUInteger i = 0; i < count_; i++) {
+            [array addObject:@(values[i])];
+        } // for
+    });
+    
+    return array;
+}
+
+- (double)doubleAtIndex:(NSUInteger)index {
+    [self checkIndex_:index];
+    
+    double value = 0.0;
+    MUK_NUMERIC_DISPATCH(type_, {
+        value = (double)((MUKValue const *)buffer_)[index];
+    });
+    
+    return value;
+}
+
+- (void)setDouble:(double)value atIndex:(NSUInteger)index {
+    [self checkIndex_:index];
+    
+    MUK_NUMERIC_DISPATCH(type_, {
+        ((MUKValue *)buffer_)[index] = MUKValueFromDouble(value);
+    });
+}
+
+#pragma mark - Reductions
+
+- (double)sum {
+    switch (type_) {
+        case MUKNumericTypeFloat: {
+            float sum = 0.0f;
+            vDSP_sve(buffer_, 1, &sum, count_);
+            return sum;
+        }
+        
+        case MUKNumericTypeDouble: {
+            double sum = 0.0;
+            vDSP_sveD(buffer_, 1, &sum, count_);
+            return sum;
+        }
+        
+        case MUKNumericTypeInt32: {
+            // 32-bit values can not overflow a 64-bit sum
+            int32_t const *values = buffer_;
+            int64_t sum = 0;
+            for (NSUInteger i = 0; i < count_; i++) {
+                sum += values[i];
+            } // for
+            return (double)sum;
+        }
+        
+        case MUKNumericTypeInt64: {
+            // Unsigned additions wrap around instead of overflowing: result is
+            // exact if it fits 64 bits, which an approximate sum tells
+            int64_t const *values = buffer_;
+            uint64_t sum = 0;
+            double approximateSum = 0.0;
+            for (NSUInteger i = 0; i < count_; i++) {
+                sum += (uint64_t)values[i];
+                approximateSum += (double)values[i];
+            } // for
+            return (fabs(approximateSum) < 0x1p62 ? (double)(int64_t)sum : approximateSum);
+        }
+    }
+    
+    return 0.0;
+}
+
+- (double)minimum {
+    if (count_ == 0) return NAN;
+    
+    switch (type_) {
+        case MUKNumericTypeFloat: {
+            float minimum;
+            vDSP_minv(buffer_, 1, &minimum, count_);
+            return minimum;
+        }
+        
+        case MUKNumericTypeDouble: {
+            double minimum;
+            vDSP_minvD(buffer_, 1, &minimum, count_);
+            return minimum;
+        }
+        
+        default: {
+            double result = 0.0;
+            MUK_NUMERIC_DISPATCH(type_, {
+                MUKValue const *values = buffer_;
+                MUKValue minimum = values[0];
+                for (NSUInteger i = 1; i < count_; i++) {
+                    minimum = (values[i] < minimum ? values[i] : minimum);
+                } // for
+                result = (double)minimum;
+            });
+            return result;
+        }
+    }
+}
+
+- (double)maximum {
+    if (count_ == 0) return NAN;
+    
+    switch (type_) {
+        case MUKNumericTypeFloat: {
+            float maximum;
+            vDSP_maxv(buffer_, 1, &maximum, count_);
+            return maximum;
+        }
+        
+        case MUKNumericTypeDouble: {
+            double maximum;
+            vDSP_maxvD(buffer_, 1, &maximum, count_);
+            return maximum;
+        }
+        
+        default: {
+            double result = 0.0;
+            MUK_NUMERIC_DISPATCH(type_, {
+                MUKValue const *values = buffer_;
+                MUKValue maximum = values[0];
+                for (NSUInteger i = 1; i < count_; i++) {
+                    maximum = (values[i] > maximum ? values[i] : maximum);
+                } // for
+                result = (double)maximum;
+            });
+            return result;
+        }
+    }
+}
+
+- (double)reduceWithInitialValue:(double)initialValue usingBlock:(double (^)(double, double, NSUInteger))block
+{
+    double accumulator = initialValue;
+    if (block == nil) return accumulator;
+    
+    MUK_NUMERIC_DISPATCH(type_, {
+        MUKValue const *values = buffer_;
+        for (NSUInteger i = 0; i < count_; i++) {
+            accumulator = block(accumulator, (double)values[i], i);
+        } // for
+    });
+    
+    return accumulator;
+}
+
+#pragma mark - Transforms
+
+- (MUKNumericArray *)prefixSums {
+    MUKNumericArray *result = [[[self class] alloc] initWithType:type_ count:count_];
+    
+    switch (type_) {
+        case MUKNumericTypeInt32: {
+            // Signed overflow is undefined: sum with 64 bits, then clamp
+            int32_t const *values = buffer_;
+            int32_t *sums = result->buffer_;
+            int64_t sum = 0;
+            
+            for (NSUInteger i = 0; i < count_; i++) {
+                sum += values[i];
+                sums[i] = (int32_t)MAX((int64_t)INT32_MIN, MIN(sum, (int64_t)INT32_MAX));
+            } // for
+            
+            break;
+        }
+        
+        case MUKNumericTypeInt64: {
+            // Unsigned additions wrap around instead of overflowing
+            int64_t const *values = buffer_;
+            int64_t *sums = result->buffer_;
+            uint64_t sum = 0;
+            
+            for (NSUInteger i = 0; i < count_; i++) {
+                sum += (uint64_t)values[i];
+                sums[i] = (int64_t)sum;
+            } // for
+            
+            break;
+        }
+        
+        default: {
+            MUK_NUMERIC_DISPATCH(type_, {
+                MUKValue const *values = buffer_;
+                MUKValue *sums = result->buffer_;
+                MUKValue sum = 0;
+                
+                for (NSUInteger i = 0; i < count_; i++) {
+                    sum += values[i];
+                    sums[i] = sum;
+                } // for
+            });
+            break;
+        }
+    }
+    
+    return result;
+}
+
+- (MUKNumericArray *)arrayByMultiplyingBy:(double)scale adding:(double)offset
+{
+    MUKNumericArray *result = [[[self class] alloc] initWithType:type_ count:count_];
+    
+    switch (type_) {
+        case MUKNumericTypeFloat: {
+            float floatScale = (float)scale, floatOffset = (float)offset;
+            vDSP_vsmsa(buffer_, 1, &floatScale, &floatOffset, result->buffer_, 1, count_);
+            break;
+        }
+        
+        case MUKNumericTypeDouble:
+            vDSP_vsmsaD(buffer_, 1, &scale, &offset, result->buffer_, 1, count_);
+            break;
+        
+        default: {
+            MUK_NUMERIC_DISPATCH(type_, {
+                MUKValue const *values = buffer_;
+                MUKValue *mapped = result->buffer_;
+                
+                for (NSUInteger i = 0; i < count_; i++) {
+                    mapped[i] = MUKValueFromDouble((double)values[i] * scale + offset);
+                } // for
+            });
+            break;
+        }
+    }
+    
+    return result;
+}
+
+- (MUKNumericArray *)arrayByMappingWithBlock:(double (^)(double, NSUInteger))block
+{
+    if (block == nil) {
+        return [self copy];
+    }
+    
+    MUKNumericArray *result = [[[self class] alloc] initWithType:type_ count:count_];
+    
+    MUK_NUMERIC_DISPATCH(type_, {
+        MUKValue const *values = buffer_;
+        MUKValue *mapped = result->buffer_;
+        
+        for (NSUInteger i = 0; i < count_; i++) {
+            mapped[i] = MUKValueFromDouble(block((double)values[i], i));
+        } // for
+    });
+    
+    return result;
+}
+
+- (MUKNumericArray *)arrayByFilteringWithBlock:(BOOL (^)(double, NSUInteger))block
+{
+    if (block == nil) {
+        return [self copy];
+    }
+    
+    // Allocate for the worst case, then expose only kept values
+    MUKNumericArray *result = [[[self class] alloc] initWithType:type_ count:count_];
+    NSUInteger keptCount = 0;
+    
+    MUK_NUMERIC_DISPATCH(type_, {
+        MUKValue const *values = buffer_;
+        MUKValue *kept = result->buffer_;
+        
+        for (NSUInteger i = 0; i < count_; i++) {
+            if (block((double)values[i], i)) {
+                kept[keptCount++] = values[i];
+            }
+        } // for
+    });
+    
+    result->count_ = keptCount;
+    return result;
+}
+
+- (MUKNumericArray *)arrayByApplyingTransform:(MUKArrayTransform)transform
+{
+    switch (transform) {
+        case MUKArrayTransformReverse: {
+            MUKNumericArray *result = [self copy];
+            
+            switch (type_) {
+                case MUKNumericTypeFloat:
+                    vDSP_vrvrs(result->buffer_, 1, count_);
+                    break;
+                
+                case MUKNumericTypeDouble:
+                    vDSP_vrvrsD(result->buffer_, 1, count_);
+                    break;
+                
+                default: {
+                    MUK_NUMERIC_DISPATCH(type_, {
+                        MUKValue *values = result->buffer_;
+                        for (NSUInteger i = 0, j = count_; i + 1 < j; i++, j--) {
+                            MUKValue const value = values[i];
+                            values[i] = values[j - 1];
+                            values[j - 1] = value;
+                        } // for
+                    });
+                    break;
+                }
+            }
+            
+            return result;
+        }
+        
+        default:
+            return [self copy];
+    }
+}
+
+#pragma mark - NSObject
+
+- (BOOL)isEqual:(id)object {
+    if (self == object) return YES;
+    if (![object isKindOfClass:[MUKNumericArray class]]) return NO;
+    
+    MUKNumericArray *other = object;
+    if (other->type_ != type_ || other->count_ != count_) return NO;
+    
+    return memcmp(buffer_, other->buffer_, count_ * [[self class] sizeOfValueOfType:type_]) == 0;
+}
+
+- (NSUInteger)hash {
+    return count_ ^ (type_ << 24);
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p> %@", NSStringFromClass([self class]), self, [[self array] componentsJoinedByString:@", "]];
+}
+
+#pragma mark - Private
+
+- (void)checkIndex_:(NSUInteger)index {
+    if (index >= count_) {
+        [NSException raise:NSRangeException format:@"Index %lu out of bounds [0, %lu)", (unsigned long)index, (unsigned long)count_];
+    }
+}
+
+@end
@@ -0,0 +1,109 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUK.h"
+
+#ifndef MUK_INSTRUMENTATION
+#define MUK_INSTRUMENTATION 0
+#endif
+
+#if MUK_INSTRUMENTATION
+#include <mach/mach_time.h>
+#endif
+
+/**
+ Measures time spent into toolkit methods.
+ 
+ Instrumentation is compiled only when `MUK_INSTRUMENTATION` is defined to `1`
+ while building the toolkit (e.g. adding `MUK_INSTRUMENTATION=1` to 
+ `GCC_PREPROCESSOR_DEFINITIONS`). Otherwise probes expand to nothing, so 
+ there is no overhead at all, and snapshots are empty.
+ 
+ Instrumented methods (main entry points of MUK(String), MUK(Data), MUK(Image),
+ MUK(Color), MUK(Geometry) and MUK(Date)) keep:
+ 
+ * `calls`, number of invocations;
+ * `totalTime`, cumulative latency in seconds;
+ * `maxTime`, maximum latency in seconds;
+ * `bytes`, number of processed bytes (when it makes sense).
+ 
+ Counters live in per-thread storage, so recording a call takes no lock and
+ its atomic additions are never contended: they are aggregated only when you
+ take a snapshot. Atomic accesses keep 64-bit counters from tearing on 32-bit
+ devices.
+ */
+@interface MUK (Instrumentation)
+/**
+ Tells if toolkit has been compiled with instrumentation.
+ @return `YES` if `MUK_INSTRUMENTATION` was enabled.
+ */
++ (BOOL)isInstrumentationEnabled;
+/**
+ Aggregates counters of every thread.
+ @return A dictionary whose keys are method names and whose values are 
+ dictionaries with `calls`, `totalTime`, `maxTime` and `bytes` keys. Methods
+ which have never been called are not included.
+ */
++ (NSDictionary *)instrumentationSnapshot;
+/**
+ Exports a snapshot as JSON.
+ @return A JSON object, with the same structure of instrumentationSnapshot.
+ */
++ (NSString *)instrumentationJSONString;
+/**
+ Zeroes every counter.
+ @warning Calls which are running while you reset could be partially counted.
+ */
++ (void)resetInstrumentation;
+@end
+
+#if MUK_INSTRUMENTATION
+
+typedef struct {
+    char const *name;
+    volatile int32_t index;
+} MUKInstrumentationProbe;
+
+typedef struct {
+    MUKInstrumentationProbe *probe;
+    uint64_t startTime;
+    uint64_t bytes;
+} MUKInstrumentationScope;
+
+extern void MUKInstrumentationScopeEnd(MUKInstrumentationScope *scope);
+
+/*
+ Records a call of enclosing method, which ends when method returns.
+ Put it at the beginning of method body.
+ */
+#define MUK_INSTRUMENT(bytesCount) \
+    static MUKInstrumentationProbe MUKInstrumentationProbe_ = { __PRETTY_FUNCTION__, -1 }; \
+    MUKInstrumentationScope MUKInstrumentationScope_ __attribute__((cleanup(MUKInstrumentationScopeEnd))) = { &MUKInstrumentationProbe_, mach_absolute_time(), (uint64_t)(bytesCount) }
+
+#else
+
+#define MUK_INSTRUMENT(bytesCount) do {} while (0)
+
+#endif
@@ -0,0 +1,226 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUK+Instrumentation.h"
+
+#if MUK_INSTRUMENTATION
+
+#include <pthread.h>
+#include <libkern/OSAtomic.h>
+
+#define MUK_INSTRUMENTATION_MAX_PROBES  256
+
+// Counters are updated and read with atomic operations: other threads take
+// snapshots, and 64-bit accesses are not atomic on 32-bit ARM
+typedef struct {
+    volatile int64_t calls;
+    volatile int64_t totalTime;
+    volatile int64_t maxTime;
+    volatile int64_t bytes;
+} MUKInstrumentationCounters;
+
+// Counters of a thread. Blocks are never freed: when a thread exits its 
+// block is kept (to preserve counters) and reused by next new thread.
+typedef struct MUKInstrumentationThreadBlock {
+    struct MUKInstrumentationThreadBlock *next;
+    volatile int32_t inUse;
+    MUKInstrumentationCounters counters[MUK_INSTRUMENTATION_MAX_PROBES];
+} MUKInstrumentationThreadBlock;
+
+static MUKInstrumentationThreadBlock * volatile MUKInstrumentationThreadBlocks = NULL;
+static MUKInstrumentationProbe *MUKInstrumentationProbes[MUK_INSTRUMENTATION_MAX_PROBES];
+static volatile int32_t MUKInstrumentationProbeCount = 0;
+static pthread_mutex_t MUKInstrumentationProbeMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t MUKInstrumentationThreadKey;
+static pthread_once_t MUKInstrumentationThreadKeyOnce = PTHREAD_ONCE_INIT;
+
+NS_INLINE int64_t MUKInstrumentationLoad(volatile int64_t *counter) {
+    return OSAtomicAdd64Barrier(0, counter);
+}
+
+static void MUKInstrumentationReleaseThreadBlock(void *block) {
+    __sync_lock_release(&((MUKInstrumentationThreadBlock *)block)->inUse);
+}
+
+static void MUKInstrumentationCreateThreadKey(void) {
+    pthread_key_create(&MUKInstrumentationThreadKey, MUKInstrumentationReleaseThreadBlock);
+}
+
+static MUKInstrumentationThreadBlock *MUKInstrumentationCurrentThreadBlock(void)
+{
+    pthread_once(&MUKInstrumentationThreadKeyOnce, MUKInstrumentationCreateThreadKey);
+    
+    MUKInstrumentationThreadBlock *block = pthread_getspecific(MUKInstrumentationThreadKey);
+    if (block) return block;
+    
+    // Reuse a block of an exited thread
+    for (block = MUKInstrumentationThreadBlocks; block; block = block->next) {
+        if (__sync_bool_compare_and_swap(&block->inUse, 0, 1)) break;
+    } // for
+    
+    if (block == NULL) {
+        block = calloc(1, sizeof(MUKInstrumentationThreadBlock));
+        if (block == NULL) return NULL;
+        block->inUse = 1;
+        
+        MUKInstrumentationThreadBlock *head;
+        do {
+            head = MUKInstrumentationThreadBlocks;
+            block->next = head;
+        } while (!__sync_bool_compare_and_swap(&MUKInstrumentationThreadBlocks, head, block));
+    }
+    
+    pthread_setspecific(MUKInstrumentationThreadKey, block);
+    return block;
+}
+
+static int32_t MUKInstrumentationRegisterProbe(MUKInstrumentationProbe *probe) {
+    pthread_mutex_lock(&MUKInstrumentationProbeMutex);
+    
+    if (probe->index < 0) {
+        int32_t const index = MUKInstrumentationProbeCount;
+        
+        if (index < MUK_INSTRUMENTATION_MAX_PROBES) {
+            MUKInstrumentationProbes[index] = probe;
+            __sync_synchronize();
+            MUKInstrumentationProbeCount = index + 1;
+        }
+        
+        probe->index = index;
+    }
+    
+    pthread_mutex_unlock(&MUKInstrumentationProbeMutex);
+    return probe->index;
+}
+
+void MUKInstrumentationScopeEnd(MUKInstrumentationScope *scope) {
+    uint64_t const elapsedTime = mach_absolute_time() - scope->startTime;
+    
+    int32_t index = scope->probe->index;
+    if (index < 0) index = MUKInstrumentationRegisterProbe(scope->probe);
+    if (index >= MUK_INSTRUMENTATION_MAX_PROBES) return;
+    
+    MUKInstrumentationThreadBlock *block = MUKInstrumentationCurrentThreadBlock();
+    if (block == NULL) return;
+    
+    // Only this thread increments these counters, so atomic operations are
+    // never contended
+    MUKInstrumentationCounters *counters = &block->counters[index];
+    OSAtomicAdd64(1, &counters->calls);
+    OSAtomicAdd64((int64_t)elapsedTime, &counters->totalTime);
+    OSAtomicAdd64((int64_t)scope->bytes, &counters->bytes);
+    
+    // A reset could zero maximum meanwhile
+    int64_t maxTime;
+    do {
+        maxTime = MUKInstrumentationLoad(&counters->maxTime);
+        if ((int64_t)elapsedTime <= maxTime) break;
+    } while (!OSAtomicCompareAndSwap64Barrier(maxTime, (int64_t)elapsedTime, &counters->maxTime));
+}
+
+#endif
+
+@implementation MUK (Instrumentation)
+
++ (BOOL)isInstrumentationEnabled {
+    return (MUK_INSTRUMENTATION != 0);
+}
+
++ (NSDictionary *)instrumentationSnapshot {
+    NSMutableDictionary *snapshot = [NSMutableDictionary dictionary];
+
+#if MUK_INSTRUMENTATION
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+    double const secondsPerTick = (double)timebase.numer / (double)timebase.denom / 1.0e9;
+    
+    int32_t const probeCount = MUKInstrumentationProbeCount;
+    __sync_synchronize();
+    
+    for (int32_t i = 0; i < probeCount; i++) {
+        uint64_t calls = 0, totalTime = 0, maxTime = 0, bytes = 0;
+        
+        for (MUKInstrumentationThreadBlock *block = MUKInstrumentationThreadBlocks; block; block = block->next)
+        {
+            MUKInstrumentationCounters *counters = &block->counters[i];
+            calls += (uint64_t)MUKInstrumentationLoad(&counters->calls);
+            totalTime += (uint64_t)MUKInstrumentationLoad(&counters->totalTime);
+            bytes += (uint64_t)MUKInstrumentationLoad(&counters->bytes);
+            maxTime = MAX(maxTime, (uint64_t)MUKInstrumentationLoad(&counters->maxTime));
+        } // for
+        
+        if (calls == 0) continue;
+        
+        NSString *name = @(MUKInstrumentationProbes[i]->name);
+        snapshot[name] = @{
+            @"calls": @(calls),
+            @"totalTime": @((double)totalTime * secondsPerTick),
+            @"maxTime": @((double)maxTime * secondsPerTick),
+            @"bytes": @(bytes)
+        };
+    } // for
+#endif
+
+    return snapshot;
+}
+
++ (NSString *)instrumentationJSONString {
+    NSDictionary *snapshot = [self instrumentationSnapshot];
+    NSMutableString *json = [NSMutableString stringWithString:@"{"];
+    
+    NSArray *names = [[snapshot allKeys] sortedArrayUsingSelector:@selector(compare:)];
+    [names enumerateObjectsUsingBlock:^(NSString *name, NSUInteger idx, BOOL *stop)
+    {
+        NSDictionary *counters = snapshot[name];
+        NSString *escapedName = [[name stringByReplacingOccurrencesOfString:@"\\" withString:@"\\\\"] stringByReplacingOccurrencesOfString:@"\"" withString:@"\\\""];
+        
+        [json appendFormat:@"%@\"%@\":{\"calls\":%llu,\"totalTime\":%.9f,\"maxTime\":%.9f,\"bytes\":%llu}", (idx > 0 ? @"," : @""), escapedName, [counters[@"calls"] unsignedLongLongValue], [counters[@"totalTime"] doubleValue], [counters[@"maxTime"] doubleValue], [counters[@"bytes"] unsignedLongLongValue]];
+    }];
+    
+    [json appendString:@"}"];
+    return json;
+}
+
++ (void)resetInstrumentation {
+#if MUK_INSTRUMENTATION
+    for (MUKInstrumentationThreadBlock *block = MUKInstrumentationThreadBlocks; block; block = block->next)
+    {
+        for (NSUInteger i = 0; i < MUK_INSTRUMENTATION_MAX_PROBES; i++) {
+            // Subtract what has been read, so concurrent calls are kept
+            MUKInstrumentationCounters *counters = &block->counters[i];
+            OSAtomicAdd64Barrier(-MUKInstrumentationLoad(&counters->calls), &counters->calls);
+            OSAtomicAdd64Barrier(-MUKInstrumentationLoad(&counters->totalTime), &counters->totalTime);
+            OSAtomicAdd64Barrier(-MUKInstrumentationLoad(&counters->bytes), &counters->bytes);
+            
+            int64_t maxTime;
+            do {
+                maxTime = MUKInstrumentationLoad(&counters->maxTime);
+            } while (!OSAtomicCompareAndSwap64Barrier(maxTime, 0, &counters->maxTime));
+        } // for
+    } // for
+#endif
+}
+
+@end
@@ -56,6 +56,7 @@
  @param bitmask The bitmask where flag is searched.
  @param flag The value searched in the bitmask.
  @return YES if flag bit is found into bitmask.
+ @see MUKBitset, when flags do not fit a single `NSUInteger`.
  */
 + (BOOL)bitmask:(NSUInteger)bitmask containsFlag:(NSUInteger)flag;
 /**
@@ -102,6 +103,15 @@
  Because you often use this method on main thread you can use
  `dispatch_async` on main queue or 
  `[NSObject performSelectorOnMainThread:withObject:waitUntilDone:]`.
+ @see MUKCompletion, which wakes waiting thread as soon as it is signalled.
  */
 + (BOOL)waitForCompletion:(BOOL *)done timeout:(NSTimeInterval)timeout runLoop:(NSRunLoop *)runLoop;
-@end
\ No newline at end of file
+@end
+
+/**
+ Inline counterpart of bitmask:containsFlag:, for hot paths which can not
+ afford a message send.
+ */
+NS_INLINE BOOL MUKBitmaskContainsFlag(NSUInteger bitmask, NSUInteger flag) {
+    return ((bitmask & flag) == flag);
+}
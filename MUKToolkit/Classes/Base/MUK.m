@@ -28,7 +28,7 @@
 @implementation MUK
 
 + (BOOL)bitmask:(NSUInteger)bitmask containsFlag:(NSUInteger)flag {
-    return ((bitmask & flag) == flag);
+    return MUKBitmaskContainsFlag(bitmask, flag);
 }
 
 + (BOOL)waitForCompletion:(BOOL *)done timeout:(NSTimeInterval)timeout runLoop:(NSRunLoop *)runLoop {
@@ -0,0 +1,214 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import <Foundation/Foundation.h>
+
+/**
+ A set of unsigned integers, stored as bits of a contiguous array of 64-bit
+ words.
+ 
+ Use it instead of `NSMutableIndexSet` or arrays of `NSNumber` objects when
+ you deal with dense sets of small indexes (e.g. flags or selection state of
+ rows of a long list): every index takes a single bit, counting runs with 
+ population count instructions and set operations work on many words at once
+ with vector instructions.
+    
+    MUKBitset *selection = [[MUKBitset alloc] initWithCapacity:[rows count]];
+    [selection addIndex:12];
+    [selection addIndexesInRange:NSMakeRange(40, 10)];
+    
+    // Selected rows between row 30 and row 45
+    NSUInteger const selectedCount = [selection rankOfIndex:45] - [selection rankOfIndex:30];
+ 
+ Bitset grows as you add indexes, so memory is proportional to its greatest
+ index, not to its count.
+ 
+ @warning This class is not thread-safe: rank and select methods build an 
+ index lazily, which any change invalidates.
+ */
+@interface MUKBitset : NSObject <NSCopying>
+/**
+ Number of words backing the bitset.
+ */
+@property (nonatomic, readonly) NSUInteger wordsCount;
+
+/**
+ Creates an empty bitset.
+ @param capacity Number of bits to allocate upfront. Bitset grows beyond it
+ when needed.
+ @return A new bitset.
+ */
+- (id)initWithCapacity:(NSUInteger)capacity;
+/**
+ Creates a bitset with indexes of an index set.
+ @param indexSet Indexes to add.
+ @return A new bitset.
+ */
+- (id)initWithIndexSet:(NSIndexSet *)indexSet;
+/**
+ Creates a bitset copying words from a C array.
+ @param words A C array of words. Bit `b` of `words[w]` stands for index
+ `w * 64 + b`.
+ @param wordsCount Number of words.
+ @return A new bitset.
+ */
+- (id)initWithWords:(uint64_t const *)words count:(NSUInteger)wordsCount;
+
+/**
+ Words backing the bitset.
+ @return A pointer to a C array of wordsCount words.
+ */
+- (uint64_t const *)words;
+/**
+ Converts the bitset into an index set.
+ @return An index set which contains every index of receiver. Adjacent
+ indexes are added as ranges.
+ */
+- (NSIndexSet *)indexSet;
+
+/**
+ Number of indexes.
+ @return Number of bits which are set.
+ */
+- (NSUInteger)count;
+/**
+ Number of indexes in a range.
+ @param range Range of indexes.
+ @return Number of bits which are set into `range`.
+ */
+- (NSUInteger)countOfIndexesInRange:(NSRange)range;
+/**
+ Tells if bitset contains an index.
+ @param index Index to test.
+ @return `YES` if bit at `index` is set.
+ */
+- (BOOL)containsIndex:(NSUInteger)index;
+/**
+ Tells if bitset contains every index of a range.
+ @param range Range of indexes to test.
+ @return `YES` if every bit of `range` is set.
+ */
+- (BOOL)containsIndexesInRange:(NSRange)range;
+/**
+ First index.
+ @return Lowest index or `NSNotFound` if bitset is empty.
+ */
+- (NSUInteger)firstIndex;
+/**
+ Last index.
+ @return Greatest index or `NSNotFound` if bitset is empty.
+ */
+- (NSUInteger)lastIndex;
+/**
+ Closest index greater than a given one.
+ @param index Index to compare to.
+ @return Lowest index greater than `index` or `NSNotFound`.
+ */
+- (NSUInteger)indexGreaterThanIndex:(NSUInteger)index;
+
+/**
+ Rank of an index.
+ 
+ Rank is answered in constant time, once a table of partial counts is built.
+ That table is built on demand and kept until the bitset changes.
+ 
+ @param index Any index, which could not be into the bitset.
+ @return Number of indexes lower than `index`.
+ */
+- (NSUInteger)rankOfIndex:(NSUInteger)index;
+/**
+ Index with a given rank (e.g. the 10th selected row).
+ 
+ This method is the inverse of rankOfIndex: and it uses the same table.
+ 
+ @param rank Number of indexes which precede the one you look for.
+ @return Index of the bit which is preceded by `rank` set bits or `NSNotFound`
+ if `rank` is not lower than count.
+ */
+- (NSUInteger)indexWithRank:(NSUInteger)rank;
+
+/**
+ Enumerates indexes in ascending order.
+ @param block A block called for each index. You can set `*stop` to `YES`
+ in order to stop enumeration.
+ */
+- (void)enumerateIndexesUsingBlock:(void (^)(NSUInteger index, BOOL *stop))block;
+/**
+ Enumerates indexes of a range in ascending order.
+ @param range Range of indexes to enumerate.
+ @param block A block called for each index. You can set `*stop` to `YES`
+ in order to stop enumeration.
+ */
+- (void)enumerateIndexesInRange:(NSRange)range usingBlock:(void (^)(NSUInteger index, BOOL *stop))block;
+
+/**
+ Adds an index.
+ @param index Index to add.
+ */
+- (void)addIndex:(NSUInteger)index;
+/**
+ Adds a range of indexes.
+ @param range Range of indexes to add.
+ */
+- (void)addIndexesInRange:(NSRange)range;
+/**
+ Removes an index.
+ @param index Index to remove.
+ */
+- (void)removeIndex:(NSUInteger)index;
+/**
+ Removes a range of indexes.
+ @param range Range of indexes to remove.
+ */
+- (void)removeIndexesInRange:(NSRange)range;
+/**
+ Removes every index, keeping allocated words.
+ */
+- (void)removeAllIndexes;
+
+/**
+ Adds indexes of another bitset (union).
+ @param bitset Other bitset.
+ */
+- (void)unionWithBitset:(MUKBitset *)bitset;
+/**
+ Keeps only indexes which are into another bitset too (intersection).
+ @param bitset Other bitset.
+ */
+- (void)intersectWithBitset:(MUKBitset *)bitset;
+/**
+ Removes indexes of another bitset (difference).
+ @param bitset Other bitset.
+ */
+- (void)minusBitset:(MUKBitset *)bitset;
+
+/**
+ Compares two bitsets.
+ @param bitset Other bitset.
+ @return `YES` if both bitsets contain the same indexes, whatever their 
+ wordsCount.
+ */
+- (BOOL)isEqualToBitset:(MUKBitset *)bitset;
+@end
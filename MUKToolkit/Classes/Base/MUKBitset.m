@@ -0,0 +1,574 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUKBitset.h"
+#include <stdlib.h>
+
+#define MUK_BITSET_WORD_BITS        64
+#define MUK_BITSET_ALIGNMENT        64
+
+// A rank table entry every 8 words (512 bits)
+#define MUK_BITSET_RANK_BLOCK_WORDS 8
+
+typedef uint64_t MUKBitsetVector __attribute__((vector_size(16)));
+
+#define MUK_BITSET_VECTOR_WORDS     (sizeof(MUKBitsetVector) / sizeof(uint64_t))
+
+typedef enum {
+    MUKBitsetOperationUnion = 0,
+    MUKBitsetOperationIntersection,
+    MUKBitsetOperationDifference
+} MUKBitsetOperation;
+
+NS_INLINE NSUInteger MUKBitsetPopCount(uint64_t word) {
+    return (NSUInteger)__builtin_popcountll(word);
+}
+
+NS_INLINE NSUInteger MUKBitsetTrailingZeros(uint64_t word) {
+    return (NSUInteger)__builtin_ctzll(word);
+}
+
+NS_INLINE NSUInteger MUKBitsetLeadingZeros(uint64_t word) {
+    return (NSUInteger)__builtin_clzll(word);
+}
+
+// Bits [bit, 63]
+NS_INLINE uint64_t MUKBitsetMaskFromBit(NSUInteger bit) {
+    return (~(uint64_t)0) << bit;
+}
+
+// Bits [0, bit]
+NS_INLINE uint64_t MUKBitsetMaskThroughBit(NSUInteger bit) {
+    return (~(uint64_t)0) >> (MUK_BITSET_WORD_BITS - 1 - bit);
+}
+
+NS_INLINE NSRange MUKBitsetClippedRange(NSRange range, NSUInteger bitsCount) {
+    if (range.location >= bitsCount) return NSMakeRange(bitsCount, 0);
+    return NSMakeRange(range.location, MIN(range.length, bitsCount - range.location));
+}
+
+static NSUInteger MUKBitsetCountWords(uint64_t const *words, NSUInteger count) {
+    // Independent accumulators, so population counts run in parallel
+    NSUInteger counts[4] = { 0, 0, 0, 0 };
+    NSUInteger i = 0;
+    
+    for (; i + 4 <= count; i += 4) {
+        counts[0] += MUKBitsetPopCount(words[i]);
+        counts[1] += MUKBitsetPopCount(words[i + 1]);
+        counts[2] += MUKBitsetPopCount(words[i + 2]);
+        counts[3] += MUKBitsetPopCount(words[i + 3]);
+    } // for
+    
+    for (; i < count; i++) {
+        counts[0] += MUKBitsetPopCount(words[i]);
+    } // for
+    
+    return counts[0] + counts[1] + counts[2] + counts[3];
+}
+
+// Range must not be empty and must fit words
+static NSUInteger MUKBitsetCountBitsInRange(uint64_t const *words, NSRange range)
+{
+    NSUInteger const lastBit = NSMaxRange(range) - 1;
+    NSUInteger const firstWord = range.location / MUK_BITSET_WORD_BITS;
+    NSUInteger const lastWord = lastBit / MUK_BITSET_WORD_BITS;
+    uint64_t const firstMask = MUKBitsetMaskFromBit(range.location % MUK_BITSET_WORD_BITS);
+    uint64_t const lastMask = MUKBitsetMaskThroughBit(lastBit % MUK_BITSET_WORD_BITS);
+    
+    if (firstWord == lastWord) {
+        return MUKBitsetPopCount(words[firstWord] & firstMask & lastMask);
+    }
+    
+    NSUInteger const middleCount = MUKBitsetCountWords(words + firstWord + 1, lastWord - firstWord - 1);
+    return MUKBitsetPopCount(words[firstWord] & firstMask) + middleCount + MUKBitsetPopCount(words[lastWord] & lastMask);
+}
+
+// Range must not be empty and must fit words
+static void MUKBitsetSetBitsInRange(uint64_t *words, NSRange range, BOOL value)
+{
+    NSUInteger const lastBit = NSMaxRange(range) - 1;
+    NSUInteger const firstWord = range.location / MUK_BITSET_WORD_BITS;
+    NSUInteger const lastWord = lastBit / MUK_BITSET_WORD_BITS;
+    uint64_t firstMask = MUKBitsetMaskFromBit(range.location % MUK_BITSET_WORD_BITS);
+    uint64_t const lastMask = MUKBitsetMaskThroughBit(lastBit % MUK_BITSET_WORD_BITS);
+    
+    if (firstWord == lastWord) {
+        firstMask &= lastMask;
+    }
+    
+    words[firstWord] = (value ? words[firstWord] | firstMask : words[firstWord] & ~firstMask);
+    
+    if (lastWord > firstWord) {
+        memset(words + firstWord + 1, (value ? 0xFF : 0), (lastWord - firstWord - 1) * sizeof(uint64_t));
+        words[lastWord] = (value ? words[lastWord] | lastMask : words[lastWord] & ~lastMask);
+    }
+}
+
+// Index of first bit equal to value at or after bit, considering bits
+// beyond words as unset
+static NSUInteger MUKBitsetNextBit(uint64_t const *words, NSUInteger count, NSUInteger bit, BOOL value)
+{
+    NSUInteger const bitsCount = count * MUK_BITSET_WORD_BITS;
+    if (bit >= bitsCount) return (value ? NSNotFound : bit);
+    
+    uint64_t const flip = (value ? 0 : ~(uint64_t)0);
+    NSUInteger w = bit / MUK_BITSET_WORD_BITS;
+    uint64_t word = (words[w] ^ flip) & MUKBitsetMaskFromBit(bit % MUK_BITSET_WORD_BITS);
+    
+    while (word == 0) {
+        if (++w == count) return (value ? NSNotFound : bitsCount);
+        word = words[w] ^ flip;
+    } // while
+    
+    return w * MUK_BITSET_WORD_BITS + MUKBitsetTrailingZeros(word);
+}
+
+static void MUKBitsetCombineWords(uint64_t *words, uint64_t const *otherWords, NSUInteger count, MUKBitsetOperation operation)
+{
+    NSUInteger i = 0;
+    
+    for (; i + MUK_BITSET_VECTOR_WORDS <= count; i += MUK_BITSET_VECTOR_WORDS)
+    {
+        MUKBitsetVector vector, otherVector;
+        memcpy(&vector, words + i, sizeof(vector));
+        memcpy(&otherVector, otherWords + i, sizeof(otherVector));
+        
+        switch (operation) {
+            case MUKBitsetOperationUnion:
+                vector |= otherVector;
+                break;
+            
+            case MUKBitsetOperationIntersection:
+                vector &= otherVector;
+                break;
+            
+            case MUKBitsetOperationDifference:
+                vector &= ~otherVector;
+                break;
+        }
+        
+        memcpy(words + i, &vector, sizeof(vector));
+    } // for
+    
+    for (; i < count; i++) {
+        switch (operation) {
+            case MUKBitsetOperationUnion:
+                words[i] |= otherWords[i];
+                break;
+            
+            case MUKBitsetOperationIntersection:
+                words[i] &= otherWords[i];
+                break;
+            
+            case MUKBitsetOperationDifference:
+                words[i] &= ~otherWords[i];
+                break;
+        }
+    } // for
+}
+
+// Index of the bit preceded by rank set bits into word (rank < popcount)
+NS_INLINE NSUInteger MUKBitsetSelectInWord(uint64_t word, NSUInteger rank) {
+    for (NSUInteger i = 0; i < rank; i++) {
+        word &= word - 1;
+    } // for
+    
+    return MUKBitsetTrailingZeros(word);
+}
+
+static uint64_t *MUKBitsetAllocateWords(NSUInteger count) {
+    void *buffer = NULL;
+    size_t const size = count * sizeof(uint64_t);
+    
+    if (posix_memalign(&buffer, MUK_BITSET_ALIGNMENT, size > 0 ? size : 1) != 0)
+    {
+        [NSException raise:NSMallocException format:@"Cannot allocate %lu bytes", (unsigned long)size];
+    }
+    
+    memset(buffer, 0, size);
+    return buffer;
+}
+
+@implementation MUKBitset {
+    uint64_t *words_;
+    NSUInteger wordsCapacity_;      // Words beyond wordsCount are zeroed
+    NSUInteger *ranks_;             // Set bits before each rank block
+    BOOL ranksValid_;
+}
+
+@synthesize wordsCount = wordsCount_;
+
+- (id)initWithCapacity:(NSUInteger)capacity {
+    self = [super init];
+    if (self) {
+        wordsCapacity_ = (capacity + MUK_BITSET_WORD_BITS - 1) / MUK_BITSET_WORD_BITS;
+        words_ = MUKBitsetAllocateWords(wordsCapacity_);
+    }
+    
+    return self;
+}
+
+- (id)initWithIndexSet:(NSIndexSet *)indexSet {
+    NSUInteger const lastIndex = [indexSet lastIndex];
+    
+    self = [self initWithCapacity:(lastIndex == NSNotFound ? 0 : lastIndex + 1)];
+    if (self) {
+        [indexSet enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+            [self addIndexesInRange:range];
+        }];
+    }
+    
+    return self;
+}
+
+- (id)initWithWords:(uint64_t const *)words count:(NSUInteger)wordsCount {
+    self = [self initWithCapacity:wordsCount * MUK_BITSET_WORD_BITS];
+    if (self && words && wordsCount > 0) {
+        memcpy(words_, words, wordsCount * sizeof(uint64_t));
+        wordsCount_ = wordsCount;
+    }
+    
+    return self;
+}
+
+- (id)init {
+    return [self initWithCapacity:0];
+}
+
+- (void)dealloc {
+    free(words_);
+    free(ranks_);
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone {
+    return [[[self class] allocWithZone:zone] initWithWords:words_ count:wordsCount_];
+}
+
+#pragma mark - Equality
+
+- (BOOL)isEqual:(id)object {
+    if (object == self) return YES;
+    if (![object isKindOfClass:[MUKBitset class]]) return NO;
+    
+    return [self isEqualToBitset:object];
+}
+
+- (NSUInteger)hash {
+    // Trailing zero words do not matter
+    NSUInteger const lastIndex = [self lastIndex];
+    return (lastIndex == NSNotFound ? 0 : lastIndex) ^ ([self count] << 16);
+}
+
+- (BOOL)isEqualToBitset:(MUKBitset *)bitset {
+    if (bitset == self) return YES;
+    if (bitset == nil) return NO;
+    
+    NSUInteger const commonCount = MIN(wordsCount_, bitset->wordsCount_);
+    if (memcmp(words_, bitset->words_, commonCount * sizeof(uint64_t)) != 0) {
+        return NO;
+    }
+    
+    // Exceeding words must be zero
+    MUKBitset *longerBitset = (wordsCount_ > commonCount ? self : bitset);
+    return (MUKBitsetNextBit(longerBitset->words_, longerBitset->wordsCount_, commonCount * MUK_BITSET_WORD_BITS, YES) == NSNotFound);
+}
+
+#pragma mark - Accessors
+
+- (uint64_t const *)words {
+    return words_;
+}
+
+- (NSIndexSet *)indexSet {
+    NSMutableIndexSet *indexSet = [[NSMutableIndexSet alloc] init];
+    NSUInteger start = MUKBitsetNextBit(words_, wordsCount_, 0, YES);
+    
+    while (start != NSNotFound) {
+        NSUInteger const end = MUKBitsetNextBit(words_, wordsCount_, start, NO);
+        [indexSet addIndexesInRange:NSMakeRange(start, end - start)];
+        start = MUKBitsetNextBit(words_, wordsCount_, end, YES);
+    } // while
+    
+    return indexSet;
+}
+
+#pragma mark - Queries
+
+- (NSUInteger)count {
+    if (ranksValid_) {
+        return ranks_[[self ranksCount_] - 1];
+    }
+    
+    return MUKBitsetCountWords(words_, wordsCount_);
+}
+
+- (NSUInteger)countOfIndexesInRange:(NSRange)range {
+    range = MUKBitsetClippedRange(range, wordsCount_ * MUK_BITSET_WORD_BITS);
+    if (range.length == 0) return 0;
+    
+    return MUKBitsetCountBitsInRange(words_, range);
+}
+
+- (BOOL)containsIndex:(NSUInteger)index {
+    NSUInteger const w = index / MUK_BITSET_WORD_BITS;
+    if (w >= wordsCount_) return NO;
+    
+    return ((words_[w] >> (index % MUK_BITSET_WORD_BITS)) & 1);
+}
+
+- (BOOL)containsIndexesInRange:(NSRange)range {
+    if (range.length > NSUIntegerMax - range.location) return NO;
+    if (NSMaxRange(range) > wordsCount_ * MUK_BITSET_WORD_BITS) return NO;
+    
+    return ([self countOfIndexesInRange:range] == range.length);
+}
+
+- (NSUInteger)firstIndex {
+    return MUKBitsetNextBit(words_, wordsCount_, 0, YES);
+}
+
+- (NSUInteger)lastIndex {
+    for (NSUInteger w = wordsCount_; w > 0; w--) {
+        uint64_t const word = words_[w - 1];
+        
+        if (word != 0) {
+            return (w - 1) * MUK_BITSET_WORD_BITS + (MUK_BITSET_WORD_BITS - 1 - MUKBitsetLeadingZeros(word));
+        }
+    } // for
+    
+    return NSNotFound;
+}
+
+- (NSUInteger)indexGreaterThanIndex:(NSUInteger)index {
+    if (index == NSUIntegerMax) return NSNotFound;
+    return MUKBitsetNextBit(words_, wordsCount_, index + 1, YES);
+}
+
+#pragma mark - Rank
+
+- (NSUInteger)rankOfIndex:(NSUInteger)index {
+    [self buildRanksIfNeeded_];
+    
+    NSUInteger const w = index / MUK_BITSET_WORD_BITS;
+    if (w >= wordsCount_) {
+        return ranks_[[self ranksCount_] - 1];
+    }
+    
+    NSUInteger const block = w / MUK_BITSET_RANK_BLOCK_WORDS;
+    NSUInteger const blockStart = block * MUK_BITSET_RANK_BLOCK_WORDS;
+    NSUInteger rank = ranks_[block] + MUKBitsetCountWords(words_ + blockStart, w - blockStart);
+    
+    NSUInteger const bit = index % MUK_BITSET_WORD_BITS;
+    if (bit > 0) {
+        rank += MUKBitsetPopCount(words_[w] & MUKBitsetMaskThroughBit(bit - 1));
+    }
+    
+    return rank;
+}
+
+- (NSUInteger)indexWithRank:(NSUInteger)rank {
+    [self buildRanksIfNeeded_];
+    
+    NSUInteger const ranksCount = [self ranksCount_];
+    if (rank >= ranks_[ranksCount - 1]) return NSNotFound;
+    
+    // Last block which starts with no more than rank set bits before it
+    NSUInteger low = 0, high = ranksCount - 1;
+    while (high - low > 1) {
+        NSUInteger const middle = low + (high - low)/2;
+        
+        if (ranks_[middle] <= rank) {
+            low = middle;
+        }
+        else {
+            high = middle;
+        }
+    } // while
+    
+    rank -= ranks_[low];
+    
+    for (NSUInteger w = low * MUK_BITSET_RANK_BLOCK_WORDS; w < wordsCount_; w++)
+    {
+        NSUInteger const wordCount = MUKBitsetPopCount(words_[w]);
+        
+        if (rank < wordCount) {
+            return w * MUK_BITSET_WORD_BITS + MUKBitsetSelectInWord(words_[w], rank);
+        }
+        
+        rank -= wordCount;
+    } // for
+    
+    return NSNotFound;
+}
+
+#pragma mark - Enumeration
+
+- (void)enumerateIndexesUsingBlock:(void (^)(NSUInteger, BOOL *))block {
+    [self enumerateIndexesInRange:NSMakeRange(0, NSUIntegerMax) usingBlock:block];
+}
+
+- (void)enumerateIndexesInRange:(NSRange)range usingBlock:(void (^)(NSUInteger, BOOL *))block
+{
+    if (!block) return;
+    
+    range = MUKBitsetClippedRange(range, wordsCount_ * MUK_BITSET_WORD_BITS);
+    if (range.length == 0) return;
+    
+    NSUInteger const lastBit = NSMaxRange(range) - 1;
+    NSUInteger const firstWord = range.location / MUK_BITSET_WORD_BITS;
+    NSUInteger const lastWord = lastBit / MUK_BITSET_WORD_BITS;
+    BOOL stop = NO;
+    
+    for (NSUInteger w = firstWord; w <= lastWord && !stop; w++) {
+        uint64_t word = words_[w];
+        
+        if (w == firstWord) word &= MUKBitsetMaskFromBit(range.location % MUK_BITSET_WORD_BITS);
+        if (w == lastWord) word &= MUKBitsetMaskThroughBit(lastBit % MUK_BITSET_WORD_BITS);
+        
+        // Visit set bits only, clearing lowest one each time
+        while (word != 0 && !stop) {
+            block(w * MUK_BITSET_WORD_BITS + MUKBitsetTrailingZeros(word), &stop);
+            word &= word - 1;
+        } // while
+    } // for
+}
+
+#pragma mark - Changes
+
+- (void)addIndex:(NSUInteger)index {
+    NSUInteger const w = index / MUK_BITSET_WORD_BITS;
+    [self ensureWordsCount_:w + 1];
+    
+    words_[w] |= ((uint64_t)1 << (index % MUK_BITSET_WORD_BITS));
+    ranksValid_ = NO;
+}
+
+- (void)addIndexesInRange:(NSRange)range {
+    range.length = MIN(range.length, NSUIntegerMax - range.location);
+    if (range.length == 0) return;
+    
+    [self ensureWordsCount_:(NSMaxRange(range) - 1) / MUK_BITSET_WORD_BITS + 1];
+    MUKBitsetSetBitsInRange(words_, range, YES);
+    ranksValid_ = NO;
+}
+
+- (void)removeIndex:(NSUInteger)index {
+    NSUInteger const w = index / MUK_BITSET_WORD_BITS;
+    if (w >= wordsCount_) return;
+    
+    words_[w] &= ~((uint64_t)1 << (index % MUK_BITSET_WORD_BITS));
+    ranksValid_ = NO;
+}
+
+- (void)removeIndexesInRange:(NSRange)range {
+    range = MUKBitsetClippedRange(range, wordsCount_ * MUK_BITSET_WORD_BITS);
+    if (range.length == 0) return;
+    
+    MUKBitsetSetBitsInRange(words_, range, NO);
+    ranksValid_ = NO;
+}
+
+- (void)removeAllIndexes {
+    memset(words_, 0, wordsCount_ * sizeof(uint64_t));
+    ranksValid_ = NO;
+}
+
+#pragma mark - Set Operations
+
+- (void)unionWithBitset:(MUKBitset *)bitset {
+    if (bitset == nil) return;
+    
+    [self ensureWordsCount_:bitset->wordsCount_];
+    MUKBitsetCombineWords(words_, bitset->words_, bitset->wordsCount_, MUKBitsetOperationUnion);
+    ranksValid_ = NO;
+}
+
+- (void)intersectWithBitset:(MUKBitset *)bitset {
+    if (bitset == nil) {
+        [self removeAllIndexes];
+        return;
+    }
+    
+    NSUInteger const commonCount = MIN(wordsCount_, bitset->wordsCount_);
+    
+    MUKBitsetCombineWords(words_, bitset->words_, commonCount, MUKBitsetOperationIntersection);
+    memset(words_ + commonCount, 0, (wordsCount_ - commonCount) * sizeof(uint64_t));
+    ranksValid_ = NO;
+}
+
+- (void)minusBitset:(MUKBitset *)bitset {
+    if (bitset == nil) return;
+    
+    NSUInteger const commonCount = MIN(wordsCount_, bitset->wordsCount_);
+    MUKBitsetCombineWords(words_, bitset->words_, commonCount, MUKBitsetOperationDifference);
+    ranksValid_ = NO;
+}
+
+#pragma mark - Private
+
+- (void)ensureWordsCount_:(NSUInteger)count {
+    if (count <= wordsCount_) return;
+    
+    if (count > wordsCapacity_) {
+        NSUInteger const capacity = MAX(count, wordsCapacity_ * 2);
+        uint64_t *words = MUKBitsetAllocateWords(capacity);
+        
+        memcpy(words, words_, wordsCount_ * sizeof(uint64_t));
+        free(words_);
+        
+        words_ = words;
+        wordsCapacity_ = capacity;
+    }
+    
+    wordsCount_ = count;
+}
+
+- (NSUInteger)ranksCount_ {
+    // Last entry is total count
+    return (wordsCount_ + MUK_BITSET_RANK_BLOCK_WORDS - 1) / MUK_BITSET_RANK_BLOCK_WORDS + 1;
+}
+
+- (void)buildRanksIfNeeded_ {
+    if (ranksValid_) return;
+    
+    NSUInteger const ranksCount = [self ranksCount_];
+    ranks_ = realloc(ranks_, ranksCount * sizeof(NSUInteger));
+    
+    NSUInteger rank = 0;
+    for (NSUInteger block = 0; block < ranksCount; block++) {
+        ranks_[block] = rank;
+        
+        NSUInteger const blockStart = block * MUK_BITSET_RANK_BLOCK_WORDS;
+        if (blockStart < wordsCount_) {
+            rank += MUKBitsetCountWords(words_ + blockStart, MIN((NSUInteger)MUK_BITSET_RANK_BLOCK_WORDS, wordsCount_ - blockStart));
+        }
+    } // for
+    
+    ranksValid_ = YES;
+}
+
+@end
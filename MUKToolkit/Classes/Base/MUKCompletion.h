@@ -0,0 +1,115 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import <Foundation/Foundation.h>
+
+/**
+ A completion you can signal from any thread and wait for.
+ 
+ It replaces polling of a `BOOL` (like waitForCompletion:timeout:runLoop: in
+ MUK(Generic) does): signal is atomic and it wakes waiters immediately.
+ 
+    MUKCompletion *completion = [[MUKCompletion alloc] init];
+ 
+    dispatch_async(asyncQueue, ^(void) {
+        TimeConsumingRoutine();
+        [completion signal];
+    });
+ 
+    NSTimeInterval waitDuration;
+    BOOL done = [completion waitWithTimeout:60.0 waitDuration:&waitDuration];
+ 
+ You can wait in two ways:
+ 
+ * blocking current thread (waitWithTimeout:waitDuration:), which sleeps on a
+ semaphore until completion is signalled;
+ * running a run loop (waitWithTimeout:runLoop:waitDuration:), which keeps
+ processing run loop sources while waiting. Use it when completion is 
+ signalled by something which needs that run loop, like a `NSURLConnection`
+ scheduled on main thread or a block dispatched on main queue.
+ 
+ You can also wait for many completions, all of them or the first one.
+ 
+ Timeouts follow waitForCompletion:timeout:runLoop: in MUK(Generic): if 
+ timeout is not positive, there is no timeout.
+ */
+@interface MUKCompletion : NSObject
+/**
+ Marks completion as completed and wakes waiters.
+ 
+ Completion is signalled once: further calls do nothing.
+ 
+ @return `YES` if this call completed the completion.
+ */
+- (BOOL)signal;
+/**
+ Tells if completion has been signalled.
+ @return `YES` if signal has been called.
+ */
+- (BOOL)isCompleted;
+
+/**
+ Blocks current thread until completion is signalled.
+ @param timeout Maximum time interval to wait.
+ @param waitDuration A pointer where time spent waiting is stored. It can be
+ `NULL`.
+ @return `YES` if completion has been signalled; `NO` if timeout fired.
+ */
+- (BOOL)waitWithTimeout:(NSTimeInterval)timeout waitDuration:(NSTimeInterval *)waitDuration;
+/**
+ Runs a run loop in default mode until completion is signalled.
+ @param timeout Maximum time interval to wait.
+ @param runLoop Run loop where to wait. Leave this parameter `nil` to use
+ `[NSRunLoop currentRunLoop]`.
+ @param waitDuration A pointer where time spent waiting is stored. It can be
+ `NULL`.
+ @return `YES` if completion has been signalled; `NO` if timeout fired.
+ */
+- (BOOL)waitWithTimeout:(NSTimeInterval)timeout runLoop:(NSRunLoop *)runLoop waitDuration:(NSTimeInterval *)waitDuration;
+
+/**
+ Waits until every completion is signalled.
+ @param completions An array of MUKCompletion objects.
+ @param timeout Maximum time interval to wait.
+ @param runLoop Run loop where to wait. If `nil` current thread is blocked 
+ without running a run loop.
+ @param waitDuration A pointer where time spent waiting is stored. It can be
+ `NULL`.
+ @return `YES` if every completion has been signalled; `NO` if timeout fired.
+ */
++ (BOOL)waitForAllCompletions:(NSArray *)completions timeout:(NSTimeInterval)timeout runLoop:(NSRunLoop *)runLoop waitDuration:(NSTimeInterval *)waitDuration;
+/**
+ Waits until a completion is signalled.
+ @param completions An array of MUKCompletion objects.
+ @param timeout Maximum time interval to wait.
+ @param runLoop Run loop where to wait. If `nil` current thread is blocked 
+ without running a run loop.
+ @param waitDuration A pointer where time spent waiting is stored. It can be
+ `NULL`.
+ @return Index of the first signalled completion into `completions` or 
+ `NSNotFound` if timeout fired (or if `completions` is empty).
+ */
++ (NSUInteger)waitForAnyCompletion:(NSArray *)completions timeout:(NSTimeInterval)timeout runLoop:(NSRunLoop *)runLoop waitDuration:(NSTimeInterval *)waitDuration;
+@end
@@ -0,0 +1,254 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUKCompletion.h"
+
+// Orders signals, so waiting for any completion returns the first one
+static volatile int64_t MUKCompletionLastSequence = 0;
+
+static void MUKCompletionWaiterPerform(void *info) {
+    // Nothing to do: it is enough to make run loop return
+}
+
+#pragma mark - Waiter
+
+// Sleeps until a completion wakes it, on a semaphore or on a run loop
+@interface MUKCompletionWaiter : NSObject
+- (id)initWithRunLoop:(NSRunLoop *)runLoop;
+- (void)wake;
+- (BOOL)sleepUntilTime:(CFAbsoluteTime)deadline;
+- (void)invalidate;
+@end
+
+@implementation MUKCompletionWaiter {
+    dispatch_semaphore_t semaphore_;
+    NSRunLoop *runLoop_;
+    CFRunLoopRef cfRunLoop_;
+    CFRunLoopSourceRef source_;
+}
+
+- (id)initWithRunLoop:(NSRunLoop *)runLoop {
+    self = [super init];
+    if (self) {
+        if (runLoop) {
+            CFRunLoopSourceContext context;
+            memset(&context, 0, sizeof(context));
+            context.perform = MUKCompletionWaiterPerform;
+            
+            runLoop_ = runLoop;
+            cfRunLoop_ = [runLoop getCFRunLoop];
+            source_ = CFRunLoopSourceCreate(kCFAllocatorDefault, 0, &context);
+            CFRunLoopAddSource(cfRunLoop_, source_, kCFRunLoopDefaultMode);
+        }
+        else {
+            semaphore_ = dispatch_semaphore_create(0);
+        }
+    }
+    
+    return self;
+}
+
+- (void)dealloc {
+    if (source_) CFRelease(source_);
+    if (semaphore_) dispatch_release(semaphore_);
+}
+
+- (void)wake {
+    if (source_) {
+        CFRunLoopSourceSignal(source_);
+        CFRunLoopWakeUp(cfRunLoop_);
+    }
+    else {
+        dispatch_semaphore_signal(semaphore_);
+    }
+}
+
+- (BOOL)sleepUntilTime:(CFAbsoluteTime)deadline {
+    CFAbsoluteTime const now = CFAbsoluteTimeGetCurrent();
+    if (now >= deadline) return NO;
+    
+    if (source_) {
+        NSDate *deadlineDate = (isinf(deadline) ? [NSDate distantFuture] : [NSDate dateWithTimeIntervalSinceReferenceDate:deadline]);
+        [runLoop_ runMode:NSDefaultRunLoopMode beforeDate:deadlineDate];
+        return CFAbsoluteTimeGetCurrent() < deadline;
+    }
+    
+    dispatch_time_t const timeout = (isinf(deadline) ? DISPATCH_TIME_FOREVER : dispatch_time(DISPATCH_TIME_NOW, (int64_t)((deadline - now) * NSEC_PER_SEC)));
+    return dispatch_semaphore_wait(semaphore_, timeout) == 0;
+}
+
+- (void)invalidate {
+    if (source_) {
+        CFRunLoopSourceInvalidate(source_);
+    }
+}
+
+@end
+
+#pragma mark - Completion
+
+@implementation MUKCompletion {
+    // Position of signal among all signals, 0 until signalled
+    volatile int64_t sequence_;
+    NSMutableArray *waiters_;
+}
+
+- (id)init {
+    self = [super init];
+    if (self) {
+        waiters_ = [[NSMutableArray alloc] init];
+    }
+    
+    return self;
+}
+
+- (BOOL)signal {
+    int64_t const sequence = __sync_add_and_fetch(&MUKCompletionLastSequence, 1);
+    if (!__sync_bool_compare_and_swap(&sequence_, 0, sequence)) {
+        return NO;
+    }
+    
+    // Waiters registered after the copy find completion already signalled
+    NSArray *waiters;
+    @synchronized(self) {
+        waiters = [waiters_ copy];
+    }
+    
+    for (MUKCompletionWaiter *waiter in waiters) {
+        [waiter wake];
+    } // for
+    
+    return YES;
+}
+
+- (BOOL)isCompleted {
+    return [self sequence_] != 0;
+}
+
+- (BOOL)waitWithTimeout:(NSTimeInterval)timeout waitDuration:(NSTimeInterval *)waitDuration
+{
+    return [[self class] waitForAllCompletions:@[self] timeout:timeout runLoop:nil waitDuration:waitDuration];
+}
+
+- (BOOL)waitWithTimeout:(NSTimeInterval)timeout runLoop:(NSRunLoop *)runLoop waitDuration:(NSTimeInterval *)waitDuration
+{
+    runLoop = (runLoop ?: [NSRunLoop currentRunLoop]);
+    return [[self class] waitForAllCompletions:@[self] timeout:timeout runLoop:runLoop waitDuration:waitDuration];
+}
+
+#pragma mark - Many Completions
+
++ (BOOL)waitForAllCompletions:(NSArray *)completions timeout:(NSTimeInterval)timeout runLoop:(NSRunLoop *)runLoop waitDuration:(NSTimeInterval *)waitDuration
+{
+    NSUInteger index;
+    return [self waitForCompletions_:completions all:YES timeout:timeout runLoop:runLoop waitDuration:waitDuration index:&index];
+}
+
++ (NSUInteger)waitForAnyCompletion:(NSArray *)completions timeout:(NSTimeInterval)timeout runLoop:(NSRunLoop *)runLoop waitDuration:(NSTimeInterval *)waitDuration
+{
+    NSUInteger index = NSNotFound;
+    BOOL const satisfied = [self waitForCompletions_:completions all:NO timeout:timeout runLoop:runLoop waitDuration:waitDuration index:&index];
+    return (satisfied ? index : NSNotFound);
+}
+
+#pragma mark - Private
+
+- (int64_t)sequence_ {
+    return __sync_fetch_and_add(&sequence_, 0);
+}
+
+- (void)addWaiter_:(MUKCompletionWaiter *)waiter {
+    @synchronized(self) {
+        [waiters_ addObject:waiter];
+    }
+}
+
+- (void)removeWaiter_:(MUKCompletionWaiter *)waiter {
+    @synchronized(self) {
+        [waiters_ removeObjectIdenticalTo:waiter];
+    }
+}
+
+// With all == NO, index is set to first signalled completion
++ (BOOL)completions_:(NSArray *)completions satisfyAll:(BOOL)all index:(NSUInteger *)index
+{
+    int64_t firstSequence = INT64_MAX;
+    NSUInteger firstIndex = NSNotFound, i = 0;
+    
+    for (MUKCompletion *completion in completions) {
+        int64_t const sequence = [completion sequence_];
+        
+        if (all) {
+            if (sequence == 0) return NO;
+        }
+        else if (sequence != 0 && sequence < firstSequence) {
+            firstSequence = sequence;
+            firstIndex = i;
+        }
+        
+        i++;
+    } // for
+    
+    *index = firstIndex;
+    return (all || firstIndex != NSNotFound);
+}
+
++ (BOOL)waitForCompletions_:(NSArray *)completions all:(BOOL)all timeout:(NSTimeInterval)timeout runLoop:(NSRunLoop *)runLoop waitDuration:(NSTimeInterval *)waitDuration index:(NSUInteger *)index
+{
+    CFAbsoluteTime const startTime = CFAbsoluteTimeGetCurrent();
+    CFAbsoluteTime const deadline = (timeout > 0.0 ? startTime + timeout : INFINITY);
+    BOOL satisfied = [self completions_:completions satisfyAll:all index:index];
+    
+    if (!satisfied && [completions count] > 0) {
+        // Register before checking again, so no signal is missed
+        MUKCompletionWaiter *waiter = [[MUKCompletionWaiter alloc] initWithRunLoop:runLoop];
+        
+        for (MUKCompletion *completion in completions) {
+            [completion addWaiter_:waiter];
+        } // for
+        
+        while (!(satisfied = [self completions_:completions satisfyAll:all index:index]))
+        {
+            if (![waiter sleepUntilTime:deadline]) {
+                satisfied = [self completions_:completions satisfyAll:all index:index];
+                break;
+            }
+        } // while
+        
+        for (MUKCompletion *completion in completions) {
+            [completion removeWaiter_:waiter];
+        } // for
+        
+        [waiter invalidate];
+    }
+    
+    if (waitDuration) {
+        *waitDuration = CFAbsoluteTimeGetCurrent() - startTime;
+    }
+    
+    return satisfied;
+}
+
+@end
@@ -0,0 +1,64 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Private header: digests used by toolkit categories.
+//
+// CommonCrypto exists on Apple platforms only. Other Foundation builds (e.g.
+// Foundation-only categories built with GNUstep to run benchmarks headless on
+// Linux) get the same digests from OpenSSL, whose API has the same shape
+// without the CC_ prefix: link them with -lcrypto.
+
+#ifdef __APPLE__
+
+#import <CommonCrypto/CommonDigest.h>
+
+#else
+
+// Low level digest API is deprecated in OpenSSL 3, but it is still there
+#ifndef OPENSSL_SUPPRESS_DEPRECATED
+#define OPENSSL_SUPPRESS_DEPRECATED
+#endif
+
+#include <openssl/md5.h>
+#include <openssl/sha.h>
+
+typedef uint32_t CC_LONG;
+typedef SHA_CTX CC_SHA1_CTX;
+typedef MD5_CTX CC_MD5_CTX;
+
+#define CC_SHA1_DIGEST_LENGTH   SHA_DIGEST_LENGTH
+#define CC_MD5_DIGEST_LENGTH    MD5_DIGEST_LENGTH
+
+#define CC_SHA1_Init    SHA1_Init
+#define CC_SHA1_Update  SHA1_Update
+#define CC_SHA1_Final   SHA1_Final
+#define CC_SHA1         SHA1
+
+#define CC_MD5_Init     MD5_Init
+#define CC_MD5_Update   MD5_Update
+#define CC_MD5_Final    MD5_Final
+#define CC_MD5          MD5
+
+#endif
@@ -74,4 +74,27 @@
  */
 + (UIColor *)color:(UIColor *)sourceColor withHSBATransformation:(UIColor *(^)(CGFloat hue, CGFloat saturation, CGFloat brightness, CGFloat alpha))transformationBlock;
 
+/**
+ Blends two colors in linear light.
+ 
+ Blending sRGB encoded components directly gives dark, muddy midpoints: 
+ components are converted to linear light with MUKPixelSRGBToLinear() 
+ before they are interpolated. Colors are weighted by their alpha, so a
+ transparent color does not darken the blend.
+ 
+ ** Example **
+    
+    // Brighter than [UIColor colorWithRed:0.5f green:0.0f blue:0.5f alpha:1.0f]
+    UIColor *color = [MUK color:[UIColor redColor] blendedWithColor:[UIColor blueColor] fraction:0.5f];
+ 
+ @param color The first color.
+ @param otherColor The second color.
+ @param fraction How much of otherColor goes into the blend, between `0.0` 
+ (color) and `1.0` (otherColor).
+ @return The blended color, or `nil` if RGBA components of a color could not
+ be extracted.
+ @see [MUK image:blendedWithImage:fraction:]
+ */
++ (UIColor *)color:(UIColor *)color blendedWithColor:(UIColor *)otherColor fraction:(CGFloat)fraction;
+
 @end
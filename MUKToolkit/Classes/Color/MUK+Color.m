@@ -24,6 +24,8 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #import "MUK+Color.h"
+#import "MUK+Instrumentation.h"
+#import "MUKPixelKernels.h"
 
 @implementation MUK (Color)
 
@@ -46,6 +48,7 @@
 }
 
 + (UIColor *)colorWithHexadecimalString:(NSString *)hexString {
+    MUK_INSTRUMENT([hexString length] * sizeof(unichar));
     // Convert to lowercase
     hexString = [hexString lowercaseString];
     
@@ -96,6 +99,7 @@
 
 + (UIColor *)color:(UIColor *)color withHSBATransformation:(UIColor *(^)(CGFloat hue, CGFloat saturation, CGFloat brightness, CGFloat alpha))transformationBlock
 {
+    MUK_INSTRUMENT(0);
     if (!transformationBlock) {
         return color;
     }
@@ -108,4 +112,54 @@
     return transformationBlock(h, s, b, a);
 }
 
++ (UIColor *)color:(UIColor *)color blendedWithColor:(UIColor *)otherColor fraction:(CGFloat)fraction
+{
+    MUK_INSTRUMENT(0);
+    CGFloat components[2][4];
+    if (![self getRGBAComponents_:components[0] ofColor:color] ||
+        ![self getRGBAComponents_:components[1] ofColor:otherColor])
+    {
+        return nil;
+    }
+    
+    fraction = MAX(0.0f, MIN(fraction, 1.0f));
+    CGFloat const alpha = components[0][3] * (1.0f - fraction) + components[1][3] * fraction;
+    CGFloat blended[3];
+    
+    for (NSUInteger c = 0; c < 3; c++) {
+        CGFloat const first = MUKPixelSRGBToLinear(components[0][c]);
+        CGFloat const second = MUKPixelSRGBToLinear(components[1][c]);
+        CGFloat linear;
+        
+        if (alpha > 0.0f) {
+            linear = (first * components[0][3] * (1.0f - fraction) + second * components[1][3] * fraction) / alpha;
+        }
+        else {
+            linear = first + (second - first) * fraction;
+        }
+        
+        blended[c] = MUKPixelLinearToSRGB(linear);
+    } // for
+    
+    return [UIColor colorWithRed:blended[0] green:blended[1] blue:blended[2] alpha:alpha];
+}
+
+#pragma mark - Private
+
++ (BOOL)getRGBAComponents_:(CGFloat *)components ofColor:(UIColor *)color {
+    if ([color getRed:&components[0] green:&components[1] blue:&components[2] alpha:&components[3]])
+    {
+        return YES;
+    }
+    
+    // Grayscale colors
+    CGFloat white;
+    if ([color getWhite:&white alpha:&components[3]]) {
+        components[0] = components[1] = components[2] = white;
+        return YES;
+    }
+    
+    return NO;
+}
+
 @end
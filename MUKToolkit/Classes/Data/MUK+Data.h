@@ -28,7 +28,13 @@
 typedef enum : NSUInteger {
     MUKDataTransformIdentity = 0,
     MUKDataTransformSHA1,
-    MUKDataTransformMD5
+    MUKDataTransformMD5,
+    MUKDataTransformDeflate,
+    MUKDataTransformInflate,
+    MUKDataTransformGzip,
+    MUKDataTransformGunzip,
+    MUKDataTransformLZ4Compress,
+    MUKDataTransformLZ4Decompress
 } MUKDataTransform;
 
 /**
@@ -41,6 +47,19 @@ typedef enum : NSUInteger {
  * `MUKDataTransformIdentity` does nothing.
  * `MUKDataTransformSHA1` transform given data applying SHA-1 hashing.
  * `MUKDataTransformMD5` transform given data applying MD5 hashing.
+ * `MUKDataTransformDeflate` compresses given data with deflate, using zlib
+ format.
+ * `MUKDataTransformInflate` decompresses given data in zlib or gzip format.
+ * `MUKDataTransformGzip` compresses given data with deflate, using gzip
+ format.
+ * `MUKDataTransformGunzip` decompresses given data in gzip or zlib format.
+ * `MUKDataTransformLZ4Compress` compresses given data with LZ4, using LZ4
+ frame format.
+ * `MUKDataTransformLZ4Decompress` decompresses given data in LZ4 frame 
+ format.
+ 
+ Compression transforms use default level: use MUKDataCompressionStream in
+ order to choose a level or to process data chunk by chunk.
  
  */
 @interface MUK (Data)
@@ -48,7 +67,8 @@ typedef enum : NSUInteger {
  Transforms data.
  @param data Data to transform.
  @param transform Kind of transform to apply to `data`.
- @return Transformed data.
+ @return Transformed data. Decompression transforms return `nil` if `data` is
+ corrupted or truncated.
  */
 + (NSData *)data:(NSData *)data applyingTransform:(MUKDataTransform)transform;
 /**
@@ -58,4 +78,79 @@ typedef enum : NSUInteger {
  `*stop` pointer, which could be set to `YES` in order to stop enumeration.
  */
 + (void)data:(NSData *)data enumerateBytesUsingBlock:(void (^)(unsigned char const byte, NSInteger index, BOOL *stop))block;
+/**
+ Enumerates contiguous spans of data with a block.
+ 
+ This is way faster than data:enumerateBytesUsingBlock: because block is 
+ called once per span instead of once per byte. Data which is not stored
+ contiguously (e.g. data backed by `dispatch_data_t`) is enumerated region
+ by region, without being flattened.
+ 
+ @param data Data to enumerate.
+ @param maximumLength Maximum length of a span. Pass `0` to enumerate 
+ contiguous regions whole.
+ @param block Block called for each span. It includes a pointer to the first
+ `bytes` of the span, its `range` into `data` and `*stop` pointer, which 
+ could be set to `YES` in order to stop enumeration.
+ */
++ (void)data:(NSData *)data enumerateSpansOfMaximumLength:(NSUInteger)maximumLength usingBlock:(void (^)(unsigned char const *bytes, NSRange range, BOOL *stop))block;
+
+/**
+ Finds a byte.
+ @param data Data to scan.
+ @param byte Byte to find.
+ @param range Range of `data` to scan. It is clipped to data length, so you
+ can pass `NSMakeRange(0, NSUIntegerMax)` to scan whole data.
+ @return Index of first occurrence of `byte` inside `range` or `NSNotFound`.
+ */
++ (NSUInteger)data:(NSData *)data indexOfByte:(unsigned char)byte inRange:(NSRange)range;
+/**
+ Finds any byte of a set.
+ 
+ Sets up to 4 bytes (e.g. line delimiters) are scanned with vector 
+ comparisons.
+ 
+ @param data Data to scan.
+ @param byteSet Set of bytes to find. Indexes bigger than `255` are ignored.
+ @param range Range of `data` to scan. It is clipped to data length.
+ @return Index of first occurrence of a byte of `byteSet` inside `range` or
+ `NSNotFound`.
+ */
++ (NSUInteger)data:(NSData *)data indexOfByteInSet:(NSIndexSet *)byteSet inRange:(NSRange)range;
+/**
+ Finds a sequence of bytes.
+ @param data Data to scan.
+ @param bytes Sequence of bytes to find.
+ @param range Range of `data` to scan. It is clipped to data length.
+ @return Range of first occurrence of `bytes` inside `range` or
+ `{NSNotFound, 0}`. Empty `bytes` are never found.
+ */
++ (NSRange)data:(NSData *)data rangeOfBytes:(NSData *)bytes inRange:(NSRange)range;
+/**
+ Counts occurrences of a byte.
+ @param data Data to scan.
+ @param byte Byte to count.
+ @return Number of occurrences of `byte` inside `data`.
+ */
++ (NSUInteger)data:(NSData *)data countOfByte:(unsigned char)byte;
+/**
+ Counts occurrences of every byte value.
+ @param data Data to scan.
+ @param histogram A C array of 256 elements, where occurrences of byte `b`
+ are stored at `histogram[b]`.
+ */
++ (void)data:(NSData *)data getByteHistogram:(NSUInteger *)histogram;
+/**
+ Splits data on a delimiter.
+ 
+ This method works like `-[NSString componentsSeparatedByString:]`: 
+ adjacent delimiters give empty ranges and data without delimiters gives a 
+ single range.
+ 
+ @param data Data to split.
+ @param delimiter Byte which separates components.
+ @return An array of `NSValue` objects wrapping ranges of components, 
+ delimiters excluded.
+ */
++ (NSArray *)data:(NSData *)data rangesSeparatedByByte:(unsigned char)delimiter;
 @end
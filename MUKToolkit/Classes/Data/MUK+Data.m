@@ -24,31 +24,286 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #import "MUK+Data.h"
-#import <CommonCrypto/CommonDigest.h>
+#import "MUKDigest.h"
+#import "MUK+Instrumentation.h"
+#import "MUKDataCompressionStream.h"
+#import "MUKChunkedData.h"
+
+typedef uint8_t MUKDataByteVector __attribute__((vector_size(16)));
+typedef uint64_t MUKDataWordVector __attribute__((vector_size(16)));
+
+#define MUK_DATA_VECTOR_LENGTH          16
+#define MUK_DATA_SMALL_BYTE_SET_COUNT   4
+
+NS_INLINE MUKDataByteVector MUKDataLoadVector(uint8_t const *bytes) {
+    MUKDataByteVector vector;
+    memcpy(&vector, bytes, sizeof(vector));
+    return vector;
+}
+
+NS_INLINE MUKDataByteVector MUKDataSplatVector(uint8_t byte) {
+    MUKDataByteVector vector;
+    for (NSUInteger i = 0; i < MUK_DATA_VECTOR_LENGTH; i++) {
+        vector[i] = byte;
+    } // for
+    
+    return vector;
+}
+
+NS_INLINE uint64_t MUKDataLowMatchWord(MUKDataByteVector mask) {
+    return ((MUKDataWordVector)mask)[0];
+}
+
+NS_INLINE uint64_t MUKDataHighMatchWord(MUKDataByteVector mask) {
+    return ((MUKDataWordVector)mask)[1];
+}
+
+// Offset of first matching byte in a comparison mask (0xFF per match),
+// or -1 if nothing matches. Bytes are little endian.
+NS_INLINE NSInteger MUKDataFirstMatch(MUKDataByteVector mask) {
+    uint64_t const low = MUKDataLowMatchWord(mask);
+    if (low) return __builtin_ctzll(low) >> 3;
+    
+    uint64_t const high = MUKDataHighMatchWord(mask);
+    if (high) return 8 + (__builtin_ctzll(high) >> 3);
+    
+    return -1;
+}
+
+static NSUInteger MUKDataIndexOfByte(uint8_t const *bytes, NSUInteger length, uint8_t byte)
+{
+    // memchr() is vectorized by libc already
+    uint8_t const *match = memchr(bytes, byte, length);
+    return (match ? (NSUInteger)(match - bytes) : NSNotFound);
+}
+
+static NSUInteger MUKDataIndexOfByteInSet(uint8_t const *bytes, NSUInteger length, uint8_t const *members, NSUInteger membersCount, BOOL const table[256])
+{
+    if (membersCount == 0) return NSNotFound;
+    if (membersCount == 1) return MUKDataIndexOfByte(bytes, length, members[0]);
+    
+    NSUInteger i = 0;
+    
+    // Small sets are tested with a vector comparison per member
+    if (membersCount <= MUK_DATA_SMALL_BYTE_SET_COUNT) {
+        MUKDataByteVector needles[MUK_DATA_SMALL_BYTE_SET_COUNT];
+        for (NSUInteger m = 0; m < membersCount; m++) {
+            needles[m] = MUKDataSplatVector(members[m]);
+        } // for
+        
+        for (; i + MUK_DATA_VECTOR_LENGTH <= length; i += MUK_DATA_VECTOR_LENGTH)
+        {
+            MUKDataByteVector const vector = MUKDataLoadVector(bytes + i);
+            MUKDataByteVector mask = (MUKDataByteVector)(vector == needles[0]);
+            for (NSUInteger m = 1; m < membersCount; m++) {
+                mask |= (MUKDataByteVector)(vector == needles[m]);
+            } // for
+            
+            NSInteger const offset = MUKDataFirstMatch(mask);
+            if (offset >= 0) return i + (NSUInteger)offset;
+        } // for
+    }
+    
+    for (; i < length; i++) {
+        if (table[bytes[i]]) return i;
+    } // for
+    
+    return NSNotFound;
+}
+
+static NSUInteger MUKDataIndexOfBytes(uint8_t const *bytes, NSUInteger length, uint8_t const *needle, NSUInteger needleLength)
+{
+    if (needleLength == 0 || needleLength > length) return NSNotFound;
+    if (needleLength == 1) return MUKDataIndexOfByte(bytes, length, needle[0]);
+    
+    // Candidates match both first and last byte of needle: only them are
+    // compared entirely
+    NSUInteger const lastIndex = length - needleLength;
+    MUKDataByteVector const firstNeedle = MUKDataSplatVector(needle[0]);
+    MUKDataByteVector const lastNeedle = MUKDataSplatVector(needle[needleLength - 1]);
+    NSUInteger i = 0;
+    
+    for (; i + MUK_DATA_VECTOR_LENGTH <= lastIndex + 1; i += MUK_DATA_VECTOR_LENGTH)
+    {
+        MUKDataByteVector const mask = (MUKDataByteVector)(MUKDataLoadVector(bytes + i) == firstNeedle) & (MUKDataByteVector)(MUKDataLoadVector(bytes + i + needleLength - 1) == lastNeedle);
+        uint64_t words[2] = { MUKDataLowMatchWord(mask), MUKDataHighMatchWord(mask) };
+        
+        for (NSUInteger w = 0; w < 2; w++) {
+            while (words[w]) {
+                NSUInteger const offset = (NSUInteger)__builtin_ctzll(words[w]) >> 3;
+                NSUInteger const candidate = i + 8 * w + offset;
+                
+                if (memcmp(bytes + candidate + 1, needle + 1, needleLength - 2) == 0) {
+                    return candidate;
+                }
+                
+                words[w] &= ~(0xFFull << (8 * offset));
+            } // while
+        } // for
+    } // for
+    
+    for (; i <= lastIndex; i++) {
+        if (bytes[i] == needle[0] && memcmp(bytes + i + 1, needle + 1, needleLength - 1) == 0)
+        {
+            return i;
+        }
+    } // for
+    
+    return NSNotFound;
+}
+
+static NSUInteger MUKDataCountOfByte(uint8_t const *bytes, NSUInteger length, uint8_t byte)
+{
+    MUKDataByteVector const needle = MUKDataSplatVector(byte);
+    NSUInteger count = 0, i = 0;
+    
+    while (i + MUK_DATA_VECTOR_LENGTH <= length) {
+        // Byte lanes count up to 255 matches before overflowing
+        MUKDataByteVector counters = MUKDataSplatVector(0);
+        for (NSUInteger n = 0; n < 255 && i + MUK_DATA_VECTOR_LENGTH <= length; n++, i += MUK_DATA_VECTOR_LENGTH)
+        {
+            counters -= (MUKDataByteVector)(MUKDataLoadVector(bytes + i) == needle);
+        } // for
+        
+        for (NSUInteger lane = 0; lane < MUK_DATA_VECTOR_LENGTH; lane++) {
+            count += counters[lane];
+        } // for
+    } // while
+    
+    for (; i < length; i++) {
+        count += (bytes[i] == byte);
+    } // for
+    
+    return count;
+}
+
+static void MUKDataByteHistogram(uint8_t const *bytes, NSUInteger length, NSUInteger histogram[256])
+{
+    // Four partial histograms, so consecutive equal bytes do not wait for
+    // each other's increment
+    uint32_t partials[4][256];
+    NSUInteger i = 0;
+    
+    while (i < length) {
+        // Partial counters must not overflow
+        NSUInteger const blockEnd = i + MIN(length - i, (NSUInteger)1 << 30);
+        memset(partials, 0, sizeof(partials));
+        
+        for (; i + 4 <= blockEnd; i += 4) {
+            partials[0][bytes[i]]++;
+            partials[1][bytes[i + 1]]++;
+            partials[2][bytes[i + 2]]++;
+            partials[3][bytes[i + 3]]++;
+        } // for
+        
+        for (; i < blockEnd; i++) {
+            partials[0][bytes[i]]++;
+        } // for
+        
+        for (NSUInteger b = 0; b < 256; b++) {
+            histogram[b] += (NSUInteger)partials[0][b] + partials[1][b] + partials[2][b] + partials[3][b];
+        } // for
+    } // while
+}
+
+NS_INLINE NSRange MUKDataClippedRange(NSRange range, NSUInteger length) {
+    if (range.location >= length) return NSMakeRange(length, 0);
+    return NSMakeRange(range.location, MIN(range.length, length - range.location));
+}
+
+typedef void (^MUKDataSpanBlock)(uint8_t const *bytes, NSRange range, BOOL *stop);
+
+static void MUKDataEnumerateSpans(NSData *data, NSRange range, MUKDataSpanBlock block)
+{
+    // Chunked data is never flattened
+    if ([data isKindOfClass:[MUKChunkedData class]]) {
+        [(MUKChunkedData *)data enumerateSpansInRange:range usingBlock:block];
+        return;
+    }
+    
+    range = MUKDataClippedRange(range, [data length]);
+    if (range.length == 0) return;
+    
+    if ([data respondsToSelector:@selector(enumerateByteRangesUsingBlock:)]) {
+        __block BOOL stop = NO;
+        
+        [data enumerateByteRangesUsingBlock:^(void const *bytes, NSRange byteRange, BOOL *stopRanges)
+        {
+            NSUInteger const start = MAX(byteRange.location, range.location);
+            NSUInteger const end = MIN(NSMaxRange(byteRange), NSMaxRange(range));
+            
+            if (start < end) {
+                block((uint8_t const *)bytes + (start - byteRange.location), NSMakeRange(start, end - start), &stop);
+            }
+            
+            *stopRanges = (stop || NSMaxRange(byteRange) >= NSMaxRange(range));
+        }];
+    }
+    else {
+        BOOL stop = NO;
+        block((uint8_t const *)[data bytes] + range.location, range, &stop);
+    }
+}
 
 @implementation MUK (Data)
 
 + (NSData *)data:(NSData *)data applyingTransform:(MUKDataTransform)transform
 {
+    MUK_INSTRUMENT([data length]);
     if (data == nil) return nil;
     
     NSData *transformedData = data;
     
     switch (transform) {
         case MUKDataTransformSHA1: {
+            __block CC_SHA1_CTX context;
+            CC_SHA1_Init(&context);
+            MUKDataEnumerateSpans(data, NSMakeRange(0, [data length]), ^(uint8_t const *bytes, NSRange range, BOOL *stop)
+            {
+                CC_SHA1_Update(&context, bytes, (CC_LONG)range.length);
+            });
+            
             unsigned char hashedChars[CC_SHA1_DIGEST_LENGTH];
-            CC_SHA1([data bytes], (CC_LONG)[data length], hashedChars);
+            CC_SHA1_Final(hashedChars, &context);
             transformedData = [NSData dataWithBytes:hashedChars length:CC_SHA1_DIGEST_LENGTH];
             break;
         }
             
         case MUKDataTransformMD5: {
+            __block CC_MD5_CTX context;
+            CC_MD5_Init(&context);
+            MUKDataEnumerateSpans(data, NSMakeRange(0, [data length]), ^(uint8_t const *bytes, NSRange range, BOOL *stop)
+            {
+                CC_MD5_Update(&context, bytes, (CC_LONG)range.length);
+            });
+            
             unsigned char hashedChars[CC_MD5_DIGEST_LENGTH];
-            CC_MD5([data bytes], (CC_LONG)[data length], hashedChars);
+            CC_MD5_Final(hashedChars, &context);
             transformedData = [NSData dataWithBytes:hashedChars length:CC_MD5_DIGEST_LENGTH];
             break;
         }
             
+        case MUKDataTransformDeflate:
+            transformedData = [MUKDataCompressionStream compressData:data format:MUKDataCompressionFormatZlib level:MUKDataCompressionLevelDefault];
+            break;
+            
+        case MUKDataTransformGzip:
+            transformedData = [MUKDataCompressionStream compressData:data format:MUKDataCompressionFormatGzip level:MUKDataCompressionLevelDefault];
+            break;
+            
+        case MUKDataTransformInflate:
+        case MUKDataTransformGunzip:
+            transformedData = [MUKDataCompressionStream decompressData:data format:MUKDataCompressionFormatGzip];
+            break;
+            
+        case MUKDataTransformLZ4Compress:
+            transformedData = [MUKDataCompressionStream compressData:data format:MUKDataCompressionFormatLZ4 level:MUKDataCompressionLevelDefault];
+            break;
+            
+        case MUKDataTransformLZ4Decompress:
+            transformedData = [MUKDataCompressionStream decompressData:data format:MUKDataCompressionFormatLZ4];
+            break;
+            
         default:
             break;
     }
@@ -58,15 +313,181 @@
 
 + (void)data:(NSData *)data enumerateBytesUsingBlock:(void (^)(unsigned char const, NSInteger, BOOL *))block
 {
+    MUK_INSTRUMENT([data length]);
     if (!data || !block) return;
-    unsigned char const *bytes = [data bytes];
     
-    for (NSInteger i=0; i<[data length]; i++) {
-        BOOL stop = NO;
-        block(bytes[i], i, &stop);
+    MUKDataEnumerateSpans(data, NSMakeRange(0, [data length]), ^(uint8_t const *bytes, NSRange range, BOOL *stop)
+    {
+        for (NSUInteger i=0; i<range.length && !*stop; i++) {
+            block(bytes[i], range.location + i, stop);
+        } // for
+    });
+}
+
++ (void)data:(NSData *)data enumerateSpansOfMaximumLength:(NSUInteger)maximumLength usingBlock:(void (^)(unsigned char const *, NSRange, BOOL *))block
+{
+    MUK_INSTRUMENT([data length]);
+    if (!data || !block) return;
+    if (maximumLength == 0) maximumLength = NSUIntegerMax;
+    
+    MUKDataEnumerateSpans(data, NSMakeRange(0, [data length]), ^(uint8_t const *bytes, NSRange range, BOOL *stop)
+    {
+        for (NSUInteger offset = 0; offset < range.length && !*stop; offset += maximumLength)
+        {
+            NSUInteger const spanLength = MIN(maximumLength, range.length - offset);
+            block(bytes + offset, NSMakeRange(range.location + offset, spanLength), stop);
+        } // for
+    });
+}
+
++ (NSUInteger)data:(NSData *)data indexOfByte:(unsigned char)byte inRange:(NSRange)range
+{
+    MUK_INSTRUMENT([data length]);
+    
+    __block NSUInteger index = NSNotFound;
+    MUKDataEnumerateSpans(data, range, ^(uint8_t const *bytes, NSRange spanRange, BOOL *stop)
+    {
+        NSUInteger const spanIndex = MUKDataIndexOfByte(bytes, spanRange.length, byte);
         
-        if (stop) break;
-    } // for
+        if (spanIndex != NSNotFound) {
+            index = spanRange.location + spanIndex;
+            *stop = YES;
+        }
+    });
+    
+    return index;
+}
+
++ (NSUInteger)data:(NSData *)data indexOfByteInSet:(NSIndexSet *)byteSet inRange:(NSRange)range
+{
+    MUK_INSTRUMENT([data length]);
+    
+    BOOL table[256];
+    uint8_t members[256];
+    NSUInteger membersCount = 0;
+    
+    memset(table, NO, sizeof(table));
+    NSUInteger member = [byteSet firstIndex];
+    while (member != NSNotFound && member < 256) {
+        table[member] = YES;
+        members[membersCount++] = (uint8_t)member;
+        member = [byteSet indexGreaterThanIndex:member];
+    } // while
+    
+    // Blocks cannot capture arrays
+    uint8_t const *membersBytes = members;
+    BOOL const *tableEntries = table;
+    
+    __block NSUInteger index = NSNotFound;
+    MUKDataEnumerateSpans(data, range, ^(uint8_t const *bytes, NSRange spanRange, BOOL *stop)
+    {
+        NSUInteger const spanIndex = MUKDataIndexOfByteInSet(bytes, spanRange.length, membersBytes, membersCount, tableEntries);
+        
+        if (spanIndex != NSNotFound) {
+            index = spanRange.location + spanIndex;
+            *stop = YES;
+        }
+    });
+    
+    return index;
+}
+
++ (NSRange)data:(NSData *)data rangeOfBytes:(NSData *)bytes inRange:(NSRange)range
+{
+    MUK_INSTRUMENT([data length]);
+    range = MUKDataClippedRange(range, [data length]);
+    
+    uint8_t const *needle = [bytes bytes];
+    NSUInteger const needleLength = [bytes length];
+    if (needleLength == 0 || needleLength > range.length) return NSMakeRange(NSNotFound, 0);
+    
+    // Matches which straddle a span boundary are looked for into a window
+    // around that boundary
+    NSUInteger const windowCapacity = 2 * needleLength - 2;
+    uint8_t windowStorage[256];
+    uint8_t *window = (windowCapacity <= sizeof(windowStorage) ? windowStorage : malloc(windowCapacity));
+    NSUInteger const rangeEnd = NSMaxRange(range);
+    
+    __block NSUInteger index = NSNotFound;
+    MUKDataEnumerateSpans(data, range, ^(uint8_t const *spanBytes, NSRange spanRange, BOOL *stop)
+    {
+        NSUInteger const boundary = spanRange.location;
+        
+        if (boundary > range.location && needleLength > 1) {
+            NSUInteger const windowStart = boundary - MIN(boundary - range.location, needleLength - 1);
+            NSUInteger const windowEnd = MIN(rangeEnd, boundary + (needleLength - 1));
+            [data getBytes:window range:NSMakeRange(windowStart, windowEnd - windowStart)];
+            
+            NSUInteger const windowIndex = MUKDataIndexOfBytes(window, windowEnd - windowStart, needle, needleLength);
+            
+            if (windowIndex != NSNotFound && windowStart + windowIndex < boundary) {
+                index = windowStart + windowIndex;
+                *stop = YES;
+                return;
+            }
+        }
+        
+        NSUInteger const spanIndex = MUKDataIndexOfBytes(spanBytes, spanRange.length, needle, needleLength);
+        
+        if (spanIndex != NSNotFound) {
+            index = spanRange.location + spanIndex;
+            *stop = YES;
+        }
+    });
+    
+    if (window != windowStorage) free(window);
+    return (index == NSNotFound ? NSMakeRange(NSNotFound, 0) : NSMakeRange(index, needleLength));
+}
+
++ (NSUInteger)data:(NSData *)data countOfByte:(unsigned char)byte {
+    MUK_INSTRUMENT([data length]);
+    
+    __block NSUInteger count = 0;
+    MUKDataEnumerateSpans(data, NSMakeRange(0, [data length]), ^(uint8_t const *bytes, NSRange range, BOOL *stop)
+    {
+        count += MUKDataCountOfByte(bytes, range.length, byte);
+    });
+    
+    return count;
+}
+
++ (void)data:(NSData *)data getByteHistogram:(NSUInteger *)histogram {
+    MUK_INSTRUMENT([data length]);
+    if (histogram == NULL) return;
+    
+    memset(histogram, 0, 256 * sizeof(NSUInteger));
+    MUKDataEnumerateSpans(data, NSMakeRange(0, [data length]), ^(uint8_t const *bytes, NSRange range, BOOL *stop)
+    {
+        MUKDataByteHistogram(bytes, range.length, histogram);
+    });
+}
+
++ (NSArray *)data:(NSData *)data rangesSeparatedByByte:(unsigned char)delimiter
+{
+    MUK_INSTRUMENT([data length]);
+    if (data == nil) return nil;
+    
+    NSMutableArray *ranges = [NSMutableArray array];
+    __block NSUInteger location = 0;
+    
+    // Components could span many segments: only delimiters matter
+    MUKDataEnumerateSpans(data, NSMakeRange(0, [data length]), ^(uint8_t const *bytes, NSRange range, BOOL *stop)
+    {
+        NSUInteger offset = 0;
+        
+        while (offset < range.length) {
+            NSUInteger const index = MUKDataIndexOfByte(bytes + offset, range.length - offset, delimiter);
+            if (index == NSNotFound) break;
+            
+            NSUInteger const delimiterLocation = range.location + offset + index;
+            [ranges addObject:[NSValue valueWithRange:NSMakeRange(location, delimiterLocation - location)]];
+            location = delimiterLocation + 1;
+            offset += index + 1;
+        } // while
+    });
+    
+    [ranges addObject:[NSValue valueWithRange:NSMakeRange(location, [data length] - location)]];
+    return ranges;
 }
 
 @end
@@ -0,0 +1,111 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import <Foundation/Foundation.h>
+
+/**
+ Data made of a list of immutable `NSData` segments, which are never copied
+ into a contiguous buffer unless you ask for it.
+ 
+ You build chunked data with MUKMutableChunkedData, appending data in 
+ amortized constant time, and you slice it with subdataWithRange:, which
+ shares segments instead of copying bytes.
+    
+    MUKMutableChunkedData *payload = [[MUKMutableChunkedData alloc] init];
+    [payload appendData:headerData];
+    [payload appendData:bodyData];
+    
+    NSData *digest = [MUK data:payload applyingTransform:MUKDataTransformSHA1];
+ 
+ `MUKChunkedData` is a `NSData` subclass, so you can pass it wherever 
+ `NSData` is expected. MUK(Data) methods and MUKDataCompressionStream walk
+ its segments with enumerateByteRangesUsingBlock:, without flattening it.
+ Other APIs which call `-bytes` get a contiguous copy, which is created 
+ once and cached: call flattenedData when you want to pay that copy 
+ explicitly.
+ 
+ Immutable instances are thread-safe.
+ */
+@interface MUKChunkedData : NSData
+/**
+ Number of segments.
+ */
+@property (nonatomic, readonly) NSUInteger segmentsCount;
+
+/**
+ Creates chunked data from segments.
+ @param segments An array of `NSData` objects. Immutable segments are
+ retained, mutable ones are copied.
+ @return New chunked data.
+ */
+- (id)initWithSegments:(NSArray *)segments;
+
+/**
+ Returns a slice of chunked data.
+ 
+ Returned object shares segments with receiver, so no byte is copied.
+ 
+ @param range Range of bytes. It raises `NSRangeException` if `range` exceeds
+ data length.
+ @return A `MUKChunkedData` instance.
+ */
+- (NSData *)subdataWithRange:(NSRange)range;
+/**
+ Enumerates contiguous spans of a range of bytes.
+ @param range Range of bytes to enumerate. It is clipped to data length.
+ @param block Block called for each span. It includes a pointer to the first
+ `bytes` of the span, its `range` into receiver and `*stop` pointer, which 
+ could be set to `YES` in order to stop enumeration.
+ */
+- (void)enumerateSpansInRange:(NSRange)range usingBlock:(void (^)(unsigned char const *bytes, NSRange range, BOOL *stop))block;
+/**
+ Copies every segment into a contiguous buffer.
+ @return Contiguous data with the same bytes. If receiver has a single 
+ segment, that segment is returned with no copy.
+ */
+- (NSData *)flattenedData;
+@end
+
+/**
+ Chunked data which you can append data to.
+ 
+ Copying mutable chunked data gives an immutable snapshot. Pointers returned
+ by `-bytes` are invalidated by the next append.
+ 
+ @warning This class is not thread-safe.
+ */
+@interface MUKMutableChunkedData : MUKChunkedData
+/**
+ Appends data.
+ 
+ Bytes are never copied: immutable data (including immutable 
+ `MUKChunkedData`) is appended as a single segment in amortized constant
+ time, mutable data is copied (mutable chunked data is snapshotted, which
+ copies its list of segments only).
+ 
+ @param data Data to append.
+ */
+- (void)appendData:(NSData *)data;
+@end
@@ -0,0 +1,369 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUKChunkedData.h"
+
+// Chunked data appended as a segment nests into the receiver; deeper trees
+// are spliced leaf by leaf, so enumeration never recurses too much
+#define MUK_CHUNKED_DATA_MAXIMUM_DEPTH  32
+
+// CFData hashes its first 80 bytes
+#define MUK_CHUNKED_DATA_HASHED_LENGTH  80
+
+#define MUK_CHUNKED_DATA_COMPARISON_BUFFER_LENGTH   4096
+
+typedef void (^MUKChunkedDataSpanBlock)(unsigned char const *bytes, NSRange range, BOOL *stop);
+
+@interface MUKChunkedData ()
+- (NSUInteger)nestingDepth_;
+- (void)appendData_:(NSData *)data;
+- (void)appendSegment_:(NSData *)segment range:(NSRange)range;
+- (void)appendLeafSegmentsOfData_:(MUKChunkedData *)data;
+- (void)enumerateSpansInRange_:(NSRange)range outerLocation:(NSUInteger)outerLocation stop:(BOOL *)stop usingBlock:(MUKChunkedDataSpanBlock)block;
+@end
+
+@implementation MUKChunkedData {
+    NSMutableArray *segments_;
+    NSUInteger *segmentOffsets_;    // First used byte of each segment
+    NSUInteger *segmentEnds_;       // End of each segment into receiver
+    NSUInteger segmentsCapacity_;
+    NSUInteger length_;
+    NSUInteger depth_;              // Levels of nested chunked data
+    NSData *flattenedData_;         // Cached by -bytes
+}
+
+- (id)init {
+    return [self initWithSegments:nil];
+}
+
+- (id)initWithSegments:(NSArray *)segments {
+    self = [super init];
+    if (self) {
+        segments_ = [[NSMutableArray alloc] initWithCapacity:[segments count]];
+        
+        for (NSData *segment in segments) {
+            [self appendData_:segment];
+        } // for
+    }
+    
+    return self;
+}
+
+- (void)dealloc {
+    free(segmentOffsets_);
+    free(segmentEnds_);
+}
+
+- (NSUInteger)segmentsCount {
+    return [segments_ count];
+}
+
+- (NSUInteger)length {
+    return length_;
+}
+
+- (void const *)bytes {
+    @synchronized(self) {
+        if (flattenedData_ == nil) {
+            flattenedData_ = [self flattenedData];
+        }
+        
+        return [flattenedData_ bytes];
+    }
+}
+
+- (void)getBytes:(void *)buffer range:(NSRange)range {
+    if (range.location > length_ || range.length > length_ - range.location) {
+        [NSException raise:NSRangeException format:@"Range %@ exceeds data length %lu", NSStringFromRange(range), (unsigned long)length_];
+    }
+    
+    __block unsigned char *output = buffer;
+    [self enumerateSpansInRange:range usingBlock:^(unsigned char const *bytes, NSRange spanRange, BOOL *stop)
+    {
+        memcpy(output, bytes, spanRange.length);
+        output += spanRange.length;
+    }];
+}
+
+- (void)getBytes:(void *)buffer length:(NSUInteger)length {
+    [self getBytes:buffer range:NSMakeRange(0, MIN(length, length_))];
+}
+
+- (void)getBytes:(void *)buffer {
+    [self getBytes:buffer range:NSMakeRange(0, length_)];
+}
+
+- (void)enumerateByteRangesUsingBlock:(void (^)(void const *, NSRange, BOOL *))block
+{
+    if (!block) return;
+    
+    [self enumerateSpansInRange:NSMakeRange(0, length_) usingBlock:^(unsigned char const *bytes, NSRange range, BOOL *stop)
+    {
+        block(bytes, range, stop);
+    }];
+}
+
+- (NSData *)subdataWithRange:(NSRange)range {
+    if (range.location > length_ || range.length > length_ - range.location) {
+        [NSException raise:NSRangeException format:@"Range %@ exceeds data length %lu", NSStringFromRange(range), (unsigned long)length_];
+    }
+    
+    MUKChunkedData *slice = [[MUKChunkedData alloc] initWithSegments:nil];
+    NSUInteger const end = NSMaxRange(range);
+    NSUInteger const count = [segments_ count];
+    
+    for (NSUInteger index = [self segmentIndexForLocation_:range.location]; index < count; index++)
+    {
+        NSUInteger const segmentStart = (index > 0 ? segmentEnds_[index - 1] : 0);
+        if (segmentStart >= end) break;
+        
+        NSUInteger const start = MAX(segmentStart, range.location);
+        NSUInteger const stop = MIN(segmentEnds_[index], end);
+        [slice appendSegment_:[segments_ objectAtIndex:index] range:NSMakeRange(segmentOffsets_[index] + (start - segmentStart), stop - start)];
+    } // for
+    
+    return slice;
+}
+
+- (void)enumerateSpansInRange:(NSRange)range usingBlock:(void (^)(unsigned char const *, NSRange, BOOL *))block
+{
+    if (!block) return;
+    
+    if (range.location >= length_) return;
+    range.length = MIN(range.length, length_ - range.location);
+    if (range.length == 0) return;
+    
+    BOOL stop = NO;
+    [self enumerateSpansInRange_:range outerLocation:range.location stop:&stop usingBlock:block];
+}
+
+- (NSData *)flattenedData {
+    if ([segments_ count] == 1 && segmentOffsets_[0] == 0 && [[segments_ objectAtIndex:0] length] == length_)
+    {
+        NSData *segment = [segments_ objectAtIndex:0];
+        
+        if ([segment isKindOfClass:[MUKChunkedData class]]) {
+            return [(MUKChunkedData *)segment flattenedData];
+        }
+        
+        return segment;
+    }
+    
+    NSMutableData *data = [NSMutableData dataWithLength:length_];
+    [self getBytes:[data mutableBytes] range:NSMakeRange(0, length_)];
+    return data;
+}
+
+#pragma mark - Overrides
+
+- (id)copyWithZone:(NSZone *)zone {
+    // Immutable
+    return self;
+}
+
+- (BOOL)isEqual:(id)object {
+    if (object == self) return YES;
+    if (![object isKindOfClass:[NSData class]]) return NO;
+    
+    return [self isEqualToData:object];
+}
+
+- (BOOL)isEqualToData:(NSData *)other {
+    if (other == self) return YES;
+    if ([other length] != length_) return NO;
+    
+    __block BOOL equal = YES;
+    
+    if ([other isKindOfClass:[MUKChunkedData class]]) {
+        // Do not flatten other chunked data
+        [self enumerateSpansInRange:NSMakeRange(0, length_) usingBlock:^(unsigned char const *bytes, NSRange range, BOOL *stop)
+        {
+            unsigned char buffer[MUK_CHUNKED_DATA_COMPARISON_BUFFER_LENGTH];
+            
+            for (NSUInteger offset = 0; offset < range.length && equal; offset += sizeof(buffer))
+            {
+                NSUInteger const length = MIN(sizeof(buffer), range.length - offset);
+                [other getBytes:buffer range:NSMakeRange(range.location + offset, length)];
+                equal = (memcmp(bytes + offset, buffer, length) == 0);
+            } // for
+            
+            *stop = !equal;
+        }];
+    }
+    else {
+        unsigned char const *otherBytes = [other bytes];
+        [self enumerateSpansInRange:NSMakeRange(0, length_) usingBlock:^(unsigned char const *bytes, NSRange range, BOOL *stop)
+        {
+            equal = (memcmp(bytes, otherBytes + range.location, range.length) == 0);
+            *stop = !equal;
+        }];
+    }
+    
+    return equal;
+}
+
+- (NSUInteger)hash {
+    // Equal data must have the same hash, whatever its class
+    unsigned char prefix[MUK_CHUNKED_DATA_HASHED_LENGTH];
+    NSUInteger const length = MIN(length_, sizeof(prefix));
+    [self getBytes:prefix range:NSMakeRange(0, length)];
+    
+    return [[NSData dataWithBytesNoCopy:prefix length:length freeWhenDone:NO] hash];
+}
+
+#pragma mark - Private
+
+- (NSUInteger)nestingDepth_ {
+    return depth_;
+}
+
+- (NSUInteger)segmentIndexForLocation_:(NSUInteger)location {
+    // First segment which ends after location
+    NSUInteger low = 0, high = [segments_ count];
+    
+    while (low < high) {
+        NSUInteger const middle = low + (high - low)/2;
+        
+        if (segmentEnds_[middle] > location) {
+            high = middle;
+        }
+        else {
+            low = middle + 1;
+        }
+    } // while
+    
+    return low;
+}
+
+- (void)appendData_:(NSData *)data {
+    if ([data length] == 0) return;
+    
+    // Immutable data returns itself, mutable data gives a snapshot
+    NSData *segment = [data copy];
+    
+    if ([segment isKindOfClass:[MUKChunkedData class]] && [(MUKChunkedData *)segment nestingDepth_] >= MUK_CHUNKED_DATA_MAXIMUM_DEPTH)
+    {
+        [self appendLeafSegmentsOfData_:(MUKChunkedData *)segment];
+    }
+    else {
+        [self appendSegment_:segment range:NSMakeRange(0, [segment length])];
+    }
+}
+
+- (void)appendSegment_:(NSData *)segment range:(NSRange)range {
+    if (range.length == 0) return;
+    
+    NSUInteger const index = [segments_ count];
+    
+    if (index == segmentsCapacity_) {
+        segmentsCapacity_ = MAX((NSUInteger)8, segmentsCapacity_ * 2);
+        segmentOffsets_ = realloc(segmentOffsets_, segmentsCapacity_ * sizeof(NSUInteger));
+        segmentEnds_ = realloc(segmentEnds_, segmentsCapacity_ * sizeof(NSUInteger));
+    }
+    
+    [segments_ addObject:segment];
+    segmentOffsets_[index] = range.location;
+    length_ += range.length;
+    segmentEnds_[index] = length_;
+    
+    NSUInteger const segmentDepth = ([segment isKindOfClass:[MUKChunkedData class]] ? [(MUKChunkedData *)segment nestingDepth_] + 1 : 1);
+    depth_ = MAX(depth_, segmentDepth);
+    
+    flattenedData_ = nil;
+}
+
+- (void)appendLeafSegmentsOfData_:(MUKChunkedData *)data {
+    NSUInteger const count = [data->segments_ count];
+    
+    for (NSUInteger index = 0; index < count; index++) {
+        NSData *segment = [data->segments_ objectAtIndex:index];
+        NSUInteger const segmentStart = (index > 0 ? data->segmentEnds_[index - 1] : 0);
+        NSRange const range = NSMakeRange(data->segmentOffsets_[index], data->segmentEnds_[index] - segmentStart);
+        
+        if ([segment isKindOfClass:[MUKChunkedData class]]) {
+            [self appendLeafSegmentsOfData_:(MUKChunkedData *)[segment subdataWithRange:range]];
+        }
+        else {
+            [self appendSegment_:segment range:range];
+        }
+    } // for
+}
+
+- (void)enumerateSpansInRange_:(NSRange)range outerLocation:(NSUInteger)outerLocation stop:(BOOL *)stop usingBlock:(MUKChunkedDataSpanBlock)block
+{
+    NSUInteger const end = NSMaxRange(range);
+    NSUInteger const count = [segments_ count];
+    
+    for (NSUInteger index = [self segmentIndexForLocation_:range.location]; index < count && !*stop; index++)
+    {
+        NSUInteger const segmentStart = (index > 0 ? segmentEnds_[index - 1] : 0);
+        if (segmentStart >= end) break;
+        
+        NSUInteger const start = MAX(segmentStart, range.location);
+        NSUInteger const segmentRangeLocation = segmentOffsets_[index] + (start - segmentStart);
+        NSRange const segmentRange = NSMakeRange(segmentRangeLocation, MIN(segmentEnds_[index], end) - start);
+        NSUInteger const spanLocation = outerLocation + (start - range.location);
+        NSData *segment = [segments_ objectAtIndex:index];
+        
+        if ([segment isKindOfClass:[MUKChunkedData class]]) {
+            [(MUKChunkedData *)segment enumerateSpansInRange_:segmentRange outerLocation:spanLocation stop:stop usingBlock:block];
+        }
+        else if ([segment respondsToSelector:@selector(enumerateByteRangesUsingBlock:)])
+        {
+            // Segment could be discontiguous itself (e.g. dispatch data)
+            [segment enumerateByteRangesUsingBlock:^(void const *bytes, NSRange byteRange, BOOL *stopRanges)
+            {
+                NSUInteger const regionStart = MAX(byteRange.location, segmentRange.location);
+                NSUInteger const regionEnd = MIN(NSMaxRange(byteRange), NSMaxRange(segmentRange));
+                
+                if (regionStart < regionEnd) {
+                    unsigned char const *regionBytes = (unsigned char const *)bytes + (regionStart - byteRange.location);
+                    block(regionBytes, NSMakeRange(spanLocation + (regionStart - segmentRange.location), regionEnd - regionStart), stop);
+                }
+                
+                *stopRanges = (*stop || NSMaxRange(byteRange) >= NSMaxRange(segmentRange));
+            }];
+        }
+        else {
+            block((unsigned char const *)[segment bytes] + segmentRange.location, NSMakeRange(spanLocation, segmentRange.length), stop);
+        }
+    } // for
+}
+
+@end
+
+@implementation MUKMutableChunkedData
+
+- (void)appendData:(NSData *)data {
+    [self appendData_:data];
+}
+
+#pragma mark - Overrides
+
+- (id)copyWithZone:(NSZone *)zone {
+    return [self subdataWithRange:NSMakeRange(0, [self length])];
+}
+
+@end
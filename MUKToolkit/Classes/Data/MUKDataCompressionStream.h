@@ -0,0 +1,137 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import <Foundation/Foundation.h>
+
+typedef enum : NSUInteger {
+    MUKDataCompressionFormatZlib = 0,
+    MUKDataCompressionFormatGzip,
+    MUKDataCompressionFormatLZ4
+} MUKDataCompressionFormat;
+
+typedef enum : NSInteger {
+    MUKDataCompressionLevelDefault  = -1,
+    MUKDataCompressionLevelFastest  =  1,
+    MUKDataCompressionLevelBest     =  9
+} MUKDataCompressionLevel;
+
+/**
+ A compressor or a decompressor which processes data chunk by chunk, so you
+ can handle inputs larger than memory.
+ 
+    MUKDataCompressionStream *stream = [[MUKDataCompressionStream alloc] 
+        initForCompressionWithFormat:MUKDataCompressionFormatGzip
+        level:MUKDataCompressionLevelDefault];
+ 
+    while ((chunk = ReadNextChunk())) {
+        WriteChunk([stream processData:chunk]);
+    }
+    
+    WriteChunk([stream finish]);
+ 
+ Output uses standard formats, which other tools can read:
+ 
+ * `MUKDataCompressionFormatZlib` is deflate with zlib wrapper (RFC 1950),
+ which is what HTTP calls `deflate`;
+ * `MUKDataCompressionFormatGzip` is deflate with gzip wrapper (RFC 1952),
+ readable by `gzip` command;
+ * `MUKDataCompressionFormatLZ4` is LZ4 frame format, readable by `lz4`
+ command. It is way faster than deflate, with a lower compression ratio.
+ Frames have 64 KB independent blocks and a content checksum.
+ 
+ Decompressors of `MUKDataCompressionFormatZlib` and 
+ `MUKDataCompressionFormatGzip` accept both formats (and concatenated gzip
+ members). LZ4 decompressor accepts every block size, linked blocks, block 
+ checksums, skippable frames and concatenated frames.
+ 
+ ## Constants
+ 
+ `MUKDataCompressionLevel` enumerates notable compression levels, from
+ `MUKDataCompressionLevelFastest` (`1`) to `MUKDataCompressionLevelBest`
+ (`9`). `MUKDataCompressionLevelDefault` is a balanced choice. LZ4 levels 
+ under `5` skip input faster while looking for matches.
+ */
+@interface MUKDataCompressionStream : NSObject
+/**
+ Format of compressed data.
+ */
+@property (nonatomic, readonly) MUKDataCompressionFormat format;
+/**
+ `YES` if stream compresses data, `NO` if it decompresses data.
+ */
+@property (nonatomic, readonly, getter = isCompressing) BOOL compressing;
+/**
+ Compression level.
+ */
+@property (nonatomic, readonly) NSInteger level;
+
+/**
+ Creates a compressor.
+ @param format Format of compressed data.
+ @param level Compression level, from `1` to `9`, or 
+ `MUKDataCompressionLevelDefault`.
+ @return A new compressor.
+ */
+- (id)initForCompressionWithFormat:(MUKDataCompressionFormat)format level:(NSInteger)level;
+/**
+ Creates a decompressor.
+ @param format Format of compressed data.
+ @return A new decompressor.
+ */
+- (id)initForDecompressionWithFormat:(MUKDataCompressionFormat)format;
+
+/**
+ Processes a chunk of data.
+ @param data Chunk to compress or to decompress.
+ @return Output available so far, which could be empty. It returns `nil` if
+ data is corrupted or if stream has been finished or has failed before.
+ */
+- (NSData *)processData:(NSData *)data;
+/**
+ Finishes stream.
+ 
+ After this call, stream can not process data anymore.
+ 
+ @return Remaining output. It returns `nil` if stream has failed or if
+ compressed data is truncated.
+ */
+- (NSData *)finish;
+
+/**
+ Compresses data at once.
+ @param data Data to compress.
+ @param format Format of compressed data.
+ @param level Compression level.
+ @return Compressed data.
+ */
++ (NSData *)compressData:(NSData *)data format:(MUKDataCompressionFormat)format level:(NSInteger)level;
+/**
+ Decompresses data at once.
+ @param data Compressed data.
+ @param format Format of compressed data.
+ @return Decompressed data or `nil` if data is corrupted or truncated.
+ */
++ (NSData *)decompressData:(NSData *)data format:(MUKDataCompressionFormat)format;
+@end
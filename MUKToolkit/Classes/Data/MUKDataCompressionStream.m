@@ -0,0 +1,879 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUKDataCompressionStream.h"
+#include <zlib.h>
+
+#define MUK_DATA_COMPRESSION_BUFFER_LENGTH  16384
+
+#pragma mark - xxHash32
+
+#define MUK_XXH32_PRIME1    2654435761U
+#define MUK_XXH32_PRIME2    2246822519U
+#define MUK_XXH32_PRIME3    3266489917U
+#define MUK_XXH32_PRIME4    668265263U
+#define MUK_XXH32_PRIME5    374761393U
+
+typedef struct {
+    uint64_t totalLength;
+    uint32_t accumulators[4];
+    uint8_t buffer[16];
+    size_t bufferLength;
+} MUKXXH32State;
+
+NS_INLINE uint32_t MUKRotateLeft32(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+NS_INLINE uint32_t MUKReadLE32(uint8_t const *bytes) {
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+NS_INLINE void MUKWriteLE32(uint8_t *bytes, uint32_t value) {
+    bytes[0] = (uint8_t)value;
+    bytes[1] = (uint8_t)(value >> 8);
+    bytes[2] = (uint8_t)(value >> 16);
+    bytes[3] = (uint8_t)(value >> 24);
+}
+
+NS_INLINE uint32_t MUKXXH32Round(uint32_t accumulator, uint32_t input) {
+    return MUKRotateLeft32(accumulator + input * MUK_XXH32_PRIME2, 13) * MUK_XXH32_PRIME1;
+}
+
+static void MUKXXH32Reset(MUKXXH32State *state) {
+    memset(state, 0, sizeof(*state));
+    state->accumulators[0] = MUK_XXH32_PRIME1 + MUK_XXH32_PRIME2;
+    state->accumulators[1] = MUK_XXH32_PRIME2;
+    state->accumulators[2] = 0;
+    state->accumulators[3] = 0 - MUK_XXH32_PRIME1;
+}
+
+static void MUKXXH32Update(MUKXXH32State *state, uint8_t const *bytes, size_t length)
+{
+    state->totalLength += length;
+    
+    if (state->bufferLength + length < 16) {
+        memcpy(state->buffer + state->bufferLength, bytes, length);
+        state->bufferLength += length;
+        return;
+    }
+    
+    if (state->bufferLength > 0) {
+        size_t const fillLength = 16 - state->bufferLength;
+        memcpy(state->buffer + state->bufferLength, bytes, fillLength);
+        bytes += fillLength;
+        length -= fillLength;
+        
+        for (int lane = 0; lane < 4; lane++) {
+            state->accumulators[lane] = MUKXXH32Round(state->accumulators[lane], MUKReadLE32(state->buffer + 4 * lane));
+        } // for
+        
+        state->bufferLength = 0;
+    }
+    
+    uint32_t accumulators[4] = { state->accumulators[0], state->accumulators[1], state->accumulators[2], state->accumulators[3] };
+    for (; length >= 16; bytes += 16, length -= 16) {
+        accumulators[0] = MUKXXH32Round(accumulators[0], MUKReadLE32(bytes));
+        accumulators[1] = MUKXXH32Round(accumulators[1], MUKReadLE32(bytes + 4));
+        accumulators[2] = MUKXXH32Round(accumulators[2], MUKReadLE32(bytes + 8));
+        accumulators[3] = MUKXXH32Round(accumulators[3], MUKReadLE32(bytes + 12));
+    } // for
+    
+    memcpy(state->accumulators, accumulators, sizeof(accumulators));
+    memcpy(state->buffer, bytes, length);
+    state->bufferLength = length;
+}
+
+static uint32_t MUKXXH32Digest(MUKXXH32State const *state) {
+    uint32_t hash;
+    
+    if (state->totalLength >= 16) {
+        hash = MUKRotateLeft32(state->accumulators[0], 1) + MUKRotateLeft32(state->accumulators[1], 7) + MUKRotateLeft32(state->accumulators[2], 12) + MUKRotateLeft32(state->accumulators[3], 18);
+    }
+    else {
+        hash = state->accumulators[2] + MUK_XXH32_PRIME5;
+    }
+    
+    hash += (uint32_t)state->totalLength;
+    
+    size_t i = 0;
+    for (; i + 4 <= state->bufferLength; i += 4) {
+        hash += MUKReadLE32(state->buffer + i) * MUK_XXH32_PRIME3;
+        hash = MUKRotateLeft32(hash, 17) * MUK_XXH32_PRIME4;
+    } // for
+    
+    for (; i < state->bufferLength; i++) {
+        hash += state->buffer[i] * MUK_XXH32_PRIME5;
+        hash = MUKRotateLeft32(hash, 11) * MUK_XXH32_PRIME1;
+    } // for
+    
+    hash ^= hash >> 15;
+    hash *= MUK_XXH32_PRIME2;
+    hash ^= hash >> 13;
+    hash *= MUK_XXH32_PRIME3;
+    hash ^= hash >> 16;
+    
+    return hash;
+}
+
+static uint32_t MUKXXH32(uint8_t const *bytes, size_t length) {
+    MUKXXH32State state;
+    MUKXXH32Reset(&state);
+    MUKXXH32Update(&state, bytes, length);
+    return MUKXXH32Digest(&state);
+}
+
+#pragma mark - LZ4 Block
+
+#define MUK_LZ4_MIN_MATCH           4
+#define MUK_LZ4_LAST_LITERALS       5
+#define MUK_LZ4_MATCH_FIND_LIMIT    12
+#define MUK_LZ4_MAX_OFFSET          65535
+#define MUK_LZ4_HASH_LOG            12
+
+NS_INLINE uint32_t MUKLZ4Hash(uint8_t const *bytes) {
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return (value * MUK_XXH32_PRIME1) >> (32 - MUK_LZ4_HASH_LOG);
+}
+
+NS_INLINE size_t MUKLZ4CompressBound(size_t length) {
+    return length + length / 255 + 16;
+}
+
+NS_INLINE uint8_t *MUKLZ4WriteLength(uint8_t *output, size_t length) {
+    for (; length >= 255; length -= 255) {
+        *output++ = 255;
+    } // for
+    
+    *output++ = (uint8_t)length;
+    return output;
+}
+
+NS_INLINE uint8_t *MUKLZ4WriteSequence(uint8_t *output, uint8_t const *literals, size_t literalsLength, size_t offset, size_t matchLength)
+{
+    uint8_t *token = output++;
+    
+    if (literalsLength >= 15) {
+        *token = 15 << 4;
+        output = MUKLZ4WriteLength(output, literalsLength - 15);
+    }
+    else {
+        *token = (uint8_t)(literalsLength << 4);
+    }
+    
+    memcpy(output, literals, literalsLength);
+    output += literalsLength;
+    
+    // Last sequence has literals only
+    if (matchLength == 0) return output;
+    
+    *output++ = (uint8_t)offset;
+    *output++ = (uint8_t)(offset >> 8);
+    
+    matchLength -= MUK_LZ4_MIN_MATCH;
+    if (matchLength >= 15) {
+        *token |= 15;
+        output = MUKLZ4WriteLength(output, matchLength - 15);
+    }
+    else {
+        *token |= (uint8_t)matchLength;
+    }
+    
+    return output;
+}
+
+// Greedy LZ4 block compression: output must hold MUKLZ4CompressBound()
+// bytes. Acceleration skips more bytes when matches are not found.
+static size_t MUKLZ4CompressBlock(uint8_t const *input, size_t length, uint8_t *output, uint32_t *hashTable, uint32_t acceleration)
+{
+    uint8_t *const outputStart = output;
+    size_t anchor = 0;
+    
+    if (length > MUK_LZ4_MATCH_FIND_LIMIT) {
+        size_t const lastMatchStart = length - MUK_LZ4_MATCH_FIND_LIMIT;
+        size_t const lastMatchEnd = length - MUK_LZ4_LAST_LITERALS;
+        size_t position = 1;
+        
+        memset(hashTable, 0, sizeof(uint32_t) << MUK_LZ4_HASH_LOG);
+        
+        while (position <= lastMatchStart) {
+            // Find a match
+            size_t reference = 0;
+            uint32_t misses = 0;
+            BOOL found = NO;
+            
+            while (position <= lastMatchStart) {
+                uint32_t const hash = MUKLZ4Hash(input + position);
+                reference = hashTable[hash];
+                hashTable[hash] = (uint32_t)position;
+                
+                if (reference < position && position - reference <= MUK_LZ4_MAX_OFFSET && memcmp(input + reference, input + position, MUK_LZ4_MIN_MATCH) == 0)
+                {
+                    found = YES;
+                    break;
+                }
+                
+                position += acceleration + (misses++ >> 6);
+            } // while
+            
+            if (!found) break;
+            
+            // Extend match backwards and forwards
+            while (position > anchor && reference > 0 && input[position - 1] == input[reference - 1])
+            {
+                position--;
+                reference--;
+            } // while
+            
+            size_t matchLength = MUK_LZ4_MIN_MATCH;
+            while (position + matchLength < lastMatchEnd && input[position + matchLength] == input[reference + matchLength])
+            {
+                matchLength++;
+            } // while
+            
+            output = MUKLZ4WriteSequence(output, input + anchor, position - anchor, position - reference, matchLength);
+            position += matchLength;
+            anchor = position;
+            
+            if (position <= lastMatchStart) {
+                hashTable[MUKLZ4Hash(input + position - 2)] = (uint32_t)(position - 2);
+            }
+        } // while
+    }
+    
+    output = MUKLZ4WriteSequence(output, input + anchor, length - anchor, 0, 0);
+    return (size_t)(output - outputStart);
+}
+
+// Decodes a block at output + outputStart; bytes before outputStart are
+// history that matches can refer to. Returns decoded length or -1.
+static long MUKLZ4DecompressBlock(uint8_t const *input, size_t length, uint8_t *output, size_t outputStart, size_t outputCapacity)
+{
+    uint8_t const *const inputEnd = input + length;
+    size_t position = outputStart;
+    
+    while (input < inputEnd) {
+        uint8_t const token = *input++;
+        
+        size_t literalsLength = token >> 4;
+        if (literalsLength == 15) {
+            uint8_t byte;
+            do {
+                if (input >= inputEnd) return -1;
+                byte = *input++;
+                literalsLength += byte;
+            } while (byte == 255);
+        }
+        
+        if (literalsLength > (size_t)(inputEnd - input) || literalsLength > outputCapacity - position)
+        {
+            return -1;
+        }
+        
+        memcpy(output + position, input, literalsLength);
+        input += literalsLength;
+        position += literalsLength;
+        
+        // Last sequence has literals only
+        if (input == inputEnd) break;
+        
+        if (inputEnd - input < 2) return -1;
+        size_t const offset = input[0] | ((size_t)input[1] << 8);
+        input += 2;
+        if (offset == 0 || offset > position) return -1;
+        
+        size_t matchLength = token & 15;
+        if (matchLength == 15) {
+            uint8_t byte;
+            do {
+                if (input >= inputEnd) return -1;
+                byte = *input++;
+                matchLength += byte;
+            } while (byte == 255);
+        }
+        
+        matchLength += MUK_LZ4_MIN_MATCH;
+        if (matchLength > outputCapacity - position) return -1;
+        
+        uint8_t const *match = output + position - offset;
+        if (offset >= matchLength) {
+            memcpy(output + position, match, matchLength);
+            position += matchLength;
+        }
+        else {
+            // Overlapping match repeats last bytes
+            for (size_t i = 0; i < matchLength; i++) {
+                output[position++] = match[i];
+            } // for
+        }
+    } // while
+    
+    return (long)(position - outputStart);
+}
+
+#pragma mark - LZ4 Frame
+
+#define MUK_LZ4_FRAME_MAGIC             0x184D2204U
+#define MUK_LZ4_SKIPPABLE_MAGIC_MASK    0xFFFFFFF0U
+#define MUK_LZ4_SKIPPABLE_MAGIC         0x184D2A50U
+#define MUK_LZ4_FRAME_BLOCK_SIZE_ID     4 // 64 KB blocks
+#define MUK_LZ4_FRAME_BLOCK_SIZE        (64 * 1024)
+#define MUK_LZ4_FRAME_WINDOW_SIZE       (64 * 1024)
+#define MUK_LZ4_UNCOMPRESSED_BIT        0x80000000U
+
+typedef void (*MUKLZ4OutputFunction)(void *context, uint8_t const *bytes, size_t length);
+
+typedef struct {
+    uint32_t acceleration;
+    BOOL wroteHeader;
+    uint8_t *block;
+    size_t blockLength;
+    uint8_t *compressedBlock;
+    uint32_t *hashTable;
+    MUKXXH32State contentHash;
+} MUKLZ4FrameEncoder;
+
+static BOOL MUKLZ4FrameEncoderInit(MUKLZ4FrameEncoder *encoder, uint32_t acceleration)
+{
+    memset(encoder, 0, sizeof(*encoder));
+    encoder->acceleration = MAX(acceleration, 1U);
+    encoder->block = malloc(MUK_LZ4_FRAME_BLOCK_SIZE);
+    encoder->compressedBlock = malloc(MUKLZ4CompressBound(MUK_LZ4_FRAME_BLOCK_SIZE));
+    encoder->hashTable = malloc(sizeof(uint32_t) << MUK_LZ4_HASH_LOG);
+    MUKXXH32Reset(&encoder->contentHash);
+    
+    return (encoder->block && encoder->compressedBlock && encoder->hashTable);
+}
+
+static void MUKLZ4FrameEncoderDestroy(MUKLZ4FrameEncoder *encoder) {
+    free(encoder->block);
+    free(encoder->compressedBlock);
+    free(encoder->hashTable);
+    memset(encoder, 0, sizeof(*encoder));
+}
+
+static void MUKLZ4FrameEncoderWriteHeader(MUKLZ4FrameEncoder *encoder, MUKLZ4OutputFunction output, void *context)
+{
+    if (encoder->wroteHeader) return;
+    encoder->wroteHeader = YES;
+    
+    // Version 01, independent blocks, content checksum
+    uint8_t header[7];
+    MUKWriteLE32(header, MUK_LZ4_FRAME_MAGIC);
+    header[4] = 0x40 | 0x20 | 0x04;
+    header[5] = MUK_LZ4_FRAME_BLOCK_SIZE_ID << 4;
+    header[6] = (uint8_t)(MUKXXH32(header + 4, 2) >> 8);
+    
+    output(context, header, sizeof(header));
+}
+
+static void MUKLZ4FrameEncoderFlushBlock(MUKLZ4FrameEncoder *encoder, MUKLZ4OutputFunction output, void *context)
+{
+    if (encoder->blockLength == 0) return;
+    
+    uint8_t blockHeader[4];
+    size_t const compressedLength = MUKLZ4CompressBlock(encoder->block, encoder->blockLength, encoder->compressedBlock, encoder->hashTable, encoder->acceleration);
+    
+    if (compressedLength < encoder->blockLength) {
+        MUKWriteLE32(blockHeader, (uint32_t)compressedLength);
+        output(context, blockHeader, sizeof(blockHeader));
+        output(context, encoder->compressedBlock, compressedLength);
+    }
+    else {
+        // Incompressible blocks are stored
+        MUKWriteLE32(blockHeader, (uint32_t)encoder->blockLength | MUK_LZ4_UNCOMPRESSED_BIT);
+        output(context, blockHeader, sizeof(blockHeader));
+        output(context, encoder->block, encoder->blockLength);
+    }
+    
+    encoder->blockLength = 0;
+}
+
+static void MUKLZ4FrameEncoderUpdate(MUKLZ4FrameEncoder *encoder, uint8_t const *bytes, size_t length, MUKLZ4OutputFunction output, void *context)
+{
+    MUKLZ4FrameEncoderWriteHeader(encoder, output, context);
+    MUKXXH32Update(&encoder->contentHash, bytes, length);
+    
+    while (length > 0) {
+        size_t const copyLength = MIN(length, MUK_LZ4_FRAME_BLOCK_SIZE - encoder->blockLength);
+        memcpy(encoder->block + encoder->blockLength, bytes, copyLength);
+        encoder->blockLength += copyLength;
+        bytes += copyLength;
+        length -= copyLength;
+        
+        if (encoder->blockLength == MUK_LZ4_FRAME_BLOCK_SIZE) {
+            MUKLZ4FrameEncoderFlushBlock(encoder, output, context);
+        }
+    } // while
+}
+
+static void MUKLZ4FrameEncoderFinish(MUKLZ4FrameEncoder *encoder, MUKLZ4OutputFunction output, void *context)
+{
+    MUKLZ4FrameEncoderWriteHeader(encoder, output, context);
+    MUKLZ4FrameEncoderFlushBlock(encoder, output, context);
+    
+    // End mark and content checksum
+    uint8_t trailer[8];
+    MUKWriteLE32(trailer, 0);
+    MUKWriteLE32(trailer + 4, MUKXXH32Digest(&encoder->contentHash));
+    output(context, trailer, sizeof(trailer));
+}
+
+typedef enum {
+    MUKLZ4FrameDecoderStateMagic = 0,
+    MUKLZ4FrameDecoderStateDescriptor,
+    MUKLZ4FrameDecoderStateBlockHeader,
+    MUKLZ4FrameDecoderStateBlock,
+    MUKLZ4FrameDecoderStateContentChecksum,
+    MUKLZ4FrameDecoderStateSkippableHeader,
+    MUKLZ4FrameDecoderStateSkippableFrame
+} MUKLZ4FrameDecoderState;
+
+typedef struct {
+    MUKLZ4FrameDecoderState state;
+    uint8_t *pending;
+    size_t pendingLength, pendingCapacity;
+    
+    uint8_t flags;
+    size_t blockMaximumSize;
+    uint32_t blockHeader;
+    uint64_t skipLength;
+    
+    // Last decoded bytes (matches of linked blocks refer to them), followed
+    // by room for a block
+    uint8_t *window;
+    size_t windowLength, windowCapacity;
+    
+    MUKXXH32State contentHash;
+} MUKLZ4FrameDecoder;
+
+static void MUKLZ4FrameDecoderInit(MUKLZ4FrameDecoder *decoder) {
+    memset(decoder, 0, sizeof(*decoder));
+}
+
+static void MUKLZ4FrameDecoderDestroy(MUKLZ4FrameDecoder *decoder) {
+    free(decoder->pending);
+    free(decoder->window);
+    memset(decoder, 0, sizeof(*decoder));
+}
+
+// Decodes a block into window, then gives decoded bytes to output
+static BOOL MUKLZ4FrameDecoderDecodeBlock(MUKLZ4FrameDecoder *decoder, uint8_t const *block, size_t length, BOOL compressed, MUKLZ4OutputFunction output, void *context)
+{
+    if (length > decoder->blockMaximumSize) return NO;
+    
+    // Keep last 64 KB only
+    if (decoder->windowLength > MUK_LZ4_FRAME_WINDOW_SIZE) {
+        memmove(decoder->window, decoder->window + decoder->windowLength - MUK_LZ4_FRAME_WINDOW_SIZE, MUK_LZ4_FRAME_WINDOW_SIZE);
+        decoder->windowLength = MUK_LZ4_FRAME_WINDOW_SIZE;
+    }
+    
+    size_t const requiredCapacity = MUK_LZ4_FRAME_WINDOW_SIZE + decoder->blockMaximumSize;
+    if (decoder->windowCapacity < requiredCapacity) {
+        uint8_t *window = realloc(decoder->window, requiredCapacity);
+        if (window == NULL) return NO;
+        
+        decoder->window = window;
+        decoder->windowCapacity = requiredCapacity;
+    }
+    
+    long decodedLength;
+    if (compressed) {
+        decodedLength = MUKLZ4DecompressBlock(block, length, decoder->window, decoder->windowLength, decoder->windowLength + decoder->blockMaximumSize);
+        if (decodedLength < 0) return NO;
+    }
+    else {
+        memcpy(decoder->window + decoder->windowLength, block, length);
+        decodedLength = (long)length;
+    }
+    
+    uint8_t const *decodedBytes = decoder->window + decoder->windowLength;
+    decoder->windowLength += (size_t)decodedLength;
+    
+    if (decoder->flags & 0x04) {
+        MUKXXH32Update(&decoder->contentHash, decodedBytes, (size_t)decodedLength);
+    }
+    
+    output(context, decodedBytes, (size_t)decodedLength);
+    return YES;
+}
+
+// Consumes as many pending bytes as possible
+static BOOL MUKLZ4FrameDecoderProcess(MUKLZ4FrameDecoder *decoder, MUKLZ4OutputFunction output, void *context)
+{
+    size_t consumed = 0;
+    
+    while (YES) {
+        uint8_t const *bytes = decoder->pending + consumed;
+        size_t const available = decoder->pendingLength - consumed;
+        
+        if (decoder->state == MUKLZ4FrameDecoderStateMagic) {
+            if (available < 4) break;
+            
+            uint32_t const magic = MUKReadLE32(bytes);
+            consumed += 4;
+            
+            if (magic == MUK_LZ4_FRAME_MAGIC) {
+                decoder->state = MUKLZ4FrameDecoderStateDescriptor;
+            }
+            else if ((magic & MUK_LZ4_SKIPPABLE_MAGIC_MASK) == MUK_LZ4_SKIPPABLE_MAGIC) {
+                decoder->state = MUKLZ4FrameDecoderStateSkippableHeader;
+            }
+            else {
+                return NO;
+            }
+        }
+        else if (decoder->state == MUKLZ4FrameDecoderStateDescriptor) {
+            if (available < 2) break;
+            
+            uint8_t const flags = bytes[0];
+            size_t const descriptorLength = 2 + ((flags & 0x08) ? 8 : 0) + ((flags & 0x01) ? 4 : 0);
+            if (available < descriptorLength + 1) break;
+            
+            // Version must be 01, dictionaries are not supported
+            uint8_t const blockSizeID = (bytes[1] >> 4) & 0x07;
+            if ((flags >> 6) != 1 || (flags & 0x01) || blockSizeID < 4) return NO;
+            if ((uint8_t)(MUKXXH32(bytes, descriptorLength) >> 8) != bytes[descriptorLength])
+            {
+                return NO;
+            }
+            
+            decoder->flags = flags;
+            decoder->blockMaximumSize = (size_t)1 << (8 + 2 * blockSizeID);
+            decoder->windowLength = 0;
+            MUKXXH32Reset(&decoder->contentHash);
+            
+            consumed += descriptorLength + 1;
+            decoder->state = MUKLZ4FrameDecoderStateBlockHeader;
+        }
+        else if (decoder->state == MUKLZ4FrameDecoderStateBlockHeader) {
+            if (available < 4) break;
+            
+            decoder->blockHeader = MUKReadLE32(bytes);
+            consumed += 4;
+            
+            if (decoder->blockHeader == 0) {
+                decoder->state = ((decoder->flags & 0x04) ? MUKLZ4FrameDecoderStateContentChecksum : MUKLZ4FrameDecoderStateMagic);
+            }
+            else {
+                decoder->state = MUKLZ4FrameDecoderStateBlock;
+            }
+        }
+        else if (decoder->state == MUKLZ4FrameDecoderStateBlock) {
+            size_t const blockLength = decoder->blockHeader & ~MUK_LZ4_UNCOMPRESSED_BIT;
+            size_t const checksumLength = ((decoder->flags & 0x10) ? 4 : 0);
+            
+            if (blockLength > decoder->blockMaximumSize) return NO;
+            if (available < blockLength + checksumLength) break;
+            
+            if (checksumLength && MUKXXH32(bytes, blockLength) != MUKReadLE32(bytes + blockLength))
+            {
+                return NO;
+            }
+            
+            BOOL const compressed = !(decoder->blockHeader & MUK_LZ4_UNCOMPRESSED_BIT);
+            if (!MUKLZ4FrameDecoderDecodeBlock(decoder, bytes, blockLength, compressed, output, context))
+            {
+                return NO;
+            }
+            
+            consumed += blockLength + checksumLength;
+            decoder->state = MUKLZ4FrameDecoderStateBlockHeader;
+        }
+        else if (decoder->state == MUKLZ4FrameDecoderStateContentChecksum) {
+            if (available < 4) break;
+            if (MUKReadLE32(bytes) != MUKXXH32Digest(&decoder->contentHash)) return NO;
+            
+            consumed += 4;
+            decoder->state = MUKLZ4FrameDecoderStateMagic;
+        }
+        else if (decoder->state == MUKLZ4FrameDecoderStateSkippableHeader) {
+            if (available < 4) break;
+            
+            decoder->skipLength = MUKReadLE32(bytes);
+            consumed += 4;
+            decoder->state = MUKLZ4FrameDecoderStateSkippableFrame;
+        }
+        else {
+            size_t const skipLength = (size_t)MIN((uint64_t)available, decoder->skipLength);
+            consumed += skipLength;
+            decoder->skipLength -= skipLength;
+            
+            if (decoder->skipLength > 0) break;
+            decoder->state = MUKLZ4FrameDecoderStateMagic;
+        }
+    } // while
+    
+    memmove(decoder->pending, decoder->pending + consumed, decoder->pendingLength - consumed);
+    decoder->pendingLength -= consumed;
+    
+    return YES;
+}
+
+static BOOL MUKLZ4FrameDecoderUpdate(MUKLZ4FrameDecoder *decoder, uint8_t const *bytes, size_t length, MUKLZ4OutputFunction output, void *context)
+{
+    if (decoder->pendingLength + length > decoder->pendingCapacity) {
+        size_t const capacity = MAX(decoder->pendingLength + length, 2 * decoder->pendingCapacity);
+        uint8_t *pending = realloc(decoder->pending, capacity);
+        if (pending == NULL) return NO;
+        
+        decoder->pending = pending;
+        decoder->pendingCapacity = capacity;
+    }
+    
+    memcpy(decoder->pending + decoder->pendingLength, bytes, length);
+    decoder->pendingLength += length;
+    
+    return MUKLZ4FrameDecoderProcess(decoder, output, context);
+}
+
+// Input must end between frames
+NS_INLINE BOOL MUKLZ4FrameDecoderFinish(MUKLZ4FrameDecoder *decoder) {
+    return (decoder->state == MUKLZ4FrameDecoderStateMagic && decoder->pendingLength == 0);
+}
+
+static void MUKDataCompressionStreamAppendOutput(void *context, uint8_t const *bytes, size_t length)
+{
+    [(__bridge NSMutableData *)context appendBytes:bytes length:length];
+}
+
+#pragma mark - Stream
+
+@implementation MUKDataCompressionStream {
+    z_stream zStream_;
+    BOOL zStreamInitialized_, zStreamEnded_;
+    
+    MUKLZ4FrameEncoder lz4Encoder_;
+    MUKLZ4FrameDecoder lz4Decoder_;
+    
+    BOOL closed_;
+}
+
+@synthesize format = format_;
+@synthesize compressing = compressing_;
+@synthesize level = level_;
+
+- (id)initForCompressionWithFormat:(MUKDataCompressionFormat)format level:(NSInteger)level
+{
+    self = [super init];
+    if (self) {
+        format_ = format;
+        compressing_ = YES;
+        level_ = (level == MUKDataCompressionLevelDefault ? level : MAX(MUKDataCompressionLevelFastest, MIN(level, MUKDataCompressionLevelBest)));
+        
+        if (format == MUKDataCompressionFormatLZ4) {
+            // Level 5 and more look for a match at every position
+            NSInteger const acceleration = (level_ == MUKDataCompressionLevelDefault ? 1 : MAX(1, 2 * (5 - level_) + 1));
+            closed_ = !MUKLZ4FrameEncoderInit(&lz4Encoder_, (uint32_t)acceleration);
+        }
+        else {
+            int const windowBits = MAX_WBITS + (format == MUKDataCompressionFormatGzip ? 16 : 0);
+            zStreamInitialized_ = (deflateInit2(&zStream_, (int)level_, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+            closed_ = !zStreamInitialized_;
+        }
+    }
+    
+    return self;
+}
+
+- (id)initForDecompressionWithFormat:(MUKDataCompressionFormat)format {
+    self = [super init];
+    if (self) {
+        format_ = format;
+        compressing_ = NO;
+        level_ = MUKDataCompressionLevelDefault;
+        
+        if (format == MUKDataCompressionFormatLZ4) {
+            MUKLZ4FrameDecoderInit(&lz4Decoder_);
+        }
+        else {
+            // Detect zlib or gzip wrapper automatically
+            zStreamInitialized_ = (inflateInit2(&zStream_, MAX_WBITS + 32) == Z_OK);
+            closed_ = !zStreamInitialized_;
+        }
+    }
+    
+    return self;
+}
+
+- (void)dealloc {
+    if (zStreamInitialized_) {
+        if (compressing_) deflateEnd(&zStream_);
+        else inflateEnd(&zStream_);
+    }
+    
+    if (format_ == MUKDataCompressionFormatLZ4) {
+        if (compressing_) MUKLZ4FrameEncoderDestroy(&lz4Encoder_);
+        else MUKLZ4FrameDecoderDestroy(&lz4Decoder_);
+    }
+}
+
+- (NSData *)processData:(NSData *)data {
+    if (closed_) return nil;
+    
+    NSMutableData *output = [NSMutableData data];
+    __block BOOL success = YES;
+    
+    // Discontiguous data (e.g. MUKChunkedData) is processed region by region
+    if ([data respondsToSelector:@selector(enumerateByteRangesUsingBlock:)]) {
+        [data enumerateByteRangesUsingBlock:^(void const *bytes, NSRange byteRange, BOOL *stop)
+        {
+            success = [self processBytes_:bytes length:byteRange.length output:output];
+            *stop = !success;
+        }];
+    }
+    else {
+        success = [self processBytes_:[data bytes] length:[data length] output:output];
+    }
+    
+    if (!success) {
+        closed_ = YES;
+        return nil;
+    }
+    
+    return output;
+}
+
+- (NSData *)finish {
+    if (closed_) return nil;
+    
+    NSMutableData *output = [NSMutableData data];
+    BOOL success = YES;
+    
+    if (format_ == MUKDataCompressionFormatLZ4) {
+        if (compressing_) {
+            MUKLZ4FrameEncoderFinish(&lz4Encoder_, MUKDataCompressionStreamAppendOutput, (__bridge void *)output);
+        }
+        else {
+            success = MUKLZ4FrameDecoderFinish(&lz4Decoder_);
+        }
+    }
+    else {
+        success = [self processZlibBytes_:NULL length:0 finish:YES output:output];
+        
+        // Truncated input never reaches the end of the stream
+        if (!compressing_) success = success && zStreamEnded_;
+    }
+    
+    closed_ = YES;
+    return (success ? output : nil);
+}
+
++ (NSData *)compressData:(NSData *)data format:(MUKDataCompressionFormat)format level:(NSInteger)level
+{
+    if (data == nil) return nil;
+    
+    MUKDataCompressionStream *stream = [[self alloc] initForCompressionWithFormat:format level:level];
+    return [self processData_:data stream:stream];
+}
+
++ (NSData *)decompressData:(NSData *)data format:(MUKDataCompressionFormat)format
+{
+    if (data == nil) return nil;
+    
+    MUKDataCompressionStream *stream = [[self alloc] initForDecompressionWithFormat:format];
+    return [self processData_:data stream:stream];
+}
+
+#pragma mark - Private
+
++ (NSData *)processData_:(NSData *)data stream:(MUKDataCompressionStream *)stream
+{
+    NSData *output = [stream processData:data];
+    NSData *finalOutput = [stream finish];
+    if (output == nil || finalOutput == nil) return nil;
+    
+    NSMutableData *result = [output mutableCopy];
+    [result appendData:finalOutput];
+    return result;
+}
+
+- (BOOL)processBytes_:(uint8_t const *)bytes length:(NSUInteger)length output:(NSMutableData *)output
+{
+    if (format_ == MUKDataCompressionFormatLZ4) {
+        if (compressing_) {
+            MUKLZ4FrameEncoderUpdate(&lz4Encoder_, bytes, length, MUKDataCompressionStreamAppendOutput, (__bridge void *)output);
+            return YES;
+        }
+        
+        return MUKLZ4FrameDecoderUpdate(&lz4Decoder_, bytes, length, MUKDataCompressionStreamAppendOutput, (__bridge void *)output);
+    }
+    
+    return [self processZlibBytes_:bytes length:length finish:NO output:output];
+}
+
+- (BOOL)processZlibBytes_:(uint8_t const *)bytes length:(NSUInteger)length finish:(BOOL)finish output:(NSMutableData *)output
+{
+    Bytef buffer[MUK_DATA_COMPRESSION_BUFFER_LENGTH];
+    
+    // zlib counts bytes with 32 bit integers
+    do {
+        uInt const chunkLength = (uInt)MIN(length, (NSUInteger)UINT32_MAX);
+        BOOL const lastChunk = (chunkLength == length);
+        
+        zStream_.next_in = (Bytef *)bytes;
+        zStream_.avail_in = chunkLength;
+        bytes += chunkLength;
+        length -= chunkLength;
+        
+        if (compressing_) {
+            int const flush = (finish && lastChunk ? Z_FINISH : Z_NO_FLUSH);
+            
+            do {
+                zStream_.next_out = buffer;
+                zStream_.avail_out = sizeof(buffer);
+                if (deflate(&zStream_, flush) == Z_STREAM_ERROR) return NO;
+                
+                [output appendBytes:buffer length:sizeof(buffer) - zStream_.avail_out];
+            } while (zStream_.avail_out == 0);
+        }
+        else {
+            do {
+                if (zStreamEnded_) {
+                    if (zStream_.avail_in == 0) break;
+                    
+                    // Next member of concatenated gzip data
+                    if (inflateReset(&zStream_) != Z_OK) return NO;
+                    zStreamEnded_ = NO;
+                }
+                
+                zStream_.next_out = buffer;
+                zStream_.avail_out = sizeof(buffer);
+                
+                int const status = inflate(&zStream_, Z_NO_FLUSH);
+                if (status == Z_BUF_ERROR) break; // Needs more input
+                if (status != Z_OK && status != Z_STREAM_END) return NO;
+                
+                [output appendBytes:buffer length:sizeof(buffer) - zStream_.avail_out];
+                if (status == Z_STREAM_END) zStreamEnded_ = YES;
+            } while (zStream_.avail_in > 0 || zStream_.avail_out == 0);
+        }
+    } while (length > 0);
+    
+    return YES;
+}
+
+@end
@@ -0,0 +1,186 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import <Foundation/Foundation.h>
+
+/**
+ A disk cache which stores data under a directory (typically inside 
+ *Caches* directory).
+ 
+ Every entry is named after the `MUKDataTransformSHA1` digest of its key and
+ files are sharded into 256 subdirectories, named after the first byte of the
+ digest:
+ 
+    <directory>/3f/0a1c...e9
+ 
+ Data is written to a temporary file which is atomically renamed into place,
+ so readers never see partial entries. Reads are memory-mapped: returned
+ data stays valid even if the entry is replaced or evicted meanwhile.
+ 
+ Cache enforces a size limit and an age limit evicting least recently used
+ entries. Sizes and access times are kept in memory and recorded into an
+ append-only journal of fixed size records, which is replayed when cache is
+ opened and compacted when it grows too much. Directory is scanned only
+ when journal is missing or damaged. Entries are journaled before their files
+ are moved into place, so an interrupted write leaves at most a journaled
+ entry without file, which is forgotten when it is read.
+ 
+ Every method is thread-safe. Synchronous methods do disk I/O on calling 
+ thread, so you should call asynchronous variants from main thread.
+ 
+ @warning Do not open two caches on the same directory.
+ */
+@interface MUKDiskCache : NSObject
+/**
+ Directory where entries are stored.
+ */
+@property (nonatomic, strong, readonly) NSURL *directoryURL;
+/**
+ Maximum total size of entries, in bytes. `0` means no limit.
+ */
+@property (nonatomic, readonly) unsigned long long sizeLimit;
+/**
+ Maximum time interval since last access of an entry. `0` means no limit.
+ */
+@property (nonatomic, readonly) NSTimeInterval ageLimit;
+/**
+ Total size of entries, in bytes.
+ */
+@property (readonly) unsigned long long totalSize;
+/**
+ Number of entries.
+ */
+@property (readonly) NSUInteger count;
+
+/**
+ Creates a cache inside *Caches* directory.
+ @param name Name of cache directory inside `[MUK URLForCachesDirectory]`.
+ @param sizeLimit Maximum total size of entries, in bytes. Pass `0` for no
+ limit.
+ @param ageLimit Maximum time interval since last access of an entry. Pass 
+ `0` for no limit.
+ @return A new cache.
+ */
+- (id)initWithName:(NSString *)name sizeLimit:(unsigned long long)sizeLimit ageLimit:(NSTimeInterval)ageLimit;
+/**
+ Creates a cache.
+ 
+ This is the designated initializer. Journal is loaded in background, so
+ this method does not block.
+ 
+ @param directoryURL File URL of cache directory. It is created if needed.
+ @param sizeLimit Maximum total size of entries, in bytes. Pass `0` for no
+ limit.
+ @param ageLimit Maximum time interval since last access of an entry. Pass 
+ `0` for no limit.
+ @return A new cache.
+ */
+- (id)initWithDirectoryURL:(NSURL *)directoryURL sizeLimit:(unsigned long long)sizeLimit ageLimit:(NSTimeInterval)ageLimit;
+
+/**
+ Reads an entry.
+ @param key Key of the entry.
+ @return Memory-mapped data of the entry or `nil` if entry is not cached.
+ */
+- (NSData *)dataForKey:(NSString *)key;
+/**
+ Writes an entry, replacing any existing one.
+ @param data Data to store.
+ @param key Key of the entry.
+ @return `YES` if data has been stored.
+ */
+- (BOOL)setData:(NSData *)data forKey:(NSString *)key;
+/**
+ Writes an entry keyed by its content.
+ @param data Data to store.
+ @return Key of the entry, which is the hexadecimal representation of 
+ `MUKDataTransformSHA1` digest of `data`, or `nil` if data could not be
+ stored. Same data always gives the same key.
+ */
+- (NSString *)addData:(NSData *)data;
+/**
+ Tells if an entry is cached, without reading it.
+ @param key Key of the entry.
+ @return `YES` if entry is cached.
+ */
+- (BOOL)containsDataForKey:(NSString *)key;
+/**
+ Removes an entry.
+ @param key Key of the entry.
+ */
+- (void)removeDataForKey:(NSString *)key;
+/**
+ Removes every entry.
+ */
+- (void)removeAllData;
+
+/**
+ Reads many entries at once.
+ @param keys Keys of entries.
+ @return A dictionary which maps each cached key to memory-mapped data.
+ Keys which are not cached are missing.
+ */
+- (NSDictionary *)dataForKeys:(NSArray *)keys;
+/**
+ Writes many entries at once.
+ @param dataByKeys A dictionary which maps keys to data to store.
+ @return `YES` if every entry has been stored.
+ */
+- (BOOL)setDataByKeys:(NSDictionary *)dataByKeys;
+
+/**
+ Reads an entry in background.
+ @param key Key of the entry.
+ @param completionHandler Block called on main queue with data of the 
+ entry (`nil` if entry is not cached).
+ @see dataForKey:
+ */
+- (void)dataForKey:(NSString *)key completionHandler:(void (^)(NSData *data))completionHandler;
+/**
+ Writes an entry in background.
+ @param data Data to store.
+ @param key Key of the entry.
+ @param completionHandler Block called on main queue when data has been
+ written. It can be `nil`.
+ @see setData:forKey:
+ */
+- (void)setData:(NSData *)data forKey:(NSString *)key completionHandler:(void (^)(BOOL success))completionHandler;
+/**
+ Reads many entries in background.
+ @param keys Keys of entries.
+ @param completionHandler Block called on main queue with a dictionary
+ which maps each cached key to its data.
+ @see dataForKeys:
+ */
+- (void)dataForKeys:(NSArray *)keys completionHandler:(void (^)(NSDictionary *dataByKeys))completionHandler;
+/**
+ Writes many entries in background.
+ @param dataByKeys A dictionary which maps keys to data to store.
+ @param completionHandler Block called on main queue when data has been
+ written. It can be `nil`.
+ @see setDataByKeys:
+ */
+- (void)setDataByKeys:(NSDictionary *)dataByKeys completionHandler:(void (^)(BOOL success))completionHandler;
+@end
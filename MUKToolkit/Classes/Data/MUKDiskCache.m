@@ -0,0 +1,741 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUKDiskCache.h"
+#import "MUK+Data.h"
+#import "MUK+URL.h"
+#import "MUKDigest.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define MUK_DISK_CACHE_JOURNAL_MAGIC            0x4A4B554Du // "MUKJ"
+#define MUK_DISK_CACHE_JOURNAL_VERSION          1
+#define MUK_DISK_CACHE_MIN_COMPACTION_RECORDS   1024
+
+static NSString *const kJournalFileName = @"journal";
+static NSString *const kTemporaryDirectoryName = @"tmp";
+
+typedef enum : uint8_t {
+    MUKDiskCacheOperationPut = 1,
+    MUKDiskCacheOperationAccess,
+    MUKDiskCacheOperationRemove
+} MUKDiskCacheOperation;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+} MUKDiskCacheJournalHeader;
+
+// 40 bytes per record
+typedef struct {
+    uint8_t operation;
+    uint8_t digest[CC_SHA1_DIGEST_LENGTH];
+    uint8_t reserved[3];
+    uint64_t size;
+    double time;
+} MUKDiskCacheJournalRecord;
+
+static NSString *MUKDiskCacheHexString(uint8_t const *bytes, NSUInteger length)
+{
+    static char const digits[] = "0123456789abcdef";
+    char buffer[2 * CC_SHA1_DIGEST_LENGTH + 1];
+    
+    length = MIN(length, (NSUInteger)CC_SHA1_DIGEST_LENGTH);
+    for (NSUInteger i = 0; i < length; i++) {
+        buffer[2 * i] = digits[bytes[i] >> 4];
+        buffer[2 * i + 1] = digits[bytes[i] & 0x0F];
+    } // for
+    
+    return [[NSString alloc] initWithBytes:buffer length:2 * length encoding:NSASCIIStringEncoding];
+}
+
+NS_INLINE int MUKDiskCacheHexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Parses a digest back from shard name and file name
+static NSData *MUKDiskCacheDigestFromHexString(NSString *string) {
+    char buffer[2 * CC_SHA1_DIGEST_LENGTH + 1];
+    if ([string length] != 2 * CC_SHA1_DIGEST_LENGTH ||
+        ![string getCString:buffer maxLength:sizeof(buffer) encoding:NSASCIIStringEncoding])
+    {
+        return nil;
+    }
+    
+    uint8_t digest[CC_SHA1_DIGEST_LENGTH];
+    for (NSUInteger i = 0; i < CC_SHA1_DIGEST_LENGTH; i++) {
+        int const high = MUKDiskCacheHexValue(buffer[2 * i]);
+        int const low = MUKDiskCacheHexValue(buffer[2 * i + 1]);
+        if (high < 0 || low < 0) return nil;
+        
+        digest[i] = (uint8_t)((high << 4) | low);
+    } // for
+    
+    return [NSData dataWithBytes:digest length:CC_SHA1_DIGEST_LENGTH];
+}
+
+NS_INLINE MUKDiskCacheJournalRecord MUKDiskCacheMakeRecord(MUKDiskCacheOperation operation, NSData *digest, unsigned long long size, CFAbsoluteTime time)
+{
+    MUKDiskCacheJournalRecord record;
+    memset(&record, 0, sizeof(record));
+    record.operation = operation;
+    [digest getBytes:record.digest length:CC_SHA1_DIGEST_LENGTH];
+    record.size = size;
+    record.time = time;
+    return record;
+}
+
+#pragma mark - Entry
+
+// A node of LRU list: entries dictionary owns nodes
+@interface MUKDiskCacheEntry : NSObject
+@property (nonatomic, strong) NSData *digest;
+@property (nonatomic) unsigned long long size;
+@property (nonatomic) CFAbsoluteTime accessTime;
+@property (nonatomic, unsafe_unretained) MUKDiskCacheEntry *older, *newer;
+@end
+
+@implementation MUKDiskCacheEntry
+@synthesize digest = digest_, size = size_, accessTime = accessTime_;
+@synthesize older = older_, newer = newer_;
+@end
+
+#pragma mark - Cache
+
+@implementation MUKDiskCache {
+    // Every ivar below is accessed on queue_ only
+    dispatch_queue_t queue_;
+    NSMutableDictionary *entries_;
+    __unsafe_unretained MUKDiskCacheEntry *oldestEntry_, *newestEntry_;
+    unsigned long long totalSize_;
+    int journalDescriptor_;
+    NSUInteger journalRecordsCount_;
+    
+    NSString *directoryPath_, *temporaryDirectoryPath_;
+}
+
+@synthesize directoryURL = directoryURL_;
+@synthesize sizeLimit = sizeLimit_;
+@synthesize ageLimit = ageLimit_;
+
+- (id)initWithName:(NSString *)name sizeLimit:(unsigned long long)sizeLimit ageLimit:(NSTimeInterval)ageLimit
+{
+    NSURL *directoryURL = [[MUK URLForCachesDirectory] URLByAppendingPathComponent:name isDirectory:YES];
+    return [self initWithDirectoryURL:directoryURL sizeLimit:sizeLimit ageLimit:ageLimit];
+}
+
+- (id)initWithDirectoryURL:(NSURL *)directoryURL sizeLimit:(unsigned long long)sizeLimit ageLimit:(NSTimeInterval)ageLimit
+{
+    self = [super init];
+    if (self) {
+        directoryURL_ = directoryURL;
+        sizeLimit_ = sizeLimit;
+        ageLimit_ = ageLimit;
+        
+        directoryPath_ = [directoryURL path];
+        temporaryDirectoryPath_ = [directoryPath_ stringByAppendingPathComponent:kTemporaryDirectoryName];
+        entries_ = [[NSMutableDictionary alloc] init];
+        journalDescriptor_ = -1;
+        
+        // Move leftovers of previous runs away, so they can be deleted in
+        // background while new temporary files are written
+        NSFileManager *fileManager = [[NSFileManager alloc] init];
+        NSString *staleDirectoryPath = nil;
+        if ([fileManager fileExistsAtPath:temporaryDirectoryPath_]) {
+            staleDirectoryPath = [temporaryDirectoryPath_ stringByAppendingFormat:@"-%@", [[NSProcessInfo processInfo] globallyUniqueString]];
+            
+            if (![fileManager moveItemAtPath:temporaryDirectoryPath_ toPath:staleDirectoryPath error:nil])
+            {
+                staleDirectoryPath = nil;
+            }
+        }
+        
+        [fileManager createDirectoryAtPath:temporaryDirectoryPath_ withIntermediateDirectories:YES attributes:nil error:nil];
+        
+        queue_ = dispatch_queue_create("it.melive.mukit.MUKToolkit.MUKDiskCache", NULL);
+        dispatch_async(queue_, ^{
+            if (staleDirectoryPath) {
+                [fileManager removeItemAtPath:staleDirectoryPath error:nil];
+            }
+            
+            [self loadJournal_];
+            [self evictEntries_];
+        });
+    }
+    
+    return self;
+}
+
+- (void)dealloc {
+    if (journalDescriptor_ >= 0) close(journalDescriptor_);
+    if (queue_) dispatch_release(queue_);
+}
+
+- (unsigned long long)totalSize {
+    __block unsigned long long totalSize;
+    dispatch_sync(queue_, ^{
+        totalSize = totalSize_;
+    });
+    
+    return totalSize;
+}
+
+- (NSUInteger)count {
+    __block NSUInteger count;
+    dispatch_sync(queue_, ^{
+        count = [entries_ count];
+    });
+    
+    return count;
+}
+
+#pragma mark Synchronous
+
+- (NSData *)dataForKey:(NSString *)key {
+    if (key == nil) return nil;
+    return [self dataForKeys:@[key]][key];
+}
+
+- (BOOL)setData:(NSData *)data forKey:(NSString *)key {
+    if (data == nil || key == nil) return NO;
+    return [self setDataByKeys:@{key: data}];
+}
+
+- (NSString *)addData:(NSData *)data {
+    if (data == nil) return nil;
+    
+    NSData *digest = [MUK data:data applyingTransform:MUKDataTransformSHA1];
+    NSString *key = MUKDiskCacheHexString([digest bytes], [digest length]);
+    
+    return ([self setData:data forKey:key] ? key : nil);
+}
+
+- (BOOL)containsDataForKey:(NSString *)key {
+    if (key == nil) return NO;
+    
+    NSData *digest = [self digestForKey_:key];
+    __block BOOL contained;
+    dispatch_sync(queue_, ^{
+        contained = (entries_[digest] != nil);
+    });
+    
+    return contained;
+}
+
+- (void)removeDataForKey:(NSString *)key {
+    if (key == nil) return;
+    
+    NSData *digest = [self digestForKey_:key];
+    dispatch_sync(queue_, ^{
+        MUKDiskCacheEntry *entry = entries_[digest];
+        if (entry) {
+            MUKDiskCacheJournalRecord const record = MUKDiskCacheMakeRecord(MUKDiskCacheOperationRemove, digest, 0, CFAbsoluteTimeGetCurrent());
+            [self removeEntry_:entry deletingFile:YES];
+            [self appendRecords_:&record count:1];
+        }
+    });
+}
+
+- (void)removeAllData {
+    dispatch_sync(queue_, ^{
+        NSFileManager *fileManager = [[NSFileManager alloc] init];
+        
+        for (NSString *fileName in [fileManager contentsOfDirectoryAtPath:directoryPath_ error:nil])
+        {
+            if ([fileName length] == 2) {
+                [fileManager removeItemAtPath:[directoryPath_ stringByAppendingPathComponent:fileName] error:nil];
+            }
+        } // for
+        
+        [entries_ removeAllObjects];
+        oldestEntry_ = newestEntry_ = nil;
+        totalSize_ = 0;
+        
+        [self compactJournal_];
+    });
+}
+
+- (NSDictionary *)dataForKeys:(NSArray *)keys {
+    NSMutableArray *digests = [NSMutableArray arrayWithCapacity:[keys count]];
+    for (NSString *key in keys) {
+        [digests addObject:[self digestForKey_:key]];
+    } // for
+    
+    // Find entries and mark them as recently used
+    NSMutableIndexSet *cachedIndexes = [NSMutableIndexSet indexSet];
+    dispatch_sync(queue_, ^{
+        CFAbsoluteTime const now = CFAbsoluteTimeGetCurrent();
+        NSMutableData *records = [NSMutableData data];
+        
+        [digests enumerateObjectsUsingBlock:^(NSData *digest, NSUInteger idx, BOOL *stop)
+        {
+            MUKDiskCacheEntry *entry = entries_[digest];
+            if (entry == nil) return;
+            
+            [self touchEntry_:entry time:now];
+            [cachedIndexes addIndex:idx];
+            
+            MUKDiskCacheJournalRecord const record = MUKDiskCacheMakeRecord(MUKDiskCacheOperationAccess, digest, 0, now);
+            [records appendBytes:&record length:sizeof(record)];
+        }];
+        
+        [self appendRecords_:[records bytes] count:[records length] / sizeof(MUKDiskCacheJournalRecord)];
+    });
+    
+    // Map files outside of queue
+    NSMutableDictionary *dataByKeys = [NSMutableDictionary dictionaryWithCapacity:[cachedIndexes count]];
+    NSMutableArray *missingDigests = [NSMutableArray array];
+    
+    [cachedIndexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+        NSData *digest = digests[idx];
+        NSData *data = [NSData dataWithContentsOfFile:[self pathForDigest_:digest] options:NSDataReadingMappedAlways error:nil];
+        
+        if (data) {
+            dataByKeys[keys[idx]] = data;
+        }
+        else {
+            [missingDigests addObject:digest];
+        }
+    }];
+    
+    if ([missingDigests count]) {
+        // Files could have been purged by the system: forget them
+        dispatch_async(queue_, ^{
+            [self forgetEntriesWithMissingFiles_:missingDigests];
+        });
+    }
+    
+    return dataByKeys;
+}
+
+- (BOOL)setDataByKeys:(NSDictionary *)dataByKeys {
+    NSMutableArray *digests = [NSMutableArray arrayWithCapacity:[dataByKeys count]];
+    NSMutableArray *temporaryPaths = [NSMutableArray arrayWithCapacity:[dataByKeys count]];
+    NSMutableArray *sizes = [NSMutableArray arrayWithCapacity:[dataByKeys count]];
+    __block BOOL success = YES;
+    
+    // Write temporary files outside of queue
+    [dataByKeys enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSData *data, BOOL *stop)
+    {
+        NSString *temporaryPath = [temporaryDirectoryPath_ stringByAppendingPathComponent:[[NSProcessInfo processInfo] globallyUniqueString]];
+        
+        if ([data writeToFile:temporaryPath options:0 error:nil]) {
+            [digests addObject:[self digestForKey_:key]];
+            [temporaryPaths addObject:temporaryPath];
+            [sizes addObject:@([data length])];
+        }
+        else {
+            success = NO;
+        }
+    }];
+    
+    // Record files, then rename them into place: after a crash journal 
+    // could only mention missing files, which are forgotten when read
+    dispatch_sync(queue_, ^{
+        CFAbsoluteTime const now = CFAbsoluteTimeGetCurrent();
+        NSMutableData *records = [NSMutableData data];
+        
+        [digests enumerateObjectsUsingBlock:^(NSData *digest, NSUInteger idx, BOOL *stop)
+        {
+            unsigned long long const size = [sizes[idx] unsignedLongLongValue];
+            MUKDiskCacheEntry *entry = entries_[digest];
+            
+            if (entry) {
+                totalSize_ = totalSize_ - entry.size + size;
+                entry.size = size;
+                [self touchEntry_:entry time:now];
+            }
+            else {
+                entry = [[MUKDiskCacheEntry alloc] init];
+                entry.digest = digest;
+                entry.size = size;
+                entry.accessTime = now;
+                [self insertEntry_:entry];
+            }
+            
+            MUKDiskCacheJournalRecord const record = MUKDiskCacheMakeRecord(MUKDiskCacheOperationPut, digest, size, now);
+            [records appendBytes:&record length:sizeof(record)];
+        }];
+        
+        [self appendRecords_:[records bytes] count:[records length] / sizeof(MUKDiskCacheJournalRecord)];
+        [records setLength:0];
+        
+        [digests enumerateObjectsUsingBlock:^(NSData *digest, NSUInteger idx, BOOL *stop)
+        {
+            NSString *path = [self pathForDigest_:digest];
+            mkdir([[path stringByDeletingLastPathComponent] fileSystemRepresentation], 0755);
+            
+            if (rename([temporaryPaths[idx] fileSystemRepresentation], [path fileSystemRepresentation]) != 0)
+            {
+                unlink([temporaryPaths[idx] fileSystemRepresentation]);
+                success = NO;
+                
+                // Previous file, if any, does not match recorded size
+                MUKDiskCacheEntry *entry = entries_[digest];
+                if (entry) {
+                    MUKDiskCacheJournalRecord const record = MUKDiskCacheMakeRecord(MUKDiskCacheOperationRemove, digest, 0, now);
+                    [records appendBytes:&record length:sizeof(record)];
+                    [self removeEntry_:entry deletingFile:YES];
+                }
+            }
+        }];
+        
+        [self appendRecords_:[records bytes] count:[records length] / sizeof(MUKDiskCacheJournalRecord)];
+        [self evictEntries_];
+    });
+    
+    return success;
+}
+
+#pragma mark Asynchronous
+
+- (void)dataForKey:(NSString *)key completionHandler:(void (^)(NSData *data))completionHandler
+{
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSData *data = [self dataForKey:key];
+        
+        if (completionHandler) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completionHandler(data);
+            });
+        }
+    });
+}
+
+- (void)setData:(NSData *)data forKey:(NSString *)key completionHandler:(void (^)(BOOL success))completionHandler
+{
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        BOOL const success = [self setData:data forKey:key];
+        
+        if (completionHandler) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completionHandler(success);
+            });
+        }
+    });
+}
+
+- (void)dataForKeys:(NSArray *)keys completionHandler:(void (^)(NSDictionary *dataByKeys))completionHandler
+{
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSDictionary *dataByKeys = [self dataForKeys:keys];
+        
+        if (completionHandler) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completionHandler(dataByKeys);
+            });
+        }
+    });
+}
+
+- (void)setDataByKeys:(NSDictionary *)dataByKeys completionHandler:(void (^)(BOOL success))completionHandler
+{
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        BOOL const success = [self setDataByKeys:dataByKeys];
+        
+        if (completionHandler) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completionHandler(success);
+            });
+        }
+    });
+}
+
+#pragma mark - Private
+
+- (NSData *)digestForKey_:(NSString *)key {
+    return [MUK data:[key dataUsingEncoding:NSUTF8StringEncoding] applyingTransform:MUKDataTransformSHA1];
+}
+
+- (NSString *)pathForDigest_:(NSData *)digest {
+    NSString *hexDigest = MUKDiskCacheHexString([digest bytes], [digest length]);
+    NSString *shardPath = [directoryPath_ stringByAppendingPathComponent:[hexDigest substringToIndex:2]];
+    return [shardPath stringByAppendingPathComponent:[hexDigest substringFromIndex:2]];
+}
+
+- (NSString *)journalPath_ {
+    return [directoryPath_ stringByAppendingPathComponent:kJournalFileName];
+}
+
+#pragma mark Private: LRU List
+
+- (void)insertEntry_:(MUKDiskCacheEntry *)entry {
+    entries_[entry.digest] = entry;
+    totalSize_ += entry.size;
+    
+    entry.older = newestEntry_;
+    entry.newer = nil;
+    newestEntry_.newer = entry;
+    newestEntry_ = entry;
+    if (oldestEntry_ == nil) oldestEntry_ = entry;
+}
+
+- (void)unlinkEntry_:(MUKDiskCacheEntry *)entry {
+    if (entry.older) entry.older.newer = entry.newer;
+    else oldestEntry_ = entry.newer;
+    
+    if (entry.newer) entry.newer.older = entry.older;
+    else newestEntry_ = entry.older;
+    
+    entry.older = entry.newer = nil;
+}
+
+- (void)touchEntry_:(MUKDiskCacheEntry *)entry time:(CFAbsoluteTime)time {
+    entry.accessTime = time;
+    if (entry == newestEntry_) return;
+    
+    [self unlinkEntry_:entry];
+    entry.older = newestEntry_;
+    newestEntry_.newer = entry;
+    newestEntry_ = entry;
+    if (oldestEntry_ == nil) oldestEntry_ = entry;
+}
+
+- (void)removeEntry_:(MUKDiskCacheEntry *)entry deletingFile:(BOOL)deleteFile
+{
+    NSData *digest = entry.digest;
+    if (deleteFile) {
+        unlink([[self pathForDigest_:digest] fileSystemRepresentation]);
+    }
+    
+    totalSize_ -= entry.size;
+    [self unlinkEntry_:entry];
+    
+    // Entry could be deallocated from here
+    [entries_ removeObjectForKey:digest];
+}
+
+- (void)evictEntries_ {
+    CFAbsoluteTime const now = CFAbsoluteTimeGetCurrent();
+    NSMutableData *records = [NSMutableData data];
+    
+    while (oldestEntry_) {
+        BOOL const tooBig = (sizeLimit_ > 0 && totalSize_ > sizeLimit_);
+        BOOL const tooOld = (ageLimit_ > 0.0 && now - oldestEntry_.accessTime > ageLimit_);
+        if (!tooBig && !tooOld) break;
+        
+        MUKDiskCacheJournalRecord const record = MUKDiskCacheMakeRecord(MUKDiskCacheOperationRemove, oldestEntry_.digest, 0, now);
+        [records appendBytes:&record length:sizeof(record)];
+        
+        [self removeEntry_:oldestEntry_ deletingFile:YES];
+    } // while
+    
+    [self appendRecords_:[records bytes] count:[records length] / sizeof(MUKDiskCacheJournalRecord)];
+}
+
+- (void)forgetEntriesWithMissingFiles_:(NSArray *)digests {
+    CFAbsoluteTime const now = CFAbsoluteTimeGetCurrent();
+    NSMutableData *records = [NSMutableData data];
+    
+    for (NSData *digest in digests) {
+        MUKDiskCacheEntry *entry = entries_[digest];
+        if (entry == nil) continue;
+        
+        // Entry could have been written again meanwhile
+        if (access([[self pathForDigest_:digest] fileSystemRepresentation], F_OK) == 0)
+        {
+            continue;
+        }
+        
+        MUKDiskCacheJournalRecord const record = MUKDiskCacheMakeRecord(MUKDiskCacheOperationRemove, digest, 0, now);
+        [records appendBytes:&record length:sizeof(record)];
+        
+        [self removeEntry_:entry deletingFile:NO];
+    } // for
+    
+    [self appendRecords_:[records bytes] count:[records length] / sizeof(MUKDiskCacheJournalRecord)];
+}
+
+#pragma mark Private: Journal
+
+- (void)loadJournal_ {
+    NSData *journal = [NSData dataWithContentsOfFile:[self journalPath_] options:NSDataReadingMappedIfSafe error:nil];
+    
+    MUKDiskCacheJournalHeader header;
+    BOOL valid = NO;
+    NSUInteger recordsCount = 0;
+    
+    if ([journal length] >= sizeof(header)) {
+        [journal getBytes:&header length:sizeof(header)];
+        valid = (header.magic == MUK_DISK_CACHE_JOURNAL_MAGIC && header.version == MUK_DISK_CACHE_JOURNAL_VERSION);
+    }
+    
+    if (valid) {
+        NSUInteger const recordsLength = [journal length] - sizeof(header);
+        recordsCount = recordsLength / sizeof(MUKDiskCacheJournalRecord);
+        
+        MUKDiskCacheJournalRecord const *records = (MUKDiskCacheJournalRecord const *)((uint8_t const *)[journal bytes] + sizeof(header));
+        [self replayRecords_:records count:recordsCount];
+        
+        // A truncated last record means journal has been interrupted
+        valid = (recordsLength % sizeof(MUKDiskCacheJournalRecord) == 0);
+    }
+    else {
+        [self scanDirectory_];
+    }
+    
+    if (valid && recordsCount < MAX(MUK_DISK_CACHE_MIN_COMPACTION_RECORDS, 2 * [entries_ count]))
+    {
+        journalDescriptor_ = open([[self journalPath_] fileSystemRepresentation], O_WRONLY | O_APPEND);
+        journalRecordsCount_ = recordsCount;
+    }
+    
+    if (journalDescriptor_ < 0) {
+        [self compactJournal_];
+    }
+}
+
+- (void)replayRecords_:(MUKDiskCacheJournalRecord const *)records count:(NSUInteger)count
+{
+    for (NSUInteger i = 0; i < count; i++) {
+        MUKDiskCacheJournalRecord const record = records[i];
+        NSData *digest = [NSData dataWithBytes:record.digest length:CC_SHA1_DIGEST_LENGTH];
+        MUKDiskCacheEntry *entry = entries_[digest];
+        
+        switch (record.operation) {
+            case MUKDiskCacheOperationPut:
+                if (entry) {
+                    totalSize_ = totalSize_ - entry.size + record.size;
+                    entry.size = record.size;
+                    [self touchEntry_:entry time:record.time];
+                }
+                else {
+                    entry = [[MUKDiskCacheEntry alloc] init];
+                    entry.digest = digest;
+                    entry.size = record.size;
+                    entry.accessTime = record.time;
+                    [self insertEntry_:entry];
+                }
+                break;
+            
+            case MUKDiskCacheOperationAccess:
+                if (entry) [self touchEntry_:entry time:record.time];
+                break;
+            
+            case MUKDiskCacheOperationRemove:
+                if (entry) [self removeEntry_:entry deletingFile:NO];
+                break;
+            
+            default:
+                break;
+        }
+    } // for
+}
+
+- (void)scanDirectory_ {
+    NSFileManager *fileManager = [[NSFileManager alloc] init];
+    NSMutableArray *entries = [NSMutableArray array];
+    
+    for (NSString *shardName in [fileManager contentsOfDirectoryAtPath:directoryPath_ error:nil])
+    {
+        if ([shardName length] != 2) continue;
+        
+        NSString *shardPath = [directoryPath_ stringByAppendingPathComponent:shardName];
+        for (NSString *fileName in [fileManager contentsOfDirectoryAtPath:shardPath error:nil])
+        {
+            NSData *digest = MUKDiskCacheDigestFromHexString([shardName stringByAppendingString:fileName]);
+            
+            struct stat info;
+            if (digest == nil || stat([[shardPath stringByAppendingPathComponent:fileName] fileSystemRepresentation], &info) != 0)
+            {
+                continue;
+            }
+            
+            MUKDiskCacheEntry *entry = [[MUKDiskCacheEntry alloc] init];
+            entry.digest = digest;
+            entry.size = (unsigned long long)info.st_size;
+            entry.accessTime = (CFAbsoluteTime)info.st_mtime - kCFAbsoluteTimeIntervalSince1970;
+            [entries addObject:entry];
+        } // for
+    } // for
+    
+    [entries sortUsingComparator:^NSComparisonResult(MUKDiskCacheEntry *entry1, MUKDiskCacheEntry *entry2)
+    {
+        if (entry1.accessTime < entry2.accessTime) return NSOrderedAscending;
+        if (entry1.accessTime > entry2.accessTime) return NSOrderedDescending;
+        return NSOrderedSame;
+    }];
+    
+    for (MUKDiskCacheEntry *entry in entries) {
+        [self insertEntry_:entry];
+    } // for
+}
+
+// Rewrites journal with a put record per entry, from oldest to newest
+- (void)compactJournal_ {
+    NSMutableData *journal = [NSMutableData dataWithCapacity:sizeof(MUKDiskCacheJournalHeader) + [entries_ count] * sizeof(MUKDiskCacheJournalRecord)];
+    
+    MUKDiskCacheJournalHeader header;
+    header.magic = MUK_DISK_CACHE_JOURNAL_MAGIC;
+    header.version = MUK_DISK_CACHE_JOURNAL_VERSION;
+    [journal appendBytes:&header length:sizeof(header)];
+    
+    for (MUKDiskCacheEntry *entry = oldestEntry_; entry; entry = entry.newer) {
+        MUKDiskCacheJournalRecord const record = MUKDiskCacheMakeRecord(MUKDiskCacheOperationPut, entry.digest, entry.size, entry.accessTime);
+        [journal appendBytes:&record length:sizeof(record)];
+    } // for
+    
+    if (journalDescriptor_ >= 0) {
+        close(journalDescriptor_);
+        journalDescriptor_ = -1;
+    }
+    
+    [[NSFileManager defaultManager] createDirectoryAtPath:directoryPath_ withIntermediateDirectories:YES attributes:nil error:nil];
+    
+    // Journal is replaced atomically
+    NSString *journalPath = [self journalPath_];
+    if ([journal writeToFile:journalPath atomically:YES]) {
+        journalDescriptor_ = open([journalPath fileSystemRepresentation], O_WRONLY | O_APPEND);
+    }
+    
+    journalRecordsCount_ = [entries_ count];
+}
+
+- (void)appendRecords_:(MUKDiskCacheJournalRecord const *)records count:(NSUInteger)count
+{
+    if (count == 0) return;
+    
+    if (journalRecordsCount_ + count >= MAX(MUK_DISK_CACHE_MIN_COMPACTION_RECORDS, 2 * [entries_ count]))
+    {
+        // In-memory state already includes these records
+        [self compactJournal_];
+        return;
+    }
+    
+    if (journalDescriptor_ >= 0) {
+        size_t const length = count * sizeof(MUKDiskCacheJournalRecord);
+        if (write(journalDescriptor_, records, length) != (ssize_t)length) {
+            [self compactJournal_];
+            return;
+        }
+    }
+    
+    journalRecordsCount_ += count;
+}
+
+@end
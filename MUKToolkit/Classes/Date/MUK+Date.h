@@ -45,6 +45,47 @@ extern NSCalendarUnit const MUKDateAndTimeCalendarUnits;
             NSDayCalendarUnit|NSHourCalendarUnit|NSMinuteCalendarUnit|
             NSSecondCalendarUnit);
  
+ ## Day keys
+ 
+ A day key is an integer which identifies a day in the time zone of a 
+ calendar: it counts days from 1 January 2001 in that time zone (it is 
+ negative before). Two dates have the same day key if and only if
+ date:isInTheSameDayOfDate:usingCalendar: returns `YES`, so keys are a cheap
+ way to group dates by day (e.g. to build sections of a timeline). The only
+ exception is dates with same year, month and day in different eras, which
+ that method does not tell apart while day keys do.
+ 
+ Batch methods compute keys with arithmetic only: they cache time zone offsets
+ between transitions (e.g. daylight saving time changes) spanned by given
+ dates, and they ask time zone directly only for dates near a transition.
+ 
+ ## Batch normalization
+ 
+ timeIntervals:count:normalizeUsingCalendar:units: normalizes many dates like
+ date:normalizeUsingCalendar:units: does. With Gregorian calendar and common 
+ units (`MUKDateOnlyCalendarUnits`, optionally adding hour, minute and second
+ units) it truncates local time with vectorized arithmetic, using the same
+ offset tables of day keys. Other calendars and units, and dates near a time
+ zone transition, are normalized through `NSDateComponents`.
+ 
+ ## ISO 8601
+ 
+ ISO 8601 methods parse and format timestamps of RFC 3339 profile without
+ `NSDateFormatter`, so they are fast and thread-safe:
+ 
+    2014-05-11T10:20:30.250+02:00
+ 
+ Parsers accept:
+ 
+ * a date (`YYYY-MM-DD`), optionally followed by `T` (or `t`, or a space) and
+ a time (`hh:mm`, optionally followed by `:ss` and a fraction of second 
+ introduced by `.` or `,`);
+ * a time zone designator after the time (`Z`, `z`, `+hh:mm`, `+hhmm` or
+ `+hh`, also with `-`). Timestamps without designator are considered in UTC.
+ 
+ Dates are interpreted in proleptic Gregorian calendar. Leap seconds (`:60`)
+ roll to the next minute. Parsers do not allocate memory.
+ 
  */
 @interface MUK (Date)
 /**
@@ -90,5 +131,89 @@ extern NSCalendarUnit const MUKDateAndTimeCalendarUnits;
  @return YES if `date` has the same year/month/day of `otherDate`.
  */
 + (BOOL)date:(NSDate *)date isInTheSameDayOfDate:(NSDate *)otherDate usingCalendar:(NSCalendar *)calendar;
+/**
+ Day key of a date.
+ @param date Date to inspect.
+ @param calendar Calendar whose time zone is used. If `nil` it uses `[NSCalendar currentCalendar]`.
+ @return Day key of `date`.
+ */
++ (NSInteger)dayKeyOfDate:(NSDate *)date usingCalendar:(NSCalendar *)calendar;
+/**
+ Day keys of many dates.
+ @param dates An array of `NSDate` objects.
+ @param dayKeys A buffer which can contain `[dates count]` keys. Key at index 
+ `i` is the day key of `dates[i]`.
+ @param calendar Calendar whose time zone is used. If `nil` it uses `[NSCalendar currentCalendar]`.
+ */
++ (void)dates:(NSArray *)dates getDayKeys:(NSInteger *)dayKeys usingCalendar:(NSCalendar *)calendar;
+/**
+ Day keys of many dates, expressed as time intervals.
+ @param timeIntervals A buffer of time intervals since reference date (see 
+ `-[NSDate timeIntervalSinceReferenceDate]`).
+ @param count Number of time intervals.
+ @param dayKeys A buffer which can contain `count` keys.
+ @param calendar Calendar whose time zone is used. If `nil` it uses `[NSCalendar currentCalendar]`.
+ */
++ (void)timeIntervals:(NSTimeInterval const *)timeIntervals count:(NSUInteger)count getDayKeys:(NSInteger *)dayKeys usingCalendar:(NSCalendar *)calendar;
+/**
+ Truncate components from many dates, expressed as time intervals.
+ @param timeIntervals A buffer of time intervals since reference date (see 
+ `-[NSDate timeIntervalSinceReferenceDate]`). Every time interval is replaced
+ with its normalized value.
+ @param count Number of time intervals.
+ @param calendar Calendar to use to calculate dates. If `nil` it uses `[NSCalendar currentCalendar]`.
+ @param units A bitmask of `NSNSCalendarUnit` used to extract date components. If
+ you do not specify a unit, it will be truncated.
+ @see date:normalizeUsingCalendar:units:
+ */
++ (void)timeIntervals:(NSTimeInterval *)timeIntervals count:(NSUInteger)count normalizeUsingCalendar:(NSCalendar *)calendar units:(NSCalendarUnit)units;
+
+/**
+ Parses an ISO 8601 timestamp.
+ @param string Timestamp to parse.
+ @return Parsed date or `nil` if `string` is not a valid timestamp.
+ */
++ (NSDate *)dateFromISO8601String:(NSString *)string;
+/**
+ Parses an ISO 8601 timestamp from UTF-8 bytes.
+ @param timeInterval A pointer where parsed time interval since reference date
+ is stored.
+ @param bytes UTF-8 bytes of timestamp, not necessarily `NUL` terminated.
+ @param length Number of bytes to parse.
+ @return `YES` if `bytes` contain a valid timestamp (and nothing else).
+ */
++ (BOOL)getTimeInterval:(NSTimeInterval *)timeInterval fromISO8601Bytes:(char const *)bytes length:(NSUInteger)length;
+/**
+ Parses a column of ISO 8601 timestamps.
+ @param strings An array of timestamps.
+ @param timeIntervals A buffer which can contain `[strings count]` time
+ intervals. Time interval at index `i` is parsed from `strings[i]`: it is `NAN`
+ if that object is not a valid timestamp.
+ @return Number of valid timestamps.
+ */
++ (NSUInteger)ISO8601Strings:(NSArray *)strings getTimeIntervals:(NSTimeInterval *)timeIntervals;
+/**
+ Formats a date as an ISO 8601 timestamp.
+ @param date Date to format.
+ @param timeZone Time zone whose offset is written. If `nil`, date is written
+ in UTC with `Z` designator.
+ @param fractionDigits Digits of fraction of second, up to 6. With `0` 
+ fraction is omitted.
+ @return A timestamp or `nil` if year of `date` is not between 0 and 9999.
+ */
++ (NSString *)ISO8601StringFromDate:(NSDate *)date timeZone:(NSTimeZone *)timeZone fractionDigits:(NSUInteger)fractionDigits;
+/**
+ Formats a date as an ISO 8601 timestamp into a buffer.
+ @param buffer Destination of UTF-8 bytes. No `NUL` terminator is written.
+ @param maxLength Capacity of `buffer`. 32 bytes are always enough.
+ @param timeInterval Time interval since reference date.
+ @param offset Seconds from GMT of written time, truncated to minutes. With `0`
+ time is written in UTC with `Z` designator.
+ @param fractionDigits Digits of fraction of second, up to 6. With `0` 
+ fraction is omitted.
+ @return Number of written bytes or `0` if `buffer` is too short or year is
+ not between 0 and 9999.
+ */
++ (NSUInteger)getISO8601Bytes:(char *)buffer maxLength:(NSUInteger)maxLength fromTimeInterval:(NSTimeInterval)timeInterval timeZoneOffset:(NSInteger)offset fractionDigits:(NSUInteger)fractionDigits;
 
 @end
@@ -24,10 +24,430 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #import "MUK+Date.h"
+#import "MUK+Instrumentation.h"
 
 NSCalendarUnit const MUKDateOnlyCalendarUnits = (NSEraCalendarUnit|NSYearCalendarUnit|NSMonthCalendarUnit|NSDayCalendarUnit|NSCalendarCalendarUnit|NSTimeZoneCalendarUnit);
 NSCalendarUnit const MUKDateAndTimeCalendarUnits = (MUKDateOnlyCalendarUnits|NSDayCalendarUnit|NSHourCalendarUnit|NSMinuteCalendarUnit|NSSecondCalendarUnit);
 
+#define MUK_DATE_SECONDS_PER_DAY        86400.0
+#define MUK_DATE_TRANSITION_MARGIN      3600.0
+#define MUK_DATE_MAX_OFFSET_SPANS       4096
+#define MUK_DATE_NORMALIZATION_CHUNK    256
+
+// 1 January 1 AD (Gregorian), rounded up: components without era are AD
+#define MUK_DATE_FIRST_AD_TIME_INTERVAL -63113904000.0
+
+// NSTimeIntervalSince1970, as an integer
+#define MUK_DATE_UNIX_REFERENCE_OFFSET  978307200LL
+#define MUK_DATE_MAX_FRACTION_DIGITS    6
+#define MUK_DATE_ISO8601_MAX_LENGTH     64
+
+#pragma mark - Offset Tables
+
+// A span of time where time zone has a constant offset from GMT
+typedef struct {
+    NSTimeInterval start, end;
+    NSInteger offset;
+    BOOL reliable;
+} MUKDateOffsetSpan;
+
+typedef struct {
+    __unsafe_unretained NSTimeZone *timeZone;
+    MUKDateOffsetSpan *spans;
+    NSUInteger count;
+    NSUInteger lastIndex;
+} MUKDateOffsetTable;
+
+// Collects offsets between transitions in [minimum, maximum]
+static void MUKDateOffsetTableBuild(MUKDateOffsetTable *table, NSTimeZone *timeZone, NSTimeInterval minimum, NSTimeInterval maximum)
+{
+    table->timeZone = timeZone;
+    table->spans = NULL;
+    table->count = 0;
+    table->lastIndex = 0;
+    
+    if (!(minimum <= maximum) || isinf(minimum) || isinf(maximum)) return;
+    
+    NSUInteger capacity = 16;
+    table->spans = malloc(capacity * sizeof(MUKDateOffsetSpan));
+    
+    NSTimeInterval start = minimum;
+    while (table->count < MUK_DATE_MAX_OFFSET_SPANS) {
+        NSDate *startDate = [NSDate dateWithTimeIntervalSinceReferenceDate:start];
+        NSDate *transitionDate = [timeZone nextDaylightSavingTimeTransitionAfterDate:startDate];
+        NSTimeInterval end = (transitionDate ? [transitionDate timeIntervalSinceReferenceDate] : INFINITY);
+        BOOL const lastSpan = (!(end > start) || end > maximum);
+        
+        if (lastSpan) end = INFINITY;
+        
+        // Transitions which are not about daylight saving time could be
+        // missed: do not trust spans whose offset changes inside
+        NSInteger const offset = [timeZone secondsFromGMTForDate:startDate];
+        NSTimeInterval const probe = (lastSpan ? maximum : end - 1.0);
+        BOOL const reliable = ([timeZone secondsFromGMTForDate:[NSDate dateWithTimeIntervalSinceReferenceDate:probe]] == offset);
+        
+        if (table->count == capacity) {
+            capacity *= 2;
+            table->spans = realloc(table->spans, capacity * sizeof(MUKDateOffsetSpan));
+        }
+        
+        MUKDateOffsetSpan *span = &table->spans[table->count++];
+        span->start = (table->count == 1 ? -INFINITY : start);
+        span->end = end;
+        span->offset = offset;
+        span->reliable = reliable;
+        
+        if (lastSpan) break;
+        start = end;
+    } // while
+}
+
+static void MUKDateOffsetTableDestroy(MUKDateOffsetTable *table) {
+    free(table->spans);
+    table->spans = NULL;
+    table->count = 0;
+}
+
+// Span of time interval, if it can be trusted far enough from transitions
+static MUKDateOffsetSpan const *MUKDateOffsetTableReliableSpan(MUKDateOffsetTable *table, NSTimeInterval timeInterval)
+{
+    NSUInteger index = table->lastIndex;
+    
+    if (index >= table->count || timeInterval < table->spans[index].start || timeInterval >= table->spans[index].end)
+    {
+        // Last span which starts before time interval
+        NSUInteger low = 0, high = table->count;
+        while (low < high) {
+            NSUInteger const middle = (low + high) / 2;
+            if (table->spans[middle].start <= timeInterval) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        } // while
+        
+        index = low - 1;
+    }
+    
+    if (index < table->count) {
+        MUKDateOffsetSpan const *span = &table->spans[index];
+        table->lastIndex = index;
+        
+        if (span->reliable &&
+            timeInterval - span->start >= MUK_DATE_TRANSITION_MARGIN &&
+            span->end - timeInterval > MUK_DATE_TRANSITION_MARGIN)
+        {
+            return span;
+        }
+    }
+    
+    return NULL;
+}
+
+static NSInteger MUKDateOffsetTableLookup(MUKDateOffsetTable *table, NSTimeInterval timeInterval)
+{
+    MUKDateOffsetSpan const *span = MUKDateOffsetTableReliableSpan(table, timeInterval);
+    if (span) return span->offset;
+    
+    // Near a transition (or out of table): ask time zone
+    return [table->timeZone secondsFromGMTForDate:[NSDate dateWithTimeIntervalSinceReferenceDate:timeInterval]];
+}
+
+NS_INLINE NSInteger MUKDateDayKey(NSTimeInterval timeInterval, NSInteger offset) {
+    return (NSInteger)floor((timeInterval + (NSTimeInterval)offset) / MUK_DATE_SECONDS_PER_DAY);
+}
+
+// Length of unit which normalization truncates to, or 0 if computation
+// needs a calendar
+static NSTimeInterval MUKDateNormalizationUnitLength(NSCalendar *calendar, NSCalendarUnit units)
+{
+    if (![[calendar calendarIdentifier] isEqualToString:NSGregorianCalendar]) {
+        return 0.0;
+    }
+    
+    NSCalendarUnit const dateUnits = (NSYearCalendarUnit|NSMonthCalendarUnit|NSDayCalendarUnit);
+    NSCalendarUnit const ignoredUnits = (NSEraCalendarUnit|NSCalendarCalendarUnit|NSTimeZoneCalendarUnit);
+    
+    if ((units & dateUnits) != dateUnits) return 0.0;
+    
+    switch (units & ~(dateUnits|ignoredUnits)) {
+        case 0:
+            return MUK_DATE_SECONDS_PER_DAY;
+        
+        case NSHourCalendarUnit:
+            return 3600.0;
+        
+        case (NSHourCalendarUnit|NSMinuteCalendarUnit):
+            return 60.0;
+        
+        case (NSHourCalendarUnit|NSMinuteCalendarUnit|NSSecondCalendarUnit):
+            return 1.0;
+        
+        default:
+            return 0.0;
+    }
+}
+
+#pragma mark - ISO 8601
+
+// Days from 1 January 1970 in proleptic Gregorian calendar
+static int64_t MUKDateDaysFromCivil(int64_t year, int month, int day) {
+    year -= (month <= 2);
+    int64_t const era = (year >= 0 ? year : year - 399) / 400;
+    int64_t const yearOfEra = year - era * 400;
+    int64_t const dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int64_t const dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+static void MUKDateCivilFromDays(int64_t days, int64_t *year, int *month, int *day)
+{
+    days += 719468;
+    int64_t const era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t const dayOfEra = days - era * 146097;
+    int64_t const yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t const dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t const shiftedMonth = (5 * dayOfYear + 2) / 153;
+    
+    *day = (int)(dayOfYear - (153 * shiftedMonth + 2) / 5 + 1);
+    *month = (int)(shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9);
+    *year = yearOfEra + era * 400 + (*month <= 2);
+}
+
+NS_INLINE BOOL MUKDateIsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Reads exactly count digits
+static BOOL MUKDateReadDigits(char const **cursor, char const *end, int count, int *value)
+{
+    char const *p = *cursor;
+    if (end - p < count) return NO;
+    
+    int result = 0;
+    for (int i = 0; i < count; i++) {
+        if (!MUKDateIsDigit(p[i])) return NO;
+        result = result * 10 + (p[i] - '0');
+    } // for
+    
+    *value = result;
+    *cursor = p + count;
+    return YES;
+}
+
+NS_INLINE BOOL MUKDateReadCharacter(char const **cursor, char const *end, char c) {
+    if (*cursor < end && **cursor == c) {
+        (*cursor)++;
+        return YES;
+    }
+    
+    return NO;
+}
+
+// Parses YYYY-MM-DD[Thh:mm[:ss[.fff]][Z|+hh:mm|+hhmm|+hh]] into seconds
+// from reference date. Missing time zone means UTC.
+static BOOL MUKDateParseISO8601(char const *bytes, size_t length, NSTimeInterval *timeInterval)
+{
+    char const *p = bytes, *end = bytes + length;
+    int year, month, day, hour = 0, minute = 0, second = 0;
+    double fraction = 0.0;
+    int offset = 0;
+    
+    // Date
+    if (!MUKDateReadDigits(&p, end, 4, &year) ||
+        !MUKDateReadCharacter(&p, end, '-') ||
+        !MUKDateReadDigits(&p, end, 2, &month) ||
+        !MUKDateReadCharacter(&p, end, '-') ||
+        !MUKDateReadDigits(&p, end, 2, &day))
+    {
+        return NO;
+    }
+    
+    if (month < 1 || month > 12 || day < 1) return NO;
+    
+    static int const daysInMonth[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    BOOL const leapYear = ((year % 4 == 0 && year % 100 != 0) || year % 400 == 0);
+    if (day > daysInMonth[month - 1] + (month == 2 && leapYear)) return NO;
+    
+    // Time
+    if (p < end && (*p == 'T' || *p == 't' || *p == ' ')) {
+        p++;
+        
+        if (!MUKDateReadDigits(&p, end, 2, &hour) ||
+            !MUKDateReadCharacter(&p, end, ':') ||
+            !MUKDateReadDigits(&p, end, 2, &minute))
+        {
+            return NO;
+        }
+        
+        if (MUKDateReadCharacter(&p, end, ':')) {
+            if (!MUKDateReadDigits(&p, end, 2, &second)) return NO;
+            
+            if (p < end && (*p == '.' || *p == ',')) {
+                p++;
+                
+                // Digits beyond double precision are validated but ignored
+                int64_t numerator = 0, denominator = 1;
+                char const *fractionStart = p;
+                
+                for (; p < end && MUKDateIsDigit(*p); p++) {
+                    if (denominator < 1000000000000000LL) {
+                        numerator = numerator * 10 + (*p - '0');
+                        denominator *= 10;
+                    }
+                } // for
+                
+                if (p == fractionStart) return NO;
+                fraction = (double)numerator / (double)denominator;
+            }
+        }
+        
+        // Allow leap second 60, which rolls to next minute
+        if (hour > 23 || minute > 59 || second > 60) return NO;
+        
+        // Time zone
+        if (p < end) {
+            if (*p == 'Z' || *p == 'z') {
+                p++;
+            }
+            else if (*p == '+' || *p == '-') {
+                int const sign = (*p == '-' ? -1 : 1);
+                int offsetHours, offsetMinutes = 0;
+                p++;
+                
+                if (!MUKDateReadDigits(&p, end, 2, &offsetHours)) return NO;
+                
+                if (MUKDateReadCharacter(&p, end, ':')) {
+                    if (!MUKDateReadDigits(&p, end, 2, &offsetMinutes)) return NO;
+                }
+                else if (end - p >= 2 && MUKDateIsDigit(*p)) {
+                    if (!MUKDateReadDigits(&p, end, 2, &offsetMinutes)) return NO;
+                }
+                
+                if (offsetHours > 23 || offsetMinutes > 59) return NO;
+                offset = sign * (offsetHours * 3600 + offsetMinutes * 60);
+            }
+        }
+    }
+    
+    if (p != end) return NO;
+    
+    int64_t const seconds = MUKDateDaysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offset - MUK_DATE_UNIX_REFERENCE_OFFSET;
+    *timeInterval = (NSTimeInterval)seconds + fraction;
+    return YES;
+}
+
+NS_INLINE char *MUKDateWriteDigits(char *p, int64_t value, int count) {
+    for (int i = count - 1; i >= 0; i--) {
+        p[i] = (char)('0' + value % 10);
+        value /= 10;
+    } // for
+    
+    return p + count;
+}
+
+// Writes YYYY-MM-DDThh:mm:ss[.fff](Z|+hh:mm), without terminator. Returns
+// written length or 0 if buffer is too short or year is out of [0, 9999].
+static size_t MUKDateFormatISO8601(NSTimeInterval timeInterval, NSInteger offset, NSUInteger fractionDigits, char *buffer, size_t capacity)
+{
+    if (fractionDigits > MUK_DATE_MAX_FRACTION_DIGITS) {
+        fractionDigits = MUK_DATE_MAX_FRACTION_DIGITS;
+    }
+    
+    // Offsets are written in minutes: keep the same instant
+    offset -= offset % 60;
+    
+    size_t const length = 19 + (fractionDigits > 0 ? fractionDigits + 1 : 0) + (offset == 0 ? 1 : 6);
+    if (capacity < length || isnan(timeInterval) || isinf(timeInterval)) return 0;
+    
+    // Round to requested digits
+    int64_t scale = 1;
+    for (NSUInteger i = 0; i < fractionDigits; i++) {
+        scale *= 10;
+    } // for
+    
+    double const localTime = timeInterval + (double)MUK_DATE_UNIX_REFERENCE_OFFSET + (double)offset;
+    double wholeSeconds = floor(localTime);
+    int64_t scaledFraction = (int64_t)llround((localTime - wholeSeconds) * (double)scale);
+    
+    if (scaledFraction >= scale) {
+        wholeSeconds += 1.0;
+        scaledFraction -= scale;
+    }
+    
+    if (fabs(wholeSeconds) > 1.0e15) return 0;
+    
+    int64_t const seconds = (int64_t)wholeSeconds;
+    int64_t days = seconds / 86400, secondOfDay = seconds % 86400;
+    if (secondOfDay < 0) {
+        secondOfDay += 86400;
+        days--;
+    }
+    
+    int64_t year;
+    int month, day;
+    MUKDateCivilFromDays(days, &year, &month, &day);
+    if (year < 0 || year > 9999) return 0;
+    
+    char *p = buffer;
+    p = MUKDateWriteDigits(p, year, 4);
+    *p++ = '-';
+    p = MUKDateWriteDigits(p, month, 2);
+    *p++ = '-';
+    p = MUKDateWriteDigits(p, day, 2);
+    *p++ = 'T';
+    p = MUKDateWriteDigits(p, secondOfDay / 3600, 2);
+    *p++ = ':';
+    p = MUKDateWriteDigits(p, (secondOfDay / 60) % 60, 2);
+    *p++ = ':';
+    p = MUKDateWriteDigits(p, secondOfDay % 60, 2);
+    
+    if (fractionDigits > 0) {
+        *p++ = '.';
+        p = MUKDateWriteDigits(p, scaledFraction, (int)fractionDigits);
+    }
+    
+    if (offset == 0) {
+        *p++ = 'Z';
+    }
+    else {
+        NSInteger const absoluteOffset = (offset < 0 ? -offset : offset);
+        *p++ = (offset < 0 ? '-' : '+');
+        p = MUKDateWriteDigits(p, absoluteOffset / 3600, 2);
+        *p++ = ':';
+        p = MUKDateWriteDigits(p, (absoluteOffset / 60) % 60, 2);
+    }
+    
+    return (size_t)(p - buffer);
+}
+
+static BOOL MUKDateParseISO8601String(NSString *string, NSTimeInterval *timeInterval)
+{
+    if (![string isKindOfClass:[NSString class]]) return NO;
+    
+    CFStringRef const cfString = (__bridge CFStringRef)string;
+    char const *cString = CFStringGetCStringPtr(cfString, kCFStringEncodingUTF8);
+    
+    if (cString) {
+        return MUKDateParseISO8601(cString, strlen(cString), timeInterval);
+    }
+    
+    // Copy to stack: valid timestamps are short and ASCII only
+    char buffer[MUK_DATE_ISO8601_MAX_LENGTH];
+    CFIndex const length = CFStringGetLength(cfString);
+    CFIndex usedLength = 0;
+    
+    if (length > MUK_DATE_ISO8601_MAX_LENGTH) return NO;
+    
+    CFIndex const convertedLength = CFStringGetBytes(cfString, CFRangeMake(0, length), kCFStringEncodingASCII, 0, false, (UInt8 *)buffer, MUK_DATE_ISO8601_MAX_LENGTH, &usedLength);
+    if (convertedLength != length) return NO;
+    
+    return MUKDateParseISO8601(buffer, (size_t)usedLength, timeInterval);
+}
+
+#pragma mark -
+
 @implementation MUK (Date)
 
 + (NSDate *)date:(NSDate *)date normalizeUsingCalendar:(NSCalendar *)calendar units:(NSCalendarUnit)units
@@ -37,6 +457,7 @@ NSCalendarUnit const MUKDateAndTimeCalendarUnits = (MUKDateOnlyCalendarUnits|NSD
 
 + (NSDate *)date:(NSDate *)date transformUsingCalendar:(NSCalendar *)calendar units:(NSCalendarUnit)units withBlock:(NSDateComponents *(^)(NSDateComponents *))block
 {
+    MUK_INSTRUMENT(0);
     if (!calendar) calendar = [NSCalendar currentCalendar];
     NSDateComponents *components = [calendar components:units fromDate:date];
     
@@ -63,6 +484,7 @@ NSCalendarUnit const MUKDateAndTimeCalendarUnits = (MUKDateOnlyCalendarUnits|NSD
 
 + (BOOL)date:(NSDate *)date isInTheSameDayOfDate:(NSDate *)otherDate usingCalendar:(NSCalendar *)calendar
 {
+    MUK_INSTRUMENT(0);
     if (!calendar) calendar = [NSCalendar currentCalendar];
     
     NSDateComponents *components1 = [calendar components:MUKDateOnlyCalendarUnits fromDate:date];
@@ -73,4 +495,176 @@ NSCalendarUnit const MUKDateAndTimeCalendarUnits = (MUKDateOnlyCalendarUnits|NSD
             components1.day == components2.day);
 }
 
++ (NSInteger)dayKeyOfDate:(NSDate *)date usingCalendar:(NSCalendar *)calendar
+{
+    if (!calendar) calendar = [NSCalendar currentCalendar];
+    
+    NSInteger const offset = [calendar.timeZone secondsFromGMTForDate:date];
+    return MUKDateDayKey([date timeIntervalSinceReferenceDate], offset);
+}
+
++ (void)dates:(NSArray *)dates getDayKeys:(NSInteger *)dayKeys usingCalendar:(NSCalendar *)calendar
+{
+    NSUInteger const count = [dates count];
+    if (count == 0 || dayKeys == NULL) return;
+    
+    NSTimeInterval *timeIntervals = malloc(count * sizeof(NSTimeInterval));
+    NSUInteger i = 0;
+    
+    for (NSDate *date in dates) {
+        timeIntervals[i++] = [date timeIntervalSinceReferenceDate];
+    } // for
+    
+    [self timeIntervals:timeIntervals count:count getDayKeys:dayKeys usingCalendar:calendar];
+    free(timeIntervals);
+}
+
++ (void)timeIntervals:(NSTimeInterval const *)timeIntervals count:(NSUInteger)count getDayKeys:(NSInteger *)dayKeys usingCalendar:(NSCalendar *)calendar
+{
+    MUK_INSTRUMENT(count * sizeof(NSTimeInterval));
+    if (count == 0 || timeIntervals == NULL || dayKeys == NULL) return;
+    if (!calendar) calendar = [NSCalendar currentCalendar];
+    
+    NSTimeInterval minimum = timeIntervals[0], maximum = timeIntervals[0];
+    for (NSUInteger i = 1; i < count; i++) {
+        minimum = MIN(minimum, timeIntervals[i]);
+        maximum = MAX(maximum, timeIntervals[i]);
+    } // for
+    
+    MUKDateOffsetTable table;
+    MUKDateOffsetTableBuild(&table, calendar.timeZone, minimum, maximum);
+    
+    for (NSUInteger i = 0; i < count; i++) {
+        NSInteger const offset = MUKDateOffsetTableLookup(&table, timeIntervals[i]);
+        dayKeys[i] = MUKDateDayKey(timeIntervals[i], offset);
+    } // for
+    
+    MUKDateOffsetTableDestroy(&table);
+}
+
++ (void)timeIntervals:(NSTimeInterval *)timeIntervals count:(NSUInteger)count normalizeUsingCalendar:(NSCalendar *)calendar units:(NSCalendarUnit)units
+{
+    MUK_INSTRUMENT(count * sizeof(NSTimeInterval));
+    if (count == 0 || timeIntervals == NULL) return;
+    if (!calendar) calendar = [NSCalendar currentCalendar];
+    
+    NSTimeInterval const unitLength = MUKDateNormalizationUnitLength(calendar, units);
+    
+    if (unitLength <= 0.0) {
+        // Irregular calendar or units: go through components
+        for (NSUInteger i = 0; i < count; i++) {
+            NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:timeIntervals[i]];
+            timeIntervals[i] = [[self date:date normalizeUsingCalendar:calendar units:units] timeIntervalSinceReferenceDate];
+        } // for
+        
+        return;
+    }
+    
+    NSTimeInterval minimum = timeIntervals[0], maximum = timeIntervals[0];
+    for (NSUInteger i = 1; i < count; i++) {
+        minimum = MIN(minimum, timeIntervals[i]);
+        maximum = MAX(maximum, timeIntervals[i]);
+    } // for
+    
+    // Normalized dates come before originals, by less than a day
+    MUKDateOffsetTable table;
+    MUKDateOffsetTableBuild(&table, calendar.timeZone, minimum - MUK_DATE_SECONDS_PER_DAY, maximum);
+    
+    NSTimeInterval const eraBound = ((units & NSEraCalendarUnit) ? -INFINITY : MUK_DATE_FIRST_AD_TIME_INTERVAL);
+    NSTimeInterval offsets[MUK_DATE_NORMALIZATION_CHUNK];
+    NSTimeInterval lowerBounds[MUK_DATE_NORMALIZATION_CHUNK];
+    
+    for (NSUInteger chunkStart = 0; chunkStart < count; chunkStart += MUK_DATE_NORMALIZATION_CHUNK)
+    {
+        NSUInteger const chunkCount = MIN((NSUInteger)MUK_DATE_NORMALIZATION_CHUNK, count - chunkStart);
+        NSTimeInterval *values = timeIntervals + chunkStart;
+        
+        // Offsets of spans, and lowest normalized value which stays into
+        // the same span of original value
+        for (NSUInteger i = 0; i < chunkCount; i++) {
+            MUKDateOffsetSpan const *span = MUKDateOffsetTableReliableSpan(&table, values[i]);
+            offsets[i] = (span ? (NSTimeInterval)span->offset : NAN);
+            lowerBounds[i] = (span ? MAX(span->start + MUK_DATE_TRANSITION_MARGIN, eraBound) : INFINITY);
+        } // for
+        
+        // Keep this loop free of calls, so it is vectorized
+        NSTimeInterval normalizedValues[MUK_DATE_NORMALIZATION_CHUNK];
+        for (NSUInteger i = 0; i < chunkCount; i++) {
+            normalizedValues[i] = floor((values[i] + offsets[i]) / unitLength) * unitLength - offsets[i];
+        } // for
+        
+        for (NSUInteger i = 0; i < chunkCount; i++) {
+            if (normalizedValues[i] >= lowerBounds[i]) {
+                values[i] = normalizedValues[i];
+            }
+            else {
+                // Close to a transition: ask calendar
+                NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:values[i]];
+                values[i] = [[self date:date normalizeUsingCalendar:calendar units:units] timeIntervalSinceReferenceDate];
+            }
+        } // for
+    } // for
+    
+    MUKDateOffsetTableDestroy(&table);
+}
+
+#pragma mark - ISO 8601
+
++ (NSDate *)dateFromISO8601String:(NSString *)string {
+    MUK_INSTRUMENT([string length]);
+    NSTimeInterval timeInterval;
+    
+    if (MUKDateParseISO8601String(string, &timeInterval)) {
+        return [NSDate dateWithTimeIntervalSinceReferenceDate:timeInterval];
+    }
+    
+    return nil;
+}
+
++ (BOOL)getTimeInterval:(NSTimeInterval *)timeInterval fromISO8601Bytes:(char const *)bytes length:(NSUInteger)length
+{
+    if (bytes == NULL || timeInterval == NULL) return NO;
+    return MUKDateParseISO8601(bytes, length, timeInterval);
+}
+
++ (NSUInteger)ISO8601Strings:(NSArray *)strings getTimeIntervals:(NSTimeInterval *)timeIntervals
+{
+    MUK_INSTRUMENT([strings count] * sizeof(NSTimeInterval));
+    if (timeIntervals == NULL) return 0;
+    
+    NSUInteger parsedCount = 0, i = 0;
+    for (NSString *string in strings) {
+        if (MUKDateParseISO8601String(string, &timeIntervals[i])) {
+            parsedCount++;
+        }
+        else {
+            timeIntervals[i] = NAN;
+        }
+        
+        i++;
+    } // for
+    
+    return parsedCount;
+}
+
++ (NSString *)ISO8601StringFromDate:(NSDate *)date timeZone:(NSTimeZone *)timeZone fractionDigits:(NSUInteger)fractionDigits
+{
+    MUK_INSTRUMENT(0);
+    if (date == nil) return nil;
+    
+    NSInteger const offset = (timeZone ? [timeZone secondsFromGMTForDate:date] : 0);
+    char buffer[MUK_DATE_ISO8601_MAX_LENGTH];
+    
+    size_t const length = MUKDateFormatISO8601([date timeIntervalSinceReferenceDate], offset, fractionDigits, buffer, sizeof(buffer));
+    if (length == 0) return nil;
+    
+    return [[NSString alloc] initWithBytes:buffer length:length encoding:NSASCIIStringEncoding];
+}
+
++ (NSUInteger)getISO8601Bytes:(char *)buffer maxLength:(NSUInteger)maxLength fromTimeInterval:(NSTimeInterval)timeInterval timeZoneOffset:(NSInteger)offset fractionDigits:(NSUInteger)fractionDigits
+{
+    if (buffer == NULL) return 0;
+    return MUKDateFormatISO8601(timeInterval, offset, fractionDigits, buffer, maxLength);
+}
+
 @end
@@ -24,6 +24,7 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #import "MUK.h"
+#import <CoreGraphics/CoreGraphics.h>
 
 
 typedef enum : NSUInteger {
@@ -111,12 +112,23 @@ typedef enum : NSUInteger {
  * `MUKGeometryTransformBottomRight`, it aligns rect bottom-right respect 
  to base rect, without changing its size.
  
+ ## Inline functions
+ 
+ Every method has an inline C counterpart declared in this header
+ (`MUKGeometricRoundingOfValue()`, `MUKPointGeometricRounding()`, 
+ `MUKSizeGeometricRounding()`, `MUKRectGeometricRounding()` and
+ `MUKRectTransform()`). They are meant for tight layout loops: they skip
+ message dispatch and, when dimensions or transform are compile-time constants,
+ the compiler folds away every branch which is not taken.
+ Methods in this category are thin wrappers around those functions.
+ 
  */
 @interface MUK (Geometry)
 /**
  Rounds a float value for geometric representation.
  @param value Value to round.
- @return Result of `roundf()` to `value`, or `0.0` if `value` is *NaN*.
+ @return Result of `round()` (or `roundf()` where `CGFloat` is `float`) to
+ `value`, or `0.0` if `value` is *NaN*.
  */
 + (CGFloat)geometricRoundingOfValue:(CGFloat)value;
 /**
@@ -155,3 +167,153 @@ typedef enum : NSUInteger {
 + (CGRect)rect:(CGRect)rect transform:(MUKGeometryTransform)transform respectToRect:(CGRect)baseRect;
 
 @end
+
+#pragma mark - Inline Functions
+
+/**
+ Inline counterpart of geometricRoundingOfValue:.
+ It rounds with `round()` or `roundf()` depending on `CGFloat` width.
+ */
+NS_INLINE CGFloat MUKGeometricRoundingOfValue(CGFloat value) {
+    if (isnan(value)) {
+        return 0.0;
+    }
+    
+#if CGFLOAT_IS_DOUBLE
+    return round(value);
+#else
+    return roundf(value);
+#endif
+}
+
+/**
+ Inline counterpart of point:geometricRoundingOfDimensions:.
+ */
+NS_INLINE CGPoint MUKPointGeometricRounding(CGPoint point, MUKGeometricDimension dimensions)
+{
+    if (MUKBitmaskContainsFlag(dimensions, MUKGeometricDimensionX)) {
+        point.x = MUKGeometricRoundingOfValue(point.x);
+    }
+    
+    if (MUKBitmaskContainsFlag(dimensions, MUKGeometricDimensionY)) {
+        point.y = MUKGeometricRoundingOfValue(point.y);
+    }
+    
+    return point;
+}
+
+/**
+ Inline counterpart of size:geometricRoundingOfDimensions:.
+ */
+NS_INLINE CGSize MUKSizeGeometricRounding(CGSize size, MUKGeometricDimension dimensions)
+{
+    if (MUKBitmaskContainsFlag(dimensions, MUKGeometricDimensionWidth)) {
+        size.width = MUKGeometricRoundingOfValue(size.width);
+    }
+    
+    if (MUKBitmaskContainsFlag(dimensions, MUKGeometricDimensionHeight)) {
+        size.height = MUKGeometricRoundingOfValue(size.height);
+    }
+    
+    return size;
+}
+
+/**
+ Inline counterpart of rect:geometricRoundingOfDimensions:.
+ */
+NS_INLINE CGRect MUKRectGeometricRounding(CGRect rect, MUKGeometricDimension dimensions)
+{
+    rect.origin = MUKPointGeometricRounding(rect.origin, dimensions);
+    rect.size = MUKSizeGeometricRounding(rect.size, dimensions);
+    return rect;
+}
+
+/**
+ Inline counterpart of rect:transform:respectToRect:.
+ */
+NS_INLINE CGRect MUKRectTransform(CGRect rect, MUKGeometryTransform transform, CGRect baseRect)
+{
+    CGRect transformedRect = rect;
+    
+    switch (transform) {
+        case MUKGeometryTransformScaleToFill:
+            transformedRect = baseRect;
+            break;
+            
+        case MUKGeometryTransformScaleAspectFit:
+        case MUKGeometryTransformScaleAspectFill: {
+            CGFloat originalAspectRatio = rect.size.width / rect.size.height;
+            CGFloat containerAspectRatio = baseRect.size.width / baseRect.size.height;
+            
+            // Fit scales by width when rect is wider than container, fill does
+            // the opposite
+            BOOL scaleByWidth = (originalAspectRatio > containerAspectRatio);
+            if (transform == MUKGeometryTransformScaleAspectFill) {
+                scaleByWidth = !scaleByWidth;
+            }
+            
+            if (scaleByWidth) {
+                transformedRect.size.width = baseRect.size.width;
+                transformedRect.size.height = transformedRect.size.width * ((CGFloat)1.0/originalAspectRatio);
+            }
+            else {
+                transformedRect.size.height = baseRect.size.height;
+                transformedRect.size.width = transformedRect.size.height * originalAspectRatio;
+            }
+            
+            transformedRect.origin.x = (baseRect.size.width - transformedRect.size.width)/(CGFloat)2.0 + baseRect.origin.x;
+            transformedRect.origin.y = (baseRect.size.height - transformedRect.size.height)/(CGFloat)2.0 + baseRect.origin.y;
+            break;
+        }
+            
+        case MUKGeometryTransformCenter:
+            transformedRect.origin.x = (baseRect.size.width - rect.size.width)/(CGFloat)2.0 + baseRect.origin.x;
+            transformedRect.origin.y = (baseRect.size.height - rect.size.height)/(CGFloat)2.0 + baseRect.origin.y;
+            break;
+            
+        case MUKGeometryTransformTop:
+            transformedRect.origin.x = (baseRect.size.width - rect.size.width)/(CGFloat)2.0 + baseRect.origin.x;
+            transformedRect.origin.y = baseRect.origin.y;
+            break;
+            
+        case MUKGeometryTransformBottom:
+            transformedRect.origin.x = (baseRect.size.width - rect.size.width)/(CGFloat)2.0 + baseRect.origin.x;
+            transformedRect.origin.y = baseRect.origin.y - (rect.size.height - baseRect.size.height);
+            break;
+            
+        case MUKGeometryTransformLeft:
+            transformedRect.origin.x = baseRect.origin.x;
+            transformedRect.origin.y = (baseRect.size.height - rect.size.height)/(CGFloat)2.0 + baseRect.origin.y;
+            break;
+            
+        case MUKGeometryTransformRight:
+            transformedRect.origin.x = baseRect.origin.x - (rect.size.width - baseRect.size.width);
+            transformedRect.origin.y = (baseRect.size.height - rect.size.height)/(CGFloat)2.0 + baseRect.origin.y;
+            break;
+            
+        case MUKGeometryTransformTopLeft:
+            transformedRect.origin.x = baseRect.origin.x;
+            transformedRect.origin.y = baseRect.origin.y;
+            break;
+            
+        case MUKGeometryTransformTopRight:
+            transformedRect.origin.x = baseRect.origin.x - (rect.size.width - baseRect.size.width);
+            transformedRect.origin.y = baseRect.origin.y;
+            break;
+            
+        case MUKGeometryTransformBottomLeft:
+            transformedRect.origin.x = baseRect.origin.x;
+            transformedRect.origin.y = baseRect.origin.y - (rect.size.height - baseRect.size.height);
+            break;
+            
+        case MUKGeometryTransformBottomRight:
+            transformedRect.origin.x = baseRect.origin.x - (rect.size.width - baseRect.size.width);
+            transformedRect.origin.y = baseRect.origin.y - (rect.size.height - baseRect.size.height);
+            break;
+            
+        default:
+            break;
+    }
+    
+    return transformedRect;
+}
@@ -24,175 +24,34 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #import "MUK+Geometry.h"
+#import "MUK+Instrumentation.h"
 
 @implementation MUK (Geometry)
 
 + (CGFloat)geometricRoundingOfValue:(CGFloat)value {
-    if (isnan(value)) {
-        return 0.0;
-    }
-    
-    return roundf(value);
+    return MUKGeometricRoundingOfValue(value);
 }
 
 + (CGPoint)point:(CGPoint)point geometricRoundingOfDimensions:(MUKGeometricDimension)dimensions
 {
-    CGPoint roundedPoint = point;
-    
-    if ([self bitmask:dimensions containsFlag:MUKGeometricDimensionX]) {
-        roundedPoint.x = [self geometricRoundingOfValue:point.x];
-    }
-    
-    if ([self bitmask:dimensions containsFlag:MUKGeometricDimensionY]) {
-        roundedPoint.y = [self geometricRoundingOfValue:point.y];
-    }
-    
-    return roundedPoint;
+    return MUKPointGeometricRounding(point, dimensions);
 }
 
 + (CGSize)size:(CGSize)size geometricRoundingOfDimensions:(MUKGeometricDimension)dimensions 
 {
-    CGSize roundedSize = size;
-    
-    if ([self bitmask:dimensions containsFlag:MUKGeometricDimensionWidth]) {
-        roundedSize.width = [self geometricRoundingOfValue:size.width];
-    }
-    
-    if ([self bitmask:dimensions containsFlag:MUKGeometricDimensionHeight]) {
-        roundedSize.height = [self geometricRoundingOfValue:size.height];
-    }
-    
-    return roundedSize;
+    return MUKSizeGeometricRounding(size, dimensions);
 }
 
 + (CGRect)rect:(CGRect)rect geometricRoundingOfDimensions:(MUKGeometricDimension)dimensions
 {
-    CGRect roundedRect = rect;
-    
-    roundedRect.origin = [self point:rect.origin geometricRoundingOfDimensions:dimensions];
-    roundedRect.size = [self size:rect.size geometricRoundingOfDimensions:dimensions];
-    
-    return roundedRect;
+    MUK_INSTRUMENT(0);
+    return MUKRectGeometricRounding(rect, dimensions);
 }
 
 + (CGRect)rect:(CGRect)rect transform:(MUKGeometryTransform)transform respectToRect:(CGRect)baseRect
 {
-    CGRect transformedRect = rect;
-    
-    switch (transform) {
-        case MUKGeometryTransformScaleToFill: {
-            transformedRect = baseRect;
-            break;
-        }
-            
-        case MUKGeometryTransformScaleAspectFit: {
-            float originalAspectRatio = rect.size.width / rect.size.height;
-            float containerAspectRatio = baseRect.size.width / baseRect.size.height;
-            
-            CGRect scaledRect = rect;
-            if (originalAspectRatio > containerAspectRatio) {
-                // Scale by width
-                scaledRect.size.width = baseRect.size.width;
-                scaledRect.size.height = scaledRect.size.width * (1.0/originalAspectRatio);
-            } 
-            else {
-                // Scale by height
-                scaledRect.size.height = baseRect.size.height;
-                scaledRect.size.width = scaledRect.size.height * originalAspectRatio;
-            }
-            
-            transformedRect = [MUK rect:scaledRect transform:MUKGeometryTransformCenter respectToRect:baseRect];
-            break;
-        }
-            
-        case MUKGeometryTransformScaleAspectFill: {
-            float originalAspectRatio = rect.size.width / rect.size.height;
-            float containerAspectRatio = baseRect.size.width / baseRect.size.height;
-            
-            CGRect scaledRect = rect;
-            if (originalAspectRatio > containerAspectRatio) {
-                // Scale by height
-                scaledRect.size.height = baseRect.size.height;
-                scaledRect.size.width = scaledRect.size.height * originalAspectRatio;
-            } 
-            else {
-                // Scale by width
-                scaledRect.size.width = baseRect.size.width;
-                scaledRect.size.height = scaledRect.size.width * (1.0/originalAspectRatio);
-            }
-            
-            transformedRect = [MUK rect:scaledRect transform:MUKGeometryTransformCenter respectToRect:baseRect];
-            break;
-        }
-            
-        case MUKGeometryTransformCenter: {
-            transformedRect.origin.x = (baseRect.size.width - rect.size.width)/2.0 + baseRect.origin.x;
-            transformedRect.origin.y = (baseRect.size.height - rect.size.height)/2.0 + baseRect.origin.y;
-            
-            break;
-        }
-            
-        case MUKGeometryTransformTop: {
-            transformedRect.origin.x = (baseRect.size.width - rect.size.width)/2.0 + baseRect.origin.x;
-            transformedRect.origin.y = baseRect.origin.y;
-            
-            break;
-        }
-            
-        case MUKGeometryTransformBottom: {
-            transformedRect.origin.x = (baseRect.size.width - rect.size.width)/2.0 + baseRect.origin.x;
-            transformedRect.origin.y = baseRect.origin.y - (rect.size.height - baseRect.size.height);
-            
-            break;
-        }
-            
-        case MUKGeometryTransformLeft: {
-            transformedRect.origin.x = baseRect.origin.x;
-            transformedRect.origin.y = (baseRect.size.height - rect.size.height)/2.0 + baseRect.origin.y;
-            
-            break;
-        }
-            
-        case MUKGeometryTransformRight: {
-            transformedRect.origin.x = baseRect.origin.x - (rect.size.width - baseRect.size.width);
-            transformedRect.origin.y = (baseRect.size.height - rect.size.height)/2.0 + baseRect.origin.y;
-            
-            break;
-        }
-            
-        case MUKGeometryTransformTopLeft: {
-            transformedRect.origin.x = baseRect.origin.x;
-            transformedRect.origin.y = baseRect.origin.y;
-            
-            break;
-        }
-            
-        case MUKGeometryTransformTopRight: {
-            transformedRect.origin.x = baseRect.origin.x - (rect.size.width - baseRect.size.width);
-            transformedRect.origin.y = baseRect.origin.y;
-            
-            break;
-        }
-            
-        case MUKGeometryTransformBottomLeft: {
-            transformedRect.origin.x = baseRect.origin.x;
-            transformedRect.origin.y = baseRect.origin.y - (rect.size.height - baseRect.size.height);
-            
-            break;
-        }
-            
-        case MUKGeometryTransformBottomRight: {
-            transformedRect.origin.x = baseRect.origin.x - (rect.size.width - baseRect.size.width);
-            transformedRect.origin.y = baseRect.origin.y - (rect.size.height - baseRect.size.height);
-            
-            break;
-        }
-    
-        default:
-            break;
-    }
-    
-    return transformedRect;
+    MUK_INSTRUMENT(0);
+    return MUKRectTransform(rect, transform, baseRect);
 }
 
 @end
@@ -0,0 +1,138 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+
+/**
+ A spatial index of rectangles, each carrying an integer payload (e.g. the
+ index of a laid out item).
+ 
+ Rectangles are stored into a balanced bounding volume hierarchy (a binary 
+ R-tree), so point hit-tests and rectangle (e.g. visible viewport) queries
+ take logarithmic time instead of a linear scan.
+ 
+ You can bulk load the index with initWithRects:payloads:count:, which builds
+ a packed tree splitting rectangles on their median, and then keep it up to
+ date with insertRect:payload:, moveEntry:toRect: and removeEntry:.
+ 
+ Every stored rectangle is identified by an *entry*, which stays valid until
+ the rectangle is removed.
+ 
+ Queries follow `CGRectContainsPoint()` and `CGRectIntersectsRect()` semantics.
+ Methods returning payloads collect them into an `NSIndexSet`: entries sharing
+ a payload are reported once and `NSNotFound` payloads are skipped, so use
+ enumeration methods if payloads are not unique indexes.
+ 
+ @warning This class is not thread-safe.
+ */
+@interface MUKGeometrySpatialIndex : NSObject
+/**
+ Number of rectangles stored in the index.
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ Creates an index loading every given rectangle at once.
+ 
+ This is way faster than repeated insertions and it produces a better
+ tree.
+ 
+ @param rects C array of rectangles.
+ @param payloads C array of payloads, one per rectangle. Pass `NULL` to use
+ the index of each rectangle as its payload.
+ @param count Number of rectangles.
+ @return A new index where entry of `rects[i]` is `i`. Null, infinite and `NaN`
+ rectangles are skipped, so their entries are not valid.
+ */
+- (id)initWithRects:(CGRect const *)rects payloads:(NSUInteger const *)payloads count:(NSUInteger)count;
+
+/**
+ Inserts a rectangle into the index.
+ @param rect Rectangle to store. It is standardized first.
+ @param payload Payload to bind to `rect`.
+ @return Entry of stored rectangle or `NSNotFound` if `rect` is null, infinite
+ or contains `NaN`.
+ */
+- (NSInteger)insertRect:(CGRect)rect payload:(NSUInteger)payload;
+/**
+ Changes the rectangle of an entry.
+ @param entry An entry returned by this index.
+ @param rect New rectangle. It can not be null, infinite or contain `NaN`.
+ @return `YES` if entry is valid and it has been moved.
+ */
+- (BOOL)moveEntry:(NSInteger)entry toRect:(CGRect)rect;
+/**
+ Removes an entry from the index.
+ @param entry An entry returned by this index.
+ @return `YES` if entry was valid and it has been removed.
+ */
+- (BOOL)removeEntry:(NSInteger)entry;
+/**
+ Removes every entry from the index.
+ */
+- (void)removeAllEntries;
+/**
+ Rectangle stored with an entry.
+ @param entry An entry returned by this index.
+ @return Standardized rectangle or `CGRectNull` if `entry` is not valid.
+ */
+- (CGRect)rectForEntry:(NSInteger)entry;
+/**
+ Payload stored with an entry.
+ @param entry An entry returned by this index.
+ @return Payload or `NSNotFound` if `entry` is not valid.
+ */
+- (NSUInteger)payloadForEntry:(NSInteger)entry;
+
+/**
+ Enumerates every entry whose rectangle contains a point.
+ @param point Point to hit-test.
+ @param block A block which takes the entry, its payload, its rectangle and a
+ `BOOL *` you could set to `YES` to stop enumeration.
+ Enumeration order is not defined.
+ */
+- (void)enumerateEntriesContainingPoint:(CGPoint)point usingBlock:(void (^)(NSInteger entry, NSUInteger payload, CGRect rect, BOOL *stop))block;
+/**
+ Enumerates every entry whose rectangle intersects a rectangle.
+ @param rect Rectangle to query (e.g. visible viewport).
+ @param block A block which takes the entry, its payload, its rectangle and a
+ `BOOL *` you could set to `YES` to stop enumeration.
+ Enumeration order is not defined.
+ */
+- (void)enumerateEntriesIntersectingRect:(CGRect)rect usingBlock:(void (^)(NSInteger entry, NSUInteger payload, CGRect rect, BOOL *stop))block;
+/**
+ Payloads of entries whose rectangle contains a point.
+ @param point Point to hit-test.
+ @return Sorted payloads, without duplicates.
+ */
+- (NSIndexSet *)payloadsContainingPoint:(CGPoint)point;
+/**
+ Payloads of entries whose rectangle intersects a rectangle.
+ @param rect Rectangle to query (e.g. visible viewport).
+ @return Sorted payloads, without duplicates.
+ */
+- (NSIndexSet *)payloadsIntersectingRect:(CGRect)rect;
+@end
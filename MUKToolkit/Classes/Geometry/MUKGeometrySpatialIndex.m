@@ -0,0 +1,685 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUKGeometrySpatialIndex.h"
+
+#pragma mark - Tree
+
+typedef struct {
+    CGFloat minX, minY, maxX, maxY;
+} MUKSpatialBox;
+
+typedef struct {
+    MUKSpatialBox box;
+    NSUInteger payload;
+    int32_t parent;     // Next free node when node is not allocated
+    int32_t child1;
+    int32_t child2;
+    int32_t height;     // 0 for leaves, -1 for free nodes
+} MUKSpatialNode;
+
+typedef struct {
+    MUKSpatialNode *nodes;
+    int32_t capacity;
+    int32_t count;
+    int32_t root;
+    int32_t freeList;
+} MUKSpatialTree;
+
+static int32_t const MUKSpatialNullNode = -1;
+
+static inline MUKSpatialBox MUKSpatialBoxFromRect(CGRect rect) {
+    MUKSpatialBox box;
+    box.minX = MIN(rect.origin.x, rect.origin.x + rect.size.width);
+    box.maxX = MAX(rect.origin.x, rect.origin.x + rect.size.width);
+    box.minY = MIN(rect.origin.y, rect.origin.y + rect.size.height);
+    box.maxY = MAX(rect.origin.y, rect.origin.y + rect.size.height);
+    return box;
+}
+
+// Null, infinite or NaN rects would corrupt bounding boxes of their ancestors
+static inline BOOL MUKSpatialRectIsStorable(CGRect rect) {
+    if (CGRectIsNull(rect) || CGRectIsInfinite(rect)) {
+        return NO;
+    }
+    
+    return !(isnan(rect.origin.x) || isnan(rect.origin.y) || isnan(rect.size.width) || isnan(rect.size.height));
+}
+
+static inline CGRect MUKSpatialRectFromBox(MUKSpatialBox box) {
+    return CGRectMake(box.minX, box.minY, box.maxX - box.minX, box.maxY - box.minY);
+}
+
+static inline MUKSpatialBox MUKSpatialBoxUnion(MUKSpatialBox a, MUKSpatialBox b) {
+    MUKSpatialBox box;
+    box.minX = MIN(a.minX, b.minX);
+    box.minY = MIN(a.minY, b.minY);
+    box.maxX = MAX(a.maxX, b.maxX);
+    box.maxY = MAX(a.maxY, b.maxY);
+    return box;
+}
+
+static inline CGFloat MUKSpatialBoxPerimeter(MUKSpatialBox box) {
+    return (CGFloat)2.0 * ((box.maxX - box.minX) + (box.maxY - box.minY));
+}
+
+static inline BOOL MUKSpatialBoxesTouch(MUKSpatialBox a, MUKSpatialBox b) {
+    return (a.minX <= b.maxX && b.minX <= a.maxX && a.minY <= b.maxY && b.minY <= a.maxY);
+}
+
+// Touching edges do not overlap, like CGRectIntersectsRect(), unless one of
+// the boxes is degenerate on that axis
+static inline BOOL MUKSpatialBoxesOverlap(MUKSpatialBox a, MUKSpatialBox b) {
+    return MUKSpatialBoxesTouch(a, b) &&
+           ((a.minX < b.maxX && b.minX < a.maxX) || a.minX == a.maxX || b.minX == b.maxX) &&
+           ((a.minY < b.maxY && b.minY < a.maxY) || a.minY == a.maxY || b.minY == b.maxY);
+}
+
+// Same semantics of CGRectContainsPoint()
+static inline BOOL MUKSpatialBoxContainsPoint(MUKSpatialBox box, CGPoint point) {
+    return (point.x >= box.minX && point.x < box.maxX && point.y >= box.minY && point.y < box.maxY);
+}
+
+static BOOL MUKSpatialTreeReserve(MUKSpatialTree *tree, int32_t capacity) {
+    if (capacity <= tree->capacity) return YES;
+    
+    MUKSpatialNode *nodes = realloc(tree->nodes, (size_t)capacity * sizeof(MUKSpatialNode));
+    if (!nodes) return NO;
+    
+    // Chain new nodes into free list
+    for (int32_t i = tree->capacity; i < capacity; i++) {
+        nodes[i].parent = (i + 1 < capacity ? i + 1 : tree->freeList);
+        nodes[i].height = -1;
+    }
+    
+    tree->freeList = tree->capacity;
+    tree->nodes = nodes;
+    tree->capacity = capacity;
+    return YES;
+}
+
+static int32_t MUKSpatialTreeAllocateNode(MUKSpatialTree *tree) {
+    if (tree->freeList == MUKSpatialNullNode) {
+        int32_t capacity = (tree->capacity > 0 ? tree->capacity * 2 : 16);
+        if (!MUKSpatialTreeReserve(tree, capacity)) {
+            return MUKSpatialNullNode;
+        }
+    }
+    
+    int32_t nodeId = tree->freeList;
+    MUKSpatialNode *node = &tree->nodes[nodeId];
+    tree->freeList = node->parent;
+    
+    node->parent = node->child1 = node->child2 = MUKSpatialNullNode;
+    node->height = 0;
+    node->payload = 0;
+    tree->count++;
+    
+    return nodeId;
+}
+
+static void MUKSpatialTreeFreeNode(MUKSpatialTree *tree, int32_t nodeId) {
+    tree->nodes[nodeId].parent = tree->freeList;
+    tree->nodes[nodeId].height = -1;
+    tree->freeList = nodeId;
+    tree->count--;
+}
+
+static inline BOOL MUKSpatialTreeIsLeaf(MUKSpatialTree const *tree, int32_t nodeId) {
+    return tree->nodes[nodeId].child1 == MUKSpatialNullNode;
+}
+
+static inline BOOL MUKSpatialTreeIsLeafAllocated(MUKSpatialTree const *tree, NSInteger nodeId) {
+    return (nodeId >= 0 && nodeId < tree->capacity && tree->nodes[nodeId].height == 0);
+}
+
+// Rotates an unbalanced subtree (AVL-like, see Box2D b2DynamicTree).
+// Returns the new root of the subtree.
+static int32_t MUKSpatialTreeBalance(MUKSpatialTree *tree, int32_t iA) {
+    MUKSpatialNode *nodes = tree->nodes;
+    MUKSpatialNode *A = &nodes[iA];
+    if (A->child1 == MUKSpatialNullNode || A->height < 2) {
+        return iA;
+    }
+    
+    int32_t iB = A->child1;
+    int32_t iC = A->child2;
+    MUKSpatialNode *B = &nodes[iB];
+    MUKSpatialNode *C = &nodes[iC];
+    
+    int32_t balance = C->height - B->height;
+    
+    if (balance > 1 || balance < -1) {
+        // Promote the higher child (P) and move its shorter grandchild down
+        int32_t iP = (balance > 1 ? iC : iB);
+        int32_t iQ = (balance > 1 ? iB : iC);
+        MUKSpatialNode *P = &nodes[iP];
+        MUKSpatialNode *Q = &nodes[iQ];
+        
+        int32_t iF = P->child1;
+        int32_t iG = P->child2;
+        MUKSpatialNode *F = &nodes[iF];
+        MUKSpatialNode *G = &nodes[iG];
+        
+        // Swap A and P
+        P->child1 = iA;
+        P->parent = A->parent;
+        A->parent = iP;
+        
+        if (P->parent != MUKSpatialNullNode) {
+            if (nodes[P->parent].child1 == iA) {
+                nodes[P->parent].child1 = iP;
+            }
+            else {
+                nodes[P->parent].child2 = iP;
+            }
+        }
+        else {
+            tree->root = iP;
+        }
+        
+        // Taller grandchild stays under P, shorter one goes under A
+        int32_t iKeep = (F->height > G->height ? iF : iG);
+        int32_t iMove = (iKeep == iF ? iG : iF);
+        
+        P->child2 = iKeep;
+        if (balance > 1) {
+            A->child2 = iMove;
+        }
+        else {
+            A->child1 = iMove;
+        }
+        nodes[iMove].parent = iA;
+        
+        A->box = MUKSpatialBoxUnion(Q->box, nodes[iMove].box);
+        P->box = MUKSpatialBoxUnion(A->box, nodes[iKeep].box);
+        
+        A->height = 1 + MAX(Q->height, nodes[iMove].height);
+        P->height = 1 + MAX(A->height, nodes[iKeep].height);
+        
+        return iP;
+    }
+    
+    return iA;
+}
+
+static void MUKSpatialTreeFixUpward(MUKSpatialTree *tree, int32_t nodeId) {
+    while (nodeId != MUKSpatialNullNode) {
+        nodeId = MUKSpatialTreeBalance(tree, nodeId);
+        
+        MUKSpatialNode *node = &tree->nodes[nodeId];
+        MUKSpatialNode *child1 = &tree->nodes[node->child1];
+        MUKSpatialNode *child2 = &tree->nodes[node->child2];
+        
+        node->height = 1 + MAX(child1->height, child2->height);
+        node->box = MUKSpatialBoxUnion(child1->box, child2->box);
+        
+        nodeId = node->parent;
+    }
+}
+
+static inline CGFloat MUKSpatialTreeDescendCost(MUKSpatialTree const *tree, int32_t nodeId, MUKSpatialBox leafBox)
+{
+    MUKSpatialNode const *node = &tree->nodes[nodeId];
+    CGFloat cost = MUKSpatialBoxPerimeter(MUKSpatialBoxUnion(leafBox, node->box));
+    
+    if (node->child1 != MUKSpatialNullNode) {
+        // Only enlargement counts for internal nodes
+        cost -= MUKSpatialBoxPerimeter(node->box);
+    }
+    
+    return cost;
+}
+
+static BOOL MUKSpatialTreeInsertLeaf(MUKSpatialTree *tree, int32_t leaf) {
+    if (tree->root == MUKSpatialNullNode) {
+        tree->root = leaf;
+        tree->nodes[leaf].parent = MUKSpatialNullNode;
+        return YES;
+    }
+    
+    // Find best sibling, descending with surface area heuristic
+    MUKSpatialBox leafBox = tree->nodes[leaf].box;
+    int32_t index = tree->root;
+    
+    while (!MUKSpatialTreeIsLeaf(tree, index)) {
+        MUKSpatialNode const *node = &tree->nodes[index];
+        int32_t child1 = node->child1;
+        int32_t child2 = node->child2;
+        
+        CGFloat area = MUKSpatialBoxPerimeter(node->box);
+        CGFloat combinedArea = MUKSpatialBoxPerimeter(MUKSpatialBoxUnion(node->box, leafBox));
+        
+        // Cost of creating a new parent for this node and the new leaf
+        CGFloat cost = (CGFloat)2.0 * combinedArea;
+        
+        // Minimum cost of pushing the leaf further down the tree
+        CGFloat inheritanceCost = (CGFloat)2.0 * (combinedArea - area);
+        
+        // Cost of descending into each child
+        CGFloat cost1 = MUKSpatialTreeDescendCost(tree, child1, leafBox) + inheritanceCost;
+        CGFloat cost2 = MUKSpatialTreeDescendCost(tree, child2, leafBox) + inheritanceCost;
+        
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+        
+        index = (cost1 < cost2 ? child1 : child2);
+    }
+    
+    int32_t sibling = index;
+    
+    // Create a new parent
+    int32_t oldParent = tree->nodes[sibling].parent;
+    int32_t newParent = MUKSpatialTreeAllocateNode(tree);
+    if (newParent == MUKSpatialNullNode) {
+        return NO;
+    }
+    
+    MUKSpatialNode *nodes = tree->nodes; // Allocation could have moved nodes
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = MUKSpatialBoxUnion(leafBox, nodes[sibling].box);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+    
+    if (oldParent != MUKSpatialNullNode) {
+        if (nodes[oldParent].child1 == sibling) {
+            nodes[oldParent].child1 = newParent;
+        }
+        else {
+            nodes[oldParent].child2 = newParent;
+        }
+    }
+    else {
+        tree->root = newParent;
+    }
+    
+    MUKSpatialTreeFixUpward(tree, nodes[leaf].parent);
+    return YES;
+}
+
+static void MUKSpatialTreeRemoveLeaf(MUKSpatialTree *tree, int32_t leaf) {
+    MUKSpatialNode *nodes = tree->nodes;
+    
+    if (leaf == tree->root) {
+        tree->root = MUKSpatialNullNode;
+        return;
+    }
+    
+    int32_t parent = nodes[leaf].parent;
+    int32_t grandParent = nodes[parent].parent;
+    int32_t sibling = (nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1);
+    
+    if (grandParent != MUKSpatialNullNode) {
+        // Destroy parent and connect sibling to grand parent
+        if (nodes[grandParent].child1 == parent) {
+            nodes[grandParent].child1 = sibling;
+        }
+        else {
+            nodes[grandParent].child2 = sibling;
+        }
+        
+        nodes[sibling].parent = grandParent;
+        MUKSpatialTreeFreeNode(tree, parent);
+        MUKSpatialTreeFixUpward(tree, grandParent);
+    }
+    else {
+        tree->root = sibling;
+        nodes[sibling].parent = MUKSpatialNullNode;
+        MUKSpatialTreeFreeNode(tree, parent);
+    }
+    
+    nodes[leaf].parent = MUKSpatialNullNode;
+}
+
+#pragma mark - Bulk Loading
+
+static inline CGFloat MUKSpatialBoxCenter(MUKSpatialBox box, int axis) {
+    return (axis == 0 ? box.minX + box.maxX : box.minY + box.maxY);
+}
+
+// Top-down median split on the longest axis of leaf centers.
+// Leaves are already allocated; only internal nodes are created here.
+static int32_t MUKSpatialTreeBuild(MUKSpatialTree *tree, int32_t *leaves, int32_t count) {
+    MUKSpatialNode *nodes = tree->nodes;
+    
+    if (count == 1) {
+        return leaves[0];
+    }
+    
+    CGFloat minX = CGFLOAT_MAX, minY = CGFLOAT_MAX, maxX = -CGFLOAT_MAX, maxY = -CGFLOAT_MAX;
+    for (int32_t i = 0; i < count; i++) {
+        MUKSpatialBox box = nodes[leaves[i]].box;
+        CGFloat cx = MUKSpatialBoxCenter(box, 0), cy = MUKSpatialBoxCenter(box, 1);
+        minX = MIN(minX, cx); maxX = MAX(maxX, cx);
+        minY = MIN(minY, cy); maxY = MAX(maxY, cy);
+    }
+    
+    int axis = ((maxX - minX) >= (maxY - minY) ? 0 : 1);
+    int32_t half = count / 2;
+    
+    // Quickselect around median center
+    int32_t lo = 0, hi = count - 1;
+    while (lo < hi) {
+        CGFloat pivot = MUKSpatialBoxCenter(nodes[leaves[(lo + hi) / 2]].box, axis);
+        int32_t i = lo, j = hi;
+        while (i <= j) {
+            while (MUKSpatialBoxCenter(nodes[leaves[i]].box, axis) < pivot) i++;
+            while (MUKSpatialBoxCenter(nodes[leaves[j]].box, axis) > pivot) j--;
+            if (i <= j) {
+                int32_t tmp = leaves[i]; leaves[i] = leaves[j]; leaves[j] = tmp;
+                i++; j--;
+            }
+        }
+        
+        if (half <= j) hi = j;
+        else if (half >= i) lo = i;
+        else break;
+    }
+    
+    int32_t child1 = MUKSpatialTreeBuild(tree, leaves, half);
+    int32_t child2 = MUKSpatialTreeBuild(tree, leaves + half, count - half);
+    
+    int32_t parent = MUKSpatialTreeAllocateNode(tree);
+    nodes = tree->nodes;
+    nodes[parent].child1 = child1;
+    nodes[parent].child2 = child2;
+    nodes[parent].box = MUKSpatialBoxUnion(nodes[child1].box, nodes[child2].box);
+    nodes[parent].height = 1 + MAX(nodes[child1].height, nodes[child2].height);
+    nodes[child1].parent = parent;
+    nodes[child2].parent = parent;
+    
+    return parent;
+}
+
+#pragma mark - Queries
+
+// Visits every leaf whose box passes test. Visitor returns NO to stop.
+typedef BOOL (*MUKSpatialTreeVisitor)(MUKSpatialNode const *leaf, int32_t leafId, void *context);
+
+static void MUKSpatialTreeQuery(MUKSpatialTree const *tree, MUKSpatialBox queryBox, BOOL pointQuery, CGPoint point, MUKSpatialTreeVisitor visitor, void *context)
+{
+    if (tree->root == MUKSpatialNullNode) return;
+    
+    if (pointQuery) {
+        queryBox.minX = queryBox.maxX = point.x;
+        queryBox.minY = queryBox.maxY = point.y;
+    }
+    
+    int32_t localStack[128];
+    int32_t *stack = localStack;
+    int32_t stackCapacity = 128;
+    int32_t stackCount = 0;
+    
+    stack[stackCount++] = tree->root;
+    
+    while (stackCount > 0) {
+        int32_t nodeId = stack[--stackCount];
+        MUKSpatialNode const *node = &tree->nodes[nodeId];
+        
+        if (node->child1 == MUKSpatialNullNode) {
+            BOOL hit = (pointQuery ? MUKSpatialBoxContainsPoint(node->box, point) : MUKSpatialBoxesOverlap(node->box, queryBox));
+            if (hit && !visitor(node, nodeId, context)) break;
+        }
+        else if (!MUKSpatialBoxesTouch(node->box, queryBox)) {
+            // Internal boxes are tested as closed boxes, so leaves lying on
+            // their edges are still reached
+            continue;
+        }
+        else {
+            if (stackCount + 2 > stackCapacity) {
+                int32_t newCapacity = stackCapacity * 2;
+                int32_t *newStack = malloc((size_t)newCapacity * sizeof(int32_t));
+                if (!newStack) break;
+                memcpy(newStack, stack, (size_t)stackCount * sizeof(int32_t));
+                if (stack != localStack) free(stack);
+                stack = newStack;
+                stackCapacity = newCapacity;
+            }
+            
+            stack[stackCount++] = node->child2;
+            stack[stackCount++] = node->child1;
+        }
+    }
+    
+    if (stack != localStack) free(stack);
+}
+
+typedef void (^MUKGeometrySpatialIndexBlock)(NSInteger entry, NSUInteger payload, CGRect rect, BOOL *stop);
+
+static BOOL MUKSpatialTreeBlockVisitor(MUKSpatialNode const *leaf, int32_t leafId, void *context)
+{
+    MUKGeometrySpatialIndexBlock block = (__bridge MUKGeometrySpatialIndexBlock)context;
+    
+    BOOL stop = NO;
+    block(leafId, leaf->payload, MUKSpatialRectFromBox(leaf->box), &stop);
+    return !stop;
+}
+
+static BOOL MUKSpatialTreeIndexSetVisitor(MUKSpatialNode const *leaf, int32_t leafId, void *context)
+{
+    // NSIndexSet can not hold NSNotFound
+    if (leaf->payload != NSNotFound) {
+        NSMutableIndexSet *indexSet = (__bridge NSMutableIndexSet *)context;
+        [indexSet addIndex:leaf->payload];
+    }
+    
+    return YES;
+}
+
+#pragma mark -
+
+@implementation MUKGeometrySpatialIndex {
+    MUKSpatialTree tree_;
+    NSUInteger count_;
+}
+
+- (id)init {
+    self = [super init];
+    if (self) {
+        tree_.root = MUKSpatialNullNode;
+        tree_.freeList = MUKSpatialNullNode;
+    }
+    
+    return self;
+}
+
+- (id)initWithRects:(CGRect const *)rects payloads:(NSUInteger const *)payloads count:(NSUInteger)count
+{
+    self = [self init];
+    if (self) {
+        if (count == 0 || rects == NULL) {
+            return self;
+        }
+        
+        if (count > INT32_MAX/2 || !MUKSpatialTreeReserve(&tree_, (int32_t)(2 * count - 1)))
+        {
+            return nil;
+        }
+        
+        int32_t *leaves = malloc(count * sizeof(int32_t));
+        if (!leaves) {
+            return nil;
+        }
+        
+        // Leaves are allocated first, so entry i is rects[i]
+        for (NSUInteger i = 0; i < count; i++) {
+            int32_t leaf = MUKSpatialTreeAllocateNode(&tree_);
+            tree_.nodes[leaf].box = MUKSpatialBoxFromRect(rects[i]);
+            tree_.nodes[leaf].payload = (payloads ? payloads[i] : i);
+            leaves[i] = leaf;
+        }
+        
+        // Free skipped leaves only now, so they do not shift later entries
+        int32_t storedCount = 0;
+        for (NSUInteger i = 0; i < count; i++) {
+            if (MUKSpatialRectIsStorable(rects[i])) {
+                leaves[storedCount++] = leaves[i];
+            }
+            else {
+                MUKSpatialTreeFreeNode(&tree_, leaves[i]);
+            }
+        }
+        
+        if (storedCount > 0) {
+            tree_.root = MUKSpatialTreeBuild(&tree_, leaves, storedCount);
+        }
+        
+        count_ = (NSUInteger)storedCount;
+        
+        free(leaves);
+    }
+    
+    return self;
+}
+
+- (void)dealloc {
+    free(tree_.nodes);
+}
+
+#pragma mark - Accessors
+
+- (NSUInteger)count {
+    return count_;
+}
+
+#pragma mark - Methods
+
+- (NSInteger)insertRect:(CGRect)rect payload:(NSUInteger)payload {
+    if (!MUKSpatialRectIsStorable(rect)) {
+        return NSNotFound;
+    }
+    
+    int32_t leaf = MUKSpatialTreeAllocateNode(&tree_);
+    if (leaf == MUKSpatialNullNode) {
+        return NSNotFound;
+    }
+    
+    tree_.nodes[leaf].box = MUKSpatialBoxFromRect(rect);
+    tree_.nodes[leaf].payload = payload;
+    
+    if (!MUKSpatialTreeInsertLeaf(&tree_, leaf)) {
+        MUKSpatialTreeFreeNode(&tree_, leaf);
+        return NSNotFound;
+    }
+    
+    count_++;
+    return leaf;
+}
+
+- (BOOL)moveEntry:(NSInteger)entry toRect:(CGRect)rect {
+    if (!MUKSpatialTreeIsLeafAllocated(&tree_, entry) || !MUKSpatialRectIsStorable(rect)) {
+        return NO;
+    }
+    
+    int32_t leaf = (int32_t)entry;
+    MUKSpatialBox box = MUKSpatialBoxFromRect(rect);
+    MUKSpatialBox oldBox = tree_.nodes[leaf].box;
+    
+    if (box.minX == oldBox.minX && box.minY == oldBox.minY &&
+        box.maxX == oldBox.maxX && box.maxY == oldBox.maxY)
+    {
+        return YES;
+    }
+    
+    // Reinsert the same node, so entry does not change.
+    // Removal frees one internal node, so insertion can not fail.
+    MUKSpatialTreeRemoveLeaf(&tree_, leaf);
+    tree_.nodes[leaf].box = box;
+    MUKSpatialTreeInsertLeaf(&tree_, leaf);
+    
+    return YES;
+}
+
+- (BOOL)removeEntry:(NSInteger)entry {
+    if (!MUKSpatialTreeIsLeafAllocated(&tree_, entry)) {
+        return NO;
+    }
+    
+    MUKSpatialTreeRemoveLeaf(&tree_, (int32_t)entry);
+    MUKSpatialTreeFreeNode(&tree_, (int32_t)entry);
+    count_--;
+    
+    return YES;
+}
+
+- (void)removeAllEntries {
+    free(tree_.nodes);
+    memset(&tree_, 0, sizeof(tree_));
+    tree_.root = MUKSpatialNullNode;
+    tree_.freeList = MUKSpatialNullNode;
+    count_ = 0;
+}
+
+- (CGRect)rectForEntry:(NSInteger)entry {
+    if (!MUKSpatialTreeIsLeafAllocated(&tree_, entry)) {
+        return CGRectNull;
+    }
+    
+    return MUKSpatialRectFromBox(tree_.nodes[entry].box);
+}
+
+- (NSUInteger)payloadForEntry:(NSInteger)entry {
+    if (!MUKSpatialTreeIsLeafAllocated(&tree_, entry)) {
+        return NSNotFound;
+    }
+    
+    return tree_.nodes[entry].payload;
+}
+
+- (void)enumerateEntriesContainingPoint:(CGPoint)point usingBlock:(void (^)(NSInteger, NSUInteger, CGRect, BOOL *))block
+{
+    if (!block) return;
+    MUKSpatialBox box = { 0 };
+    MUKSpatialTreeQuery(&tree_, box, YES, point, MUKSpatialTreeBlockVisitor, (__bridge void *)block);
+}
+
+- (void)enumerateEntriesIntersectingRect:(CGRect)rect usingBlock:(void (^)(NSInteger, NSUInteger, CGRect, BOOL *))block
+{
+    if (!block || CGRectIsNull(rect)) return;
+    MUKSpatialTreeQuery(&tree_, MUKSpatialBoxFromRect(rect), NO, CGPointZero, MUKSpatialTreeBlockVisitor, (__bridge void *)block);
+}
+
+- (NSIndexSet *)payloadsContainingPoint:(CGPoint)point {
+    NSMutableIndexSet *indexSet = [[NSMutableIndexSet alloc] init];
+    MUKSpatialBox box = { 0 };
+    MUKSpatialTreeQuery(&tree_, box, YES, point, MUKSpatialTreeIndexSetVisitor, (__bridge void *)indexSet);
+    return indexSet;
+}
+
+- (NSIndexSet *)payloadsIntersectingRect:(CGRect)rect {
+    NSMutableIndexSet *indexSet = [[NSMutableIndexSet alloc] init];
+    
+    if (!CGRectIsNull(rect)) {
+        MUKSpatialTreeQuery(&tree_, MUKSpatialBoxFromRect(rect), NO, CGPointZero, MUKSpatialTreeIndexSetVisitor, (__bridge void *)indexSet);
+    }
+    
+    return indexSet;
+}
+
+@end
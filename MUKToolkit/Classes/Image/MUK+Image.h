@@ -25,6 +25,8 @@
 
 #import "MUK.h"
 
+@class MUKImagePalette;
+
 extern CGFloat const MUKImageBlurExtraLightEffectBlurRadius;
 extern CGFloat const MUKImageBlurLightEffectBlurRadius;
 extern CGFloat const MUKImageBlurDarkEffectBlurRadius;
@@ -86,4 +88,36 @@ extern CGFloat const MUKImageBlurDefaultSaturationDeltaFactor;
  to achieve blur dark effect.
  */
 + (UIColor *)imageBlurDarkEffectTintColor;
+
+/**
+ Extracts dominant colors of an image.
+ 
+ Use it to derive a tint color from image content, e.g. for 
+ +image:applyingBlurWithRadius:iterationsCount:tintColor:saturationDeltaFactor:maskImage:.
+ Colors are refined with k-means.
+ 
+ @param image Source image. It must be backed by a `CGImage`.
+ @param maximumColorsCount Maximum number of colors to extract.
+ @return A palette of colors, sorted by descending weight.
+ @see MUKImagePalette
+ */
++ (MUKImagePalette *)paletteOfImage:(UIImage *)image maximumColorsCount:(NSUInteger)maximumColorsCount;
+/**
+ Blends two images in linear light.
+ 
+ Pixels are converted from sRGB encoding to linear light before they are 
+ interpolated, then back: midpoints do not darken like with plain 
+ `kCGBlendModeNormal` drawing. Pixels are converted row by row with
+ MUKPixelKernels.h functions.
+ 
+ @param sourceImage First image. It must be backed by a `CGImage`.
+ @param image Second image, which is stretched to size of sourceImage. It must
+ be backed by a `CGImage`.
+ @param fraction How much of image goes into the blend, between `0.0` 
+ (sourceImage) and `1.0` (image).
+ @return Blended image, or `nil` if pre-conditions are not met.
+ @see MUKPixelsBlendLinear()
+ @see [MUK color:blendedWithColor:fraction:]
+ */
++ (UIImage *)image:(UIImage *)sourceImage blendedWithImage:(UIImage *)image fraction:(CGFloat)fraction;
 @end
@@ -25,6 +25,9 @@
 
 #import "MUK+Image.h"
 #import <Accelerate/Accelerate.h>
+#import "MUK+Instrumentation.h"
+#import "MUKImagePalette.h"
+#import "MUKPixelKernels.h"
 
 CGFloat const MUKImageBlurExtraLightEffectBlurRadius    = 20.0f;
 CGFloat const MUKImageBlurLightEffectBlurRadius         = 30.0f;
@@ -38,6 +41,7 @@ CGFloat const MUKImageBlurDefaultSaturationDeltaFactor  = 1.8f;
 
 + (UIImage *)image:(UIImage *)sourceImage applyingBlurWithRadius:(CGFloat)blurRadius iterationsCount:(NSInteger)iterationsCount tintColor:(UIColor *)tintColor saturationDeltaFactor:(CGFloat)saturationDeltaFactor maskImage:(UIImage *)maskImage
 {
+    MUK_INSTRUMENT(sourceImage.size.width * sourceImage.size.height * sourceImage.scale * sourceImage.scale * 4.0);
     // Check pre-conditions
     if (!sourceImage || !sourceImage.CGImage) {
         return nil;
@@ -182,4 +186,110 @@ CGFloat const MUKImageBlurDefaultSaturationDeltaFactor  = 1.8f;
     return [UIColor colorWithWhite:0.11f alpha:0.73f];
 }
 
++ (MUKImagePalette *)paletteOfImage:(UIImage *)image maximumColorsCount:(NSUInteger)maximumColorsCount
+{
+    MUK_INSTRUMENT(image.size.width * image.size.height * image.scale * image.scale * 4.0);
+    if (!image.CGImage) return nil;
+    
+    return [[MUKImagePalette alloc] initWithImage:image maximumColorsCount:maximumColorsCount options:MUKImagePaletteOptionRefine];
+}
+
++ (UIImage *)image:(UIImage *)sourceImage blendedWithImage:(UIImage *)image fraction:(CGFloat)fraction
+{
+    MUK_INSTRUMENT(sourceImage.size.width * sourceImage.size.height * sourceImage.scale * sourceImage.scale * 8.0);
+    // Check pre-conditions
+    if (!sourceImage.CGImage || !image.CGImage) {
+        return nil;
+    }
+    
+    if (sourceImage.size.width < 1.0f || sourceImage.size.height < 1.0f) {
+        return nil;
+    }
+    
+    CGRect imageRect = { CGPointZero, sourceImage.size };
+    
+    UIGraphicsBeginImageContextWithOptions(sourceImage.size, NO, sourceImage.scale);
+    CGContextRef outputContext = UIGraphicsGetCurrentContext();
+    CGContextScaleCTM(outputContext, 1.0, -1.0);
+    CGContextTranslateCTM(outputContext, 0, -sourceImage.size.height);
+    CGContextDrawImage(outputContext, imageRect, sourceImage.CGImage);
+    
+    UIGraphicsBeginImageContextWithOptions(sourceImage.size, NO, sourceImage.scale);
+    CGContextRef blendedContext = UIGraphicsGetCurrentContext();
+    CGContextScaleCTM(blendedContext, 1.0, -1.0);
+    CGContextTranslateCTM(blendedContext, 0, -sourceImage.size.height);
+    CGContextDrawImage(blendedContext, imageRect, image.CGImage);
+    
+    MUKPixelFormat format;
+    BOOL const blended = [self getPixelFormat_:&format ofContext:outputContext] && CGBitmapContextGetBitmapInfo(outputContext) == CGBitmapContextGetBitmapInfo(blendedContext);
+    
+    if (blended) {
+        size_t const width = CGBitmapContextGetWidth(outputContext);
+        size_t const height = CGBitmapContextGetHeight(outputContext);
+        size_t const outputBytesPerRow = CGBitmapContextGetBytesPerRow(outputContext);
+        size_t const blendedBytesPerRow = CGBitmapContextGetBytesPerRow(blendedContext);
+        uint8_t *outputBytes = CGBitmapContextGetData(outputContext);
+        uint8_t *blendedBytes = CGBitmapContextGetData(blendedContext);
+        
+        // Rows are converted one by one, so linear buffers stay in cache
+        uint16_t *outputRow = malloc(width * 4 * sizeof(uint16_t));
+        uint16_t *blendedRow = malloc(width * 4 * sizeof(uint16_t));
+        
+        for (size_t y = 0; y < height; y++) {
+            uint8_t *outputPixels = outputBytes + y * outputBytesPerRow;
+            uint8_t *blendedPixels = blendedBytes + y * blendedBytesPerRow;
+            
+            MUKPixelsUnpremultiply(outputPixels, format, width);
+            MUKPixelsUnpremultiply(blendedPixels, format, width);
+            MUKPixelsConvertSRGBToLinear(outputPixels, outputRow, format, width);
+            MUKPixelsConvertSRGBToLinear(blendedPixels, blendedRow, format, width);
+            
+            MUKPixelsBlendLinear(outputRow, blendedRow, format, width, fraction);
+            
+            MUKPixelsConvertLinearToSRGB(outputRow, outputPixels, format, width);
+            MUKPixelsPremultiply(outputPixels, format, width);
+        } // for
+        
+        free(outputRow);
+        free(blendedRow);
+    }
+    
+    UIGraphicsEndImageContext();
+    
+    UIImage *outputImage = (blended ? UIGraphicsGetImageFromCurrentImageContext() : nil);
+    UIGraphicsEndImageContext();
+    
+    return outputImage;
+}
+
+#pragma mark - Private
+
++ (BOOL)getPixelFormat_:(MUKPixelFormat *)format ofContext:(CGContextRef)context {
+    if (!CGBitmapContextGetData(context) || CGBitmapContextGetBitsPerPixel(context) != 32 || CGBitmapContextGetBitsPerComponent(context) != 8)
+    {
+        return NO;
+    }
+    
+    CGImageAlphaInfo const alphaInfo = CGBitmapContextGetAlphaInfo(context);
+    CGBitmapInfo const byteOrder = CGBitmapContextGetBitmapInfo(context) & kCGBitmapByteOrderMask;
+    
+    if (alphaInfo == kCGImageAlphaPremultipliedFirst && byteOrder == kCGBitmapByteOrder32Little)
+    {
+        *format = MUKPixelFormatBGRA8888;
+    }
+    else if (alphaInfo == kCGImageAlphaPremultipliedFirst && byteOrder != kCGBitmapByteOrder32Little)
+    {
+        *format = MUKPixelFormatARGB8888;
+    }
+    else if (alphaInfo == kCGImageAlphaPremultipliedLast && byteOrder != kCGBitmapByteOrder32Little)
+    {
+        *format = MUKPixelFormatRGBA8888;
+    }
+    else {
+        return NO;
+    }
+    
+    return YES;
+}
+
 @end
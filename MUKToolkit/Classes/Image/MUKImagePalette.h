@@ -0,0 +1,112 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUK+Image.h"
+
+typedef enum : NSUInteger {
+    MUKImagePaletteOptionNone                   = 0,
+    MUKImagePaletteOptionPremultipliedAlpha     = 1 << 0,
+    MUKImagePaletteOptionRefine                 = 1 << 1
+} MUKImagePaletteOptions;
+
+/**
+ Dominant colors of an image, with their weights.
+ 
+ Palette is extracted from a RGBA8 buffer in three steps:
+ 
+ 1. pixels are sampled on a regular grid, whose step keeps samples count 
+ around 16 thousands whatever the image size (mostly transparent pixels are
+ skipped);
+ 2. samples are quantized with median cut: the box of colors which spreads
+ most is split at the median of its longest channel, until there are enough
+ boxes;
+ 3. optionally, clusters are refined with a few k-means iterations.
+ 
+ Clusters which are too close to be told apart are merged.
+    
+    MUKImagePalette *palette = [MUK paletteOfImage:headerImage maximumColorsCount:5];
+    UIColor *tintColor = [[palette dominantColor] colorWithAlphaComponent:MUKImageBlurSuggestedTintColorAlpha];
+ 
+ ## Constants
+ 
+ `MUKImagePaletteOptions` is a bitmask which tunes extraction:
+ 
+ * `MUKImagePaletteOptionNone` uses defaults.
+ * `MUKImagePaletteOptionPremultipliedAlpha` tells that color components of
+ the buffer are premultiplied by alpha (like `CGBitmapContext` ones).
+ * `MUKImagePaletteOptionRefine` refines median cut clusters with k-means,
+ which gives more accurate colors at a small cost.
+ 
+ */
+@interface MUKImagePalette : NSObject
+/**
+ Extracted colors, sorted by descending weight.
+ */
+@property (nonatomic, strong, readonly) NSArray *colors;
+/**
+ Number of pixels which have been sampled.
+ */
+@property (nonatomic, readonly) NSUInteger samplesCount;
+
+/**
+ Extracts a palette from a pixel buffer.
+ @param bytes Pixels, with four 8-bit components per pixel in red, green, blue
+ and alpha order.
+ @param width Width of buffer, in pixels.
+ @param height Height of buffer, in pixels.
+ @param bytesPerRow Bytes between the start of a row and the start of the
+ next one.
+ @param maximumColorsCount Maximum number of colors to extract.
+ @param options A bitmask of options.
+ @return A new palette.
+ */
+- (id)initWithRGBABytes:(void const *)bytes width:(NSUInteger)width height:(NSUInteger)height bytesPerRow:(NSUInteger)bytesPerRow maximumColorsCount:(NSUInteger)maximumColorsCount options:(MUKImagePaletteOptions)options;
+/**
+ Extracts a palette from an image.
+ 
+ Image is drawn into a premultiplied RGBA8 buffer as big as samples, so big
+ images are never decoded at full resolution.
+ 
+ @param image Source image. It must be backed by a `CGImage`.
+ @param maximumColorsCount Maximum number of colors to extract.
+ @param options A bitmask of options. `MUKImagePaletteOptionPremultipliedAlpha`
+ is ignored.
+ @return A new palette.
+ */
+- (id)initWithImage:(UIImage *)image maximumColorsCount:(NSUInteger)maximumColorsCount options:(MUKImagePaletteOptions)options;
+
+/**
+ Color with the greatest weight.
+ @return First color of colors or `nil` if palette is empty.
+ */
+- (UIColor *)dominantColor;
+/**
+ Weight of an extracted color.
+ @param index Index of color into colors.
+ @return Fraction of samples represented by color at `index`, between `0.0`
+ and `1.0`. Weights of all colors sum up to `1.0`.
+ */
+- (CGFloat)weightOfColorAtIndex:(NSUInteger)index;
+@end
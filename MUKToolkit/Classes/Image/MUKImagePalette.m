@@ -0,0 +1,424 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUKImagePalette.h"
+#include <float.h>
+
+// Long enough for a palette, short enough to stay within few milliseconds
+#define MUK_IMAGE_PALETTE_MAXIMUM_SAMPLES_COUNT 16384
+
+// Mostly transparent pixels do not contribute to palette
+#define MUK_IMAGE_PALETTE_MINIMUM_ALPHA         128
+
+#define MUK_IMAGE_PALETTE_KMEANS_ITERATIONS     8
+
+// Clusters closer than this (in 8-bit RGB units) are the same color
+#define MUK_IMAGE_PALETTE_MERGE_DISTANCE        16.0f
+
+// Samples are packed as 0x00RRGGBB
+#define MUK_IMAGE_PALETTE_CHANNEL(sample, channel)  (((sample) >> (16 - 8 * (channel))) & 0xFF)
+
+typedef struct {
+    float components[3];
+    NSUInteger population;
+} MUKImagePaletteCluster;
+
+typedef struct {
+    NSUInteger start;
+    NSUInteger count;
+    uint8_t minimum[3];
+    uint8_t maximum[3];
+} MUKImagePaletteBox;
+
+static NSUInteger MUKImagePaletteSamplingStep(NSUInteger width, NSUInteger height, NSUInteger maximumSamplesCount)
+{
+    double const pixelsPerSample = (double)width * (double)height / (double)maximumSamplesCount;
+    return (pixelsPerSample > 1.0 ? (NSUInteger)ceil(sqrt(pixelsPerSample)) : 1);
+}
+
+static NSUInteger MUKImagePaletteSamplePixels(uint8_t const *bytes, NSUInteger width, NSUInteger height, NSUInteger bytesPerRow, NSUInteger step, BOOL premultiplied, uint32_t *samples)
+{
+    NSUInteger count = 0;
+    
+    // Samples are taken at the center of every step x step cell
+    for (NSUInteger y = step/2; y < height; y += step) {
+        uint8_t const *row = bytes + y * bytesPerRow;
+        
+        for (NSUInteger x = step/2; x < width; x += step) {
+            uint8_t const *pixel = row + 4 * x;
+            uint32_t const alpha = pixel[3];
+            if (alpha < MUK_IMAGE_PALETTE_MINIMUM_ALPHA) continue;
+            
+            uint32_t red = pixel[0], green = pixel[1], blue = pixel[2];
+            
+            if (premultiplied && alpha < 255) {
+                red = MIN(255, (red * 255 + alpha/2) / alpha);
+                green = MIN(255, (green * 255 + alpha/2) / alpha);
+                blue = MIN(255, (blue * 255 + alpha/2) / alpha);
+            }
+            
+            samples[count++] = (red << 16) | (green << 8) | blue;
+        } // for
+    } // for
+    
+    return count;
+}
+
+static void MUKImagePaletteShrinkBox(MUKImagePaletteBox *box, uint32_t const *samples)
+{
+    for (NSUInteger c = 0; c < 3; c++) {
+        box->minimum[c] = 255;
+        box->maximum[c] = 0;
+    } // for
+    
+    for (NSUInteger i = box->start; i < box->start + box->count; i++) {
+        for (NSUInteger c = 0; c < 3; c++) {
+            uint8_t const value = MUK_IMAGE_PALETTE_CHANNEL(samples[i], c);
+            box->minimum[c] = MIN(box->minimum[c], value);
+            box->maximum[c] = MAX(box->maximum[c], value);
+        } // for
+    } // for
+}
+
+NS_INLINE NSUInteger MUKImagePaletteBoxLongestChannel(MUKImagePaletteBox const *box) {
+    NSUInteger channel = 0;
+    
+    for (NSUInteger c = 1; c < 3; c++) {
+        if (box->maximum[c] - box->minimum[c] > box->maximum[channel] - box->minimum[channel])
+        {
+            channel = c;
+        }
+    } // for
+    
+    return channel;
+}
+
+// Splits box in two halves at the median of its longest channel
+static void MUKImagePaletteSplitBox(MUKImagePaletteBox *box, MUKImagePaletteBox *newBox, uint32_t *samples)
+{
+    NSUInteger const channel = MUKImagePaletteBoxLongestChannel(box);
+    NSUInteger const end = box->start + box->count;
+    NSUInteger histogram[256];
+    
+    // Channel has 256 values: counting finds median without sorting
+    memset(histogram, 0, sizeof(histogram));
+    for (NSUInteger i = box->start; i < end; i++) {
+        histogram[MUK_IMAGE_PALETTE_CHANNEL(samples[i], channel)]++;
+    } // for
+    
+    NSUInteger median = 0, cumulativeCount = 0;
+    for (; median < 255; median++) {
+        cumulativeCount += histogram[median];
+        if (cumulativeCount * 2 >= box->count) break;
+    } // for
+    
+    // Lower half keeps values up to median, unless it would take them all
+    if (median == box->maximum[channel]) median--;
+    
+    NSUInteger lowerEnd = box->start;
+    for (NSUInteger i = box->start; i < end; i++) {
+        if (MUK_IMAGE_PALETTE_CHANNEL(samples[i], channel) <= median) {
+            uint32_t const sample = samples[i];
+            samples[i] = samples[lowerEnd];
+            samples[lowerEnd++] = sample;
+        }
+    } // for
+    
+    newBox->start = lowerEnd;
+    newBox->count = end - lowerEnd;
+    box->count = lowerEnd - box->start;
+    
+    MUKImagePaletteShrinkBox(box, samples);
+    MUKImagePaletteShrinkBox(newBox, samples);
+}
+
+static NSUInteger MUKImagePaletteMedianCut(uint32_t *samples, NSUInteger samplesCount, MUKImagePaletteCluster *clusters, NSUInteger maximumClustersCount)
+{
+    if (samplesCount == 0 || maximumClustersCount == 0) return 0;
+    
+    MUKImagePaletteBox *boxes = malloc(maximumClustersCount * sizeof(MUKImagePaletteBox));
+    NSUInteger boxesCount = 1;
+    
+    boxes[0].start = 0;
+    boxes[0].count = samplesCount;
+    MUKImagePaletteShrinkBox(&boxes[0], samples);
+    
+    while (boxesCount < maximumClustersCount) {
+        // Split the box which spreads most, weighted by its population
+        NSUInteger bestIndex = NSNotFound;
+        double bestPriority = 0.0;
+        
+        for (NSUInteger i = 0; i < boxesCount; i++) {
+            NSUInteger const channel = MUKImagePaletteBoxLongestChannel(&boxes[i]);
+            double const priority = (double)(boxes[i].maximum[channel] - boxes[i].minimum[channel]) * (double)boxes[i].count;
+            
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                bestIndex = i;
+            }
+        } // for
+        
+        // Every box holds a single color
+        if (bestIndex == NSNotFound) break;
+        
+        MUKImagePaletteSplitBox(&boxes[bestIndex], &boxes[boxesCount], samples);
+        boxesCount++;
+    } // while
+    
+    for (NSUInteger b = 0; b < boxesCount; b++) {
+        double sums[3] = { 0.0, 0.0, 0.0 };
+        NSUInteger const end = boxes[b].start + boxes[b].count;
+        
+        for (NSUInteger i = boxes[b].start; i < end; i++) {
+            for (NSUInteger c = 0; c < 3; c++) {
+                sums[c] += MUK_IMAGE_PALETTE_CHANNEL(samples[i], c);
+            } // for
+        } // for
+        
+        for (NSUInteger c = 0; c < 3; c++) {
+            clusters[b].components[c] = (float)(sums[c] / boxes[b].count);
+        } // for
+        
+        clusters[b].population = boxes[b].count;
+    } // for
+    
+    free(boxes);
+    return boxesCount;
+}
+
+// Lloyd iterations, starting from median cut clusters
+static void MUKImagePaletteRefineClusters(uint32_t const *samples, NSUInteger samplesCount, MUKImagePaletteCluster *clusters, NSUInteger clustersCount)
+{
+    if (clustersCount < 2) return;
+    
+    double (*sums)[3] = malloc(clustersCount * sizeof(*sums));
+    NSUInteger *populations = malloc(clustersCount * sizeof(NSUInteger));
+    
+    for (NSUInteger iteration = 0; iteration < MUK_IMAGE_PALETTE_KMEANS_ITERATIONS; iteration++)
+    {
+        memset(sums, 0, clustersCount * sizeof(*sums));
+        memset(populations, 0, clustersCount * sizeof(NSUInteger));
+        
+        for (NSUInteger i = 0; i < samplesCount; i++) {
+            float const red = MUK_IMAGE_PALETTE_CHANNEL(samples[i], 0);
+            float const green = MUK_IMAGE_PALETTE_CHANNEL(samples[i], 1);
+            float const blue = MUK_IMAGE_PALETTE_CHANNEL(samples[i], 2);
+            
+            NSUInteger nearest = 0;
+            float nearestDistance = FLT_MAX;
+            
+            for (NSUInteger k = 0; k < clustersCount; k++) {
+                float const dr = red - clusters[k].components[0];
+                float const dg = green - clusters[k].components[1];
+                float const db = blue - clusters[k].components[2];
+                float const distance = dr * dr + dg * dg + db * db;
+                
+                if (distance < nearestDistance) {
+                    nearestDistance = distance;
+                    nearest = k;
+                }
+            } // for
+            
+            sums[nearest][0] += red;
+            sums[nearest][1] += green;
+            sums[nearest][2] += blue;
+            populations[nearest]++;
+        } // for
+        
+        BOOL moved = NO;
+        
+        for (NSUInteger k = 0; k < clustersCount; k++) {
+            // Empty clusters keep their color and lose their weight
+            if (populations[k] > 0) {
+                for (NSUInteger c = 0; c < 3; c++) {
+                    float const component = (float)(sums[k][c] / populations[k]);
+                    moved = moved || (fabsf(component - clusters[k].components[c]) > 0.5f);
+                    clusters[k].components[c] = component;
+                } // for
+            }
+            
+            clusters[k].population = populations[k];
+        } // for
+        
+        if (!moved) break;
+    } // for
+    
+    free(sums);
+    free(populations);
+}
+
+// Merges clusters which look the same, keeping heavier colors first
+static NSUInteger MUKImagePaletteMergeClusters(MUKImagePaletteCluster *clusters, NSUInteger clustersCount)
+{
+    float const maximumDistance = MUK_IMAGE_PALETTE_MERGE_DISTANCE * MUK_IMAGE_PALETTE_MERGE_DISTANCE;
+    NSUInteger count = 0;
+    
+    for (NSUInteger i = 0; i < clustersCount; i++) {
+        if (clusters[i].population == 0) continue;
+        
+        BOOL merged = NO;
+        
+        for (NSUInteger k = 0; k < count && !merged; k++) {
+            float distance = 0.0f;
+            for (NSUInteger c = 0; c < 3; c++) {
+                float const delta = clusters[i].components[c] - clusters[k].components[c];
+                distance += delta * delta;
+            } // for
+            
+            if (distance <= maximumDistance) {
+                NSUInteger const population = clusters[k].population + clusters[i].population;
+                
+                for (NSUInteger c = 0; c < 3; c++) {
+                    clusters[k].components[c] = (clusters[k].components[c] * clusters[k].population + clusters[i].components[c] * clusters[i].population) / population;
+                } // for
+                
+                clusters[k].population = population;
+                merged = YES;
+            }
+        } // for
+        
+        if (!merged) {
+            clusters[count++] = clusters[i];
+        }
+    } // for
+    
+    return count;
+}
+
+static int MUKImagePaletteCompareClusters(void const *a, void const *b) {
+    NSUInteger const populationA = ((MUKImagePaletteCluster const *)a)->population;
+    NSUInteger const populationB = ((MUKImagePaletteCluster const *)b)->population;
+    
+    // Descending population
+    return (populationA < populationB) - (populationA > populationB);
+}
+
+@implementation MUKImagePalette {
+    CGFloat *weights_;
+}
+
+@synthesize colors = colors_;
+@synthesize samplesCount = samplesCount_;
+
+- (id)initWithRGBABytes:(void const *)bytes width:(NSUInteger)width height:(NSUInteger)height bytesPerRow:(NSUInteger)bytesPerRow maximumColorsCount:(NSUInteger)maximumColorsCount options:(MUKImagePaletteOptions)options
+{
+    self = [super init];
+    if (self) {
+        if (bytes == NULL || width == 0 || height == 0) {
+            colors_ = @[];
+            return self;
+        }
+        
+        NSUInteger const step = MUKImagePaletteSamplingStep(width, height, MUK_IMAGE_PALETTE_MAXIMUM_SAMPLES_COUNT);
+        NSUInteger const samplesCapacity = ((width + step - 1) / step) * ((height + step - 1) / step);
+        uint32_t *samples = malloc(samplesCapacity * sizeof(uint32_t));
+        BOOL const premultiplied = MUKBitmaskContainsFlag(options, MUKImagePaletteOptionPremultipliedAlpha);
+        
+        samplesCount_ = MUKImagePaletteSamplePixels(bytes, width, height, bytesPerRow, step, premultiplied, samples);
+        
+        MUKImagePaletteCluster *clusters = malloc(MAX(maximumColorsCount, (NSUInteger)1) * sizeof(MUKImagePaletteCluster));
+        NSUInteger clustersCount = MUKImagePaletteMedianCut(samples, samplesCount_, clusters, maximumColorsCount);
+        
+        if (MUKBitmaskContainsFlag(options, MUKImagePaletteOptionRefine)) {
+            MUKImagePaletteRefineClusters(samples, samplesCount_, clusters, clustersCount);
+        }
+        
+        // Heavier clusters absorb lighter ones
+        qsort(clusters, clustersCount, sizeof(MUKImagePaletteCluster), MUKImagePaletteCompareClusters);
+        clustersCount = MUKImagePaletteMergeClusters(clusters, clustersCount);
+        qsort(clusters, clustersCount, sizeof(MUKImagePaletteCluster), MUKImagePaletteCompareClusters);
+        
+        NSMutableArray *colors = [[NSMutableArray alloc] initWithCapacity:clustersCount];
+        weights_ = malloc(MAX(clustersCount, (NSUInteger)1) * sizeof(CGFloat));
+        
+        for (NSUInteger i = 0; i < clustersCount; i++) {
+            UIColor *color = [UIColor colorWithRed:clusters[i].components[0]/255.0f green:clusters[i].components[1]/255.0f blue:clusters[i].components[2]/255.0f alpha:1.0f];
+            [colors addObject:color];
+            weights_[i] = (CGFloat)clusters[i].population / (CGFloat)samplesCount_;
+        } // for
+        
+        colors_ = [colors copy];
+        
+        free(clusters);
+        free(samples);
+    }
+    
+    return self;
+}
+
+- (id)initWithImage:(UIImage *)image maximumColorsCount:(NSUInteger)maximumColorsCount options:(MUKImagePaletteOptions)options
+{
+    CGImageRef cgImage = image.CGImage;
+    size_t const imageWidth = (cgImage ? CGImageGetWidth(cgImage) : 0);
+    size_t const imageHeight = (cgImage ? CGImageGetHeight(cgImage) : 0);
+    
+    if (imageWidth == 0 || imageHeight == 0) {
+        return [self initWithRGBABytes:NULL width:0 height:0 bytesPerRow:0 maximumColorsCount:maximumColorsCount options:options];
+    }
+    
+    // Draw image as big as samples, so every pixel is a sample
+    NSUInteger const step = MUKImagePaletteSamplingStep(imageWidth, imageHeight, MUK_IMAGE_PALETTE_MAXIMUM_SAMPLES_COUNT);
+    size_t const width = MAX((size_t)1, imageWidth / step);
+    size_t const height = MAX((size_t)1, imageHeight / step);
+    size_t const bytesPerRow = width * 4;
+    void *bytes = calloc(height, bytesPerRow);
+    
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(bytes, width, height, 8, bytesPerRow, colorSpace, (CGBitmapInfo)kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big);
+    CGColorSpaceRelease(colorSpace);
+    
+    if (context) {
+        CGContextSetInterpolationQuality(context, kCGInterpolationLow);
+        CGContextDrawImage(context, CGRectMake(0.0f, 0.0f, width, height), cgImage);
+        CGContextRelease(context);
+    }
+    
+    self = [self initWithRGBABytes:bytes width:width height:height bytesPerRow:bytesPerRow maximumColorsCount:maximumColorsCount options:(options | MUKImagePaletteOptionPremultipliedAlpha)];
+    
+    free(bytes);
+    return self;
+}
+
+- (id)init {
+    return [self initWithRGBABytes:NULL width:0 height:0 bytesPerRow:0 maximumColorsCount:0 options:MUKImagePaletteOptionNone];
+}
+
+- (void)dealloc {
+    free(weights_);
+}
+
+- (UIColor *)dominantColor {
+    return ([colors_ count] > 0 ? [colors_ objectAtIndex:0] : nil);
+}
+
+- (CGFloat)weightOfColorAtIndex:(NSUInteger)index {
+    if (index >= [colors_ count]) {
+        [NSException raise:NSRangeException format:@"Index %lu out of bounds [0, %lu)", (unsigned long)index, (unsigned long)[colors_ count]];
+    }
+    
+    return weights_[index];
+}
+
+@end
@@ -0,0 +1,149 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+
+/**
+ Kernels which convert pixels with four 8-bit channels.
+ 
+ Kernels work on runs of `count` contiguous pixels: process a buffer whose
+ rows are padded row by row. They process four pixels at once with vector
+ instructions (lookup tables are used pixel by pixel) and they never 
+ allocate memory, so you can call them on background threads.
+ 
+ Blend in linear space to avoid dark fringes of sRGB blending:
+    
+    MUKPixelsUnpremultiply(row, MUKPixelFormatBGRA8888, width);
+    MUKPixelsConvertSRGBToLinear(row, linearRow, MUKPixelFormatBGRA8888, width);
+    MUKPixelsBlendLinear(linearRow, otherLinearRow, MUKPixelFormatBGRA8888, width, 0.5f);
+    MUKPixelsConvertLinearToSRGB(linearRow, row, MUKPixelFormatBGRA8888, width);
+    MUKPixelsPremultiply(row, MUKPixelFormatBGRA8888, width);
+ 
+ ## Constants
+ 
+ `MUKPixelFormat` enumerates orders of channels in memory:
+ 
+ * `MUKPixelFormatRGBA8888` is red, green, blue, alpha (`CGBitmapContext` 
+ with `kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big`).
+ * `MUKPixelFormatARGB8888` is alpha, red, green, blue.
+ * `MUKPixelFormatBGRA8888` is blue, green, red, alpha (`UIGraphics` image
+ contexts on iOS).
+ 
+ Linear pixels have four 16-bit channels in the same order.
+ */
+typedef enum : NSUInteger {
+    MUKPixelFormatRGBA8888 = 0,
+    MUKPixelFormatARGB8888,
+    MUKPixelFormatBGRA8888
+} MUKPixelFormat;
+
+/**
+ Converts a sRGB encoded component to linear light.
+ @param value Component between `0.0` and `1.0`.
+ @return Linear component between `0.0` and `1.0`.
+ */
+NS_INLINE CGFloat MUKPixelSRGBToLinear(CGFloat value) {
+    return (value <= 0.04045f ? value / 12.92f : pow((value + 0.055f) / 1.055f, 2.4f));
+}
+
+/**
+ Converts a linear component to sRGB encoding.
+ @param value Linear component between `0.0` and `1.0`.
+ @return sRGB encoded component between `0.0` and `1.0`.
+ */
+NS_INLINE CGFloat MUKPixelLinearToSRGB(CGFloat value) {
+    return (value <= 0.0031308f ? value * 12.92f : 1.055f * pow(value, 1.0f / 2.4f) - 0.055f);
+}
+
+/**
+ Reorders channels of pixels.
+ @param source Source pixels.
+ @param sourceFormat Order of channels of `source`.
+ @param destination Destination pixels. It could be `source` itself.
+ @param destinationFormat Order of channels of `destination`.
+ @param count Number of pixels.
+ */
+extern void MUKPixelsSwizzle(void const *source, MUKPixelFormat sourceFormat, void *destination, MUKPixelFormat destinationFormat, NSUInteger count);
+
+/**
+ Multiplies color channels by alpha, in place.
+ 
+ Results are rounded like `(c * a + 127) / 255`, without divisions.
+ 
+ @param pixels Pixels to premultiply.
+ @param format Order of channels.
+ @param count Number of pixels.
+ */
+extern void MUKPixelsPremultiply(void *pixels, MUKPixelFormat format, NSUInteger count);
+/**
+ Divides color channels by alpha, in place.
+ 
+ Pixels with zero alpha are left untouched.
+ 
+ @param pixels Premultiplied pixels.
+ @param format Order of channels.
+ @param count Number of pixels.
+ */
+extern void MUKPixelsUnpremultiply(void *pixels, MUKPixelFormat format, NSUInteger count);
+
+/**
+ Converts sRGB encoded pixels to linear light.
+ 
+ Color channels go through a lookup table, alpha is scaled to 16 bits. 
+ Converting back with MUKPixelsConvertLinearToSRGB() gives original pixels.
+ 
+ @param source Pixels with 8-bit channels, which must not be premultiplied.
+ @param destination Linear pixels, with 16-bit channels.
+ @param format Order of channels of both buffers.
+ @param count Number of pixels.
+ */
+extern void MUKPixelsConvertSRGBToLinear(void const *source, uint16_t *destination, MUKPixelFormat format, NSUInteger count);
+/**
+ Converts linear pixels to sRGB encoding.
+ 
+ Color channels go through a lookup table indexed by their 12 most 
+ significant bits.
+ 
+ @param source Linear pixels, with 16-bit channels.
+ @param destination Pixels with 8-bit channels. They are not premultiplied.
+ @param format Order of channels of both buffers.
+ @param count Number of pixels.
+ */
+extern void MUKPixelsConvertLinearToSRGB(uint16_t const *source, void *destination, MUKPixelFormat format, NSUInteger count);
+/**
+ Blends two runs of linear pixels.
+ 
+ Colors are interpolated weighted by their alpha, so transparent pixels do
+ not darken the result.
+ 
+ @param destination Linear pixels, which are replaced with the blend.
+ @param source Linear pixels to blend into `destination`.
+ @param format Order of channels of both buffers.
+ @param count Number of pixels.
+ @param fraction How much of `source` goes into the blend, between `0.0` and
+ `1.0`.
+ */
+extern void MUKPixelsBlendLinear(uint16_t *destination, uint16_t const *source, MUKPixelFormat format, NSUInteger count, CGFloat fraction);
@@ -0,0 +1,275 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUKPixelKernels.h"
+
+typedef uint32_t MUKPixelVector __attribute__((vector_size(16)));
+
+#define MUK_PIXEL_VECTOR_PIXELS     (sizeof(MUKPixelVector) / sizeof(uint32_t))
+
+// Linear values are looked up by their 12 most significant bits
+#define MUK_PIXEL_LINEAR_TABLE_BITS 12
+
+static uint16_t MUKPixelSRGBToLinearTable[256];
+static uint8_t MUKPixelLinearToSRGBTable[1 << MUK_PIXEL_LINEAR_TABLE_BITS];
+static uint32_t MUKPixelUnpremultiplyTable[256];      // 255 / alpha, 8.24 fixed point
+
+// Byte offset of red, green, blue and alpha into a pixel
+static uint8_t const MUKPixelChannelOffsets[3][4] = {
+    { 0, 1, 2, 3 },     // RGBA
+    { 1, 2, 3, 0 },     // ARGB
+    { 2, 1, 0, 3 }      // BGRA
+};
+
+static void MUKPixelBuildTables(void) {
+    for (NSUInteger i = 0; i < 256; i++) {
+        MUKPixelSRGBToLinearTable[i] = (uint16_t)lrint(MUKPixelSRGBToLinear(i / 255.0f) * 65535.0f);
+        MUKPixelUnpremultiplyTable[i] = (i == 0 ? 0 : (uint32_t)(((255ull << 24) + i/2) / i));
+    } // for
+    
+    NSUInteger const count = 1 << MUK_PIXEL_LINEAR_TABLE_BITS;
+    for (NSUInteger i = 0; i < count; i++) {
+        // Center of the interval of linear values which share this entry
+        float const linear = ((float)i + 0.5f) / (float)count;
+        MUKPixelLinearToSRGBTable[i] = (uint8_t)lrint(MUKPixelLinearToSRGB(linear) * 255.0f);
+    } // for
+}
+
+NS_INLINE MUKPixelVector MUKPixelLoadVector(uint8_t const *bytes) {
+    MUKPixelVector vector;
+    memcpy(&vector, bytes, sizeof(vector));
+    return vector;
+}
+
+NS_INLINE void MUKPixelStoreVector(uint8_t *bytes, MUKPixelVector vector) {
+    memcpy(bytes, &vector, sizeof(vector));
+}
+
+NS_INLINE uint32_t MUKPixelLoad(uint8_t const *bytes) {
+    uint32_t pixel;
+    memcpy(&pixel, bytes, sizeof(pixel));
+    return pixel;
+}
+
+NS_INLINE void MUKPixelStore(uint8_t *bytes, uint32_t pixel) {
+    memcpy(bytes, &pixel, sizeof(pixel));
+}
+
+// Pixels are read as 32-bit words: byte offsets become shifts on little
+// endian architectures (every iOS device)
+#define MUK_PIXEL_CHANNEL(pixel, offset)    (((pixel) >> (8 * (offset))) & 0xFF)
+
+// Multiplies three 8-bit components (low 24 bits) by alpha, rounding like
+// (c * a + 127) / 255: two components share a word, 16 bits each
+NS_INLINE uint32_t MUKPixelMultiplyComponents(uint32_t components, uint32_t alpha) {
+    uint32_t redBlue = (components & 0x00FF00FF) * alpha + 0x00800080;
+    uint32_t green = ((components >> 8) & 0xFF) * alpha + 0x80;
+    redBlue = ((redBlue + ((redBlue >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+    green = ((green + (green >> 8)) >> 8) & 0xFF;
+    return redBlue | (green << 8);
+}
+
+NS_INLINE MUKPixelVector MUKPixelMultiplyComponentsVector(MUKPixelVector components, MUKPixelVector alpha) {
+    MUKPixelVector redBlue = (components & 0x00FF00FF) * alpha + 0x00800080;
+    MUKPixelVector green = ((components >> 8) & 0xFF) * alpha + 0x80;
+    redBlue = ((redBlue + ((redBlue >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+    green = ((green + (green >> 8)) >> 8) & 0xFF;
+    return redBlue | (green << 8);
+}
+
+static void MUKPixelSwizzleBytes(uint8_t const *source, uint8_t const sourceOffsets[4], uint8_t *destination, uint8_t const destinationOffsets[4], NSUInteger count)
+{
+    NSUInteger i = 0;
+    
+    for (; i + MUK_PIXEL_VECTOR_PIXELS <= count; i += MUK_PIXEL_VECTOR_PIXELS)
+    {
+        MUKPixelVector const pixels = MUKPixelLoadVector(source + 4 * i);
+        MUKPixelVector result = { 0, 0, 0, 0 };
+        
+        for (NSUInteger c = 0; c < 4; c++) {
+            result |= MUK_PIXEL_CHANNEL(pixels, sourceOffsets[c]) << (8 * destinationOffsets[c]);
+        } // for
+        
+        MUKPixelStoreVector(destination + 4 * i, result);
+    } // for
+    
+    for (; i < count; i++) {
+        uint32_t const pixel = MUKPixelLoad(source + 4 * i);
+        uint32_t result = 0;
+        
+        for (NSUInteger c = 0; c < 4; c++) {
+            result |= MUK_PIXEL_CHANNEL(pixel, sourceOffsets[c]) << (8 * destinationOffsets[c]);
+        } // for
+        
+        MUKPixelStore(destination + 4 * i, result);
+    } // for
+}
+
+static void MUKPixelPremultiplyBytes(uint8_t *pixels, uint8_t const offsets[4], NSUInteger count)
+{
+    // Color components are contiguous, before or after alpha
+    NSUInteger const alphaShift = 8 * offsets[3];
+    NSUInteger const componentsShift = (offsets[3] == 0 ? 8 : 0);
+    NSUInteger i = 0;
+    
+    for (; i + MUK_PIXEL_VECTOR_PIXELS <= count; i += MUK_PIXEL_VECTOR_PIXELS)
+    {
+        MUKPixelVector const vector = MUKPixelLoadVector(pixels + 4 * i);
+        MUKPixelVector const alpha = (vector >> alphaShift) & 0xFF;
+        MUKPixelVector const components = MUKPixelMultiplyComponentsVector(vector >> componentsShift, alpha);
+        MUKPixelStoreVector(pixels + 4 * i, (components << componentsShift) | (alpha << alphaShift));
+    } // for
+    
+    for (; i < count; i++) {
+        uint32_t const pixel = MUKPixelLoad(pixels + 4 * i);
+        uint32_t const alpha = (pixel >> alphaShift) & 0xFF;
+        uint32_t const components = MUKPixelMultiplyComponents(pixel >> componentsShift, alpha);
+        MUKPixelStore(pixels + 4 * i, (components << componentsShift) | (alpha << alphaShift));
+    } // for
+}
+
+static void MUKPixelUnpremultiplyBytes(uint8_t *pixels, uint8_t const offsets[4], NSUInteger count)
+{
+    NSUInteger const alphaOffset = offsets[3];
+    
+    // Reciprocals are looked up pixel by pixel: vector units can not 
+    // divide integers nor gather
+    for (NSUInteger i = 0; i < count; i++) {
+        uint8_t *pixel = pixels + 4 * i;
+        uint32_t const alpha = pixel[alphaOffset];
+        if (alpha == 255) continue;
+        
+        uint64_t const reciprocal = MUKPixelUnpremultiplyTable[alpha];
+        
+        for (NSUInteger c = 0; c < 3; c++) {
+            uint32_t const component = (uint32_t)((pixel[offsets[c]] * reciprocal + (1 << 23)) >> 24);
+            pixel[offsets[c]] = (uint8_t)MIN(component, (uint32_t)255);
+        } // for
+    } // for
+}
+
+static void MUKPixelConvertBytesToLinear(uint8_t const *source, uint16_t *destination, uint8_t const offsets[4], NSUInteger count)
+{
+    NSUInteger const alphaOffset = offsets[3];
+    
+    for (NSUInteger i = 0; i < 4 * count; i += 4) {
+        for (NSUInteger c = 0; c < 3; c++) {
+            destination[i + offsets[c]] = MUKPixelSRGBToLinearTable[source[i + offsets[c]]];
+        } // for
+        
+        destination[i + alphaOffset] = (uint16_t)(source[i + alphaOffset] * 257);
+    } // for
+}
+
+static void MUKPixelConvertLinearToBytes(uint16_t const *source, uint8_t *destination, uint8_t const offsets[4], NSUInteger count)
+{
+    NSUInteger const alphaOffset = offsets[3];
+    NSUInteger const shift = 16 - MUK_PIXEL_LINEAR_TABLE_BITS;
+    
+    for (NSUInteger i = 0; i < 4 * count; i += 4) {
+        for (NSUInteger c = 0; c < 3; c++) {
+            destination[i + offsets[c]] = MUKPixelLinearToSRGBTable[source[i + offsets[c]] >> shift];
+        } // for
+        
+        destination[i + alphaOffset] = (uint8_t)((source[i + alphaOffset] + 128) / 257);
+    } // for
+}
+
+static void MUKPixelBlendLinearPixels(uint16_t *destination, uint16_t const *source, uint8_t const offsets[4], NSUInteger count, float fraction)
+{
+    NSUInteger const alphaOffset = offsets[3];
+    
+    for (NSUInteger i = 0; i < 4 * count; i += 4) {
+        // Interpolate premultiplied colors, so weight of a color follows its
+        // coverage
+        float const destinationAlpha = destination[i + alphaOffset] * (1.0f - fraction);
+        float const sourceAlpha = source[i + alphaOffset] * fraction;
+        float const alpha = destinationAlpha + sourceAlpha;
+        
+        for (NSUInteger c = 0; c < 3; c++) {
+            NSUInteger const offset = offsets[c];
+            float component;
+            
+            if (alpha > 0.0f) {
+                component = (destination[i + offset] * destinationAlpha + source[i + offset] * sourceAlpha) / alpha;
+            }
+            else {
+                // Invisible anyway: keep a plain interpolation
+                component = destination[i + offset] + (source[i + offset] - destination[i + offset]) * fraction;
+            }
+            
+            destination[i + offset] = (uint16_t)MIN(lrintf(component), 65535L);
+        } // for
+        
+        destination[i + alphaOffset] = (uint16_t)MIN(lrintf(alpha), 65535L);
+    } // for
+}
+
+NS_INLINE uint8_t const *MUKPixelOffsets(MUKPixelFormat format) {
+    return MUKPixelChannelOffsets[format];
+}
+
+NS_INLINE void MUKPixelPrepareTables(void) {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        MUKPixelBuildTables();
+    });
+}
+
+#pragma mark - Kernels
+
+void MUKPixelsSwizzle(void const *source, MUKPixelFormat sourceFormat, void *destination, MUKPixelFormat destinationFormat, NSUInteger count)
+{
+    MUKPixelSwizzleBytes(source, MUKPixelOffsets(sourceFormat), destination, MUKPixelOffsets(destinationFormat), count);
+}
+
+void MUKPixelsPremultiply(void *pixels, MUKPixelFormat format, NSUInteger count) 
+{
+    MUKPixelPremultiplyBytes(pixels, MUKPixelOffsets(format), count);
+}
+
+void MUKPixelsUnpremultiply(void *pixels, MUKPixelFormat format, NSUInteger count)
+{
+    MUKPixelPrepareTables();
+    MUKPixelUnpremultiplyBytes(pixels, MUKPixelOffsets(format), count);
+}
+
+void MUKPixelsConvertSRGBToLinear(void const *source, uint16_t *destination, MUKPixelFormat format, NSUInteger count)
+{
+    MUKPixelPrepareTables();
+    MUKPixelConvertBytesToLinear(source, destination, MUKPixelOffsets(format), count);
+}
+
+void MUKPixelsConvertLinearToSRGB(uint16_t const *source, void *destination, MUKPixelFormat format, NSUInteger count)
+{
+    MUKPixelPrepareTables();
+    MUKPixelConvertLinearToBytes(source, destination, MUKPixelOffsets(format), count);
+}
+
+void MUKPixelsBlendLinear(uint16_t *destination, uint16_t const *source, MUKPixelFormat format, NSUInteger count, CGFloat fraction)
+{
+    float const clampedFraction = (float)MAX(0.0, MIN(fraction, 1.0));
+    MUKPixelBlendLinearPixels(destination, source, MUKPixelOffsets(format), count, clampedFraction);
+}
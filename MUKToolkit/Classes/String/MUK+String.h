@@ -94,6 +94,29 @@ typedef enum : NSUInteger {
  @return A string produced applying transform on given string.
  */
 + (NSString *)string:(NSString *)string applyingTransform:(MUKStringTransform)transform;
+/**
+ It transforms many strings with a chain of transforms.
+ 
+ Every string goes through every transform, in order: result is the same
+ you would get calling +string:applyingTransform: repeatedly, but chains 
+ are cheaper. Reversals, first letter uppercasing and hashes run on 
+ scratch buffers which are reused from string to string, so they do not 
+ allocate intermediate strings; chained hashes are computed straight from
+ previous digest. Strings are split in chunks transformed concurrently on
+ every core.
+ 
+ ** Example **
+    
+    NSArray *keys = [MUK strings:names applyingTransforms:@[@(MUKStringTransformNormalize), @(MUKStringTransformSHA1)]];
+ 
+ @param strings Strings to transform. Objects which are not strings are 
+ treated like `nil`.
+ @param transforms `NSNumber` objects wrapping `MUKStringTransform` values.
+ @return An array with the same count of strings, where transformed 
+ strings are in the same order. `nil` results (e.g. a malformed string to
+ URL decode) are represented by `NSNull`.
+ */
++ (NSArray *)strings:(NSArray *)strings applyingTransforms:(NSArray *)transforms;
 /**
  Hexadecimal (`%02x`) representation of bytes contained in data.
  @param data Data to convert to hex.
@@ -24,12 +24,55 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #import "MUK+String.h"
+#import "MUKDigest.h"
 #import "MUK+Data.h"
+#import "MUK+Instrumentation.h"
+
+// Strings transformed by a single batch chunk, at least
+#define MUK_STRING_BATCH_MINIMUM_CHUNK_SIZE 64
+
+// Minimum number of chunks per core, to balance load
+#define MUK_STRING_BATCH_CHUNKS_PER_CORE    4
+
+// Longest digest (SHA-1), as lowercase hex
+#define MUK_STRING_HEX_DIGEST_MAXIMUM_LENGTH    (2 * CC_SHA1_DIGEST_LENGTH)
+
+// Buffers reused by a chunk of a batch, from string to string
+typedef struct {
+    unichar *characters;
+    NSUInteger charactersCapacity;
+    uint8_t *bytes;
+    NSUInteger bytesCapacity;
+    
+    // Last digest, when it has not been turned into a string yet
+    char hexDigest[MUK_STRING_HEX_DIGEST_MAXIMUM_LENGTH];
+    NSUInteger hexDigestLength;
+} MUKStringScratch;
+
+static BOOL MUKStringScratchReserve(void **buffer, NSUInteger *capacity, NSUInteger size)
+{
+    if (size <= *capacity) return YES;
+    
+    NSUInteger const newCapacity = MAX(size, 2 * (*capacity));
+    void *newBuffer = realloc(*buffer, newCapacity);
+    if (!newBuffer) return NO;
+    
+    *buffer = newBuffer;
+    *capacity = newCapacity;
+    return YES;
+}
+
+NS_INLINE NSString *MUKStringScratchHexDigestString(MUKStringScratch *scratch) {
+    NSString *string = [[NSString alloc] initWithBytes:scratch->hexDigest length:scratch->hexDigestLength encoding:NSASCIIStringEncoding];
+    scratch->hexDigestLength = 0;
+    return string;
+}
 
 @implementation MUK (String)
 
 + (void)string:(NSString *)string enumerateCharactersWithOptions:(MUKStringEnumerationOptions)options usingBlock:(void (^)(unichar c, NSInteger index, BOOL *stop))enumerator
 {
+    MUK_INSTRUMENT([string length] * sizeof(unichar));
     NSUInteger len = [string length];
     
     if (len > 0 && enumerator) {
@@ -58,6 +101,7 @@
 
 + (NSString *)string:(NSString *)string applyingTransform:(MUKStringTransform)transform
 {
+    MUK_INSTRUMENT([string length] * sizeof(unichar));
     NSString *output = string;
     
     switch (transform) {
@@ -140,7 +184,78 @@
     return output;
 }
 
++ (NSArray *)strings:(NSArray *)strings applyingTransforms:(NSArray *)transforms
+{
+    NSUInteger const count = [strings count];
+    MUK_INSTRUMENT(count * sizeof(id));
+    if (count == 0) return @[];
+    
+    // Identities are dropped and adjacent reversals cancel out
+    NSUInteger const transformsCount = [transforms count];
+    MUKStringTransform *chain = (MUKStringTransform *)malloc(MAX(transformsCount, (NSUInteger)1) * sizeof(MUKStringTransform));
+    NSUInteger chainLength = 0;
+    
+    for (NSNumber *transformNumber in transforms) {
+        MUKStringTransform const transform = [transformNumber unsignedIntegerValue];
+        
+        if (transform == MUKStringTransformIdentity) {
+            continue;
+        }
+        else if (transform == MUKStringTransformReverse && chainLength > 0 && chain[chainLength - 1] == MUKStringTransformReverse)
+        {
+            chainLength--;
+        }
+        else {
+            chain[chainLength++] = transform;
+        }
+    } // for
+    
+    __unsafe_unretained id *objects = (__unsafe_unretained id *)malloc(count * sizeof(id));
+    __strong id *results = (__strong id *)calloc(count, sizeof(id));
+    [strings getObjects:objects range:NSMakeRange(0, count)];
+    
+    NSUInteger const minimumChunksCount = [[NSProcessInfo processInfo] activeProcessorCount] * MUK_STRING_BATCH_CHUNKS_PER_CORE;
+    NSUInteger const chunkSize = MAX((NSUInteger)MUK_STRING_BATCH_MINIMUM_CHUNK_SIZE, (count + minimumChunksCount - 1) / minimumChunksCount);
+    NSUInteger const chunksCount = (count + chunkSize - 1) / chunkSize;
+    
+    void (^transformChunk)(size_t) = ^(size_t chunk) {
+        NSUInteger const chunkStart = chunk * chunkSize;
+        NSUInteger const chunkEnd = MIN(chunkStart + chunkSize, count);
+        MUKStringScratch scratch = { NULL, 0, NULL, 0, { 0 }, 0 };
+        
+        @autoreleasepool {
+            for (NSUInteger i = chunkStart; i < chunkEnd; i++) {
+                NSString *string = ([objects[i] isKindOfClass:[NSString class]] ? objects[i] : nil);
+                results[i] = [self string_:string applyingTransforms:chain count:chainLength scratch:&scratch];
+            } // for
+        }
+        
+        free(scratch.characters);
+        free(scratch.bytes);
+    };
+    
+    if (chunksCount > 1) {
+        dispatch_apply(chunksCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), transformChunk);
+    }
+    else {
+        transformChunk(0);
+    }
+    
+    NSMutableArray *transformedStrings = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [transformedStrings addObject:(results[i] ?: [NSNull null])];
+        results[i] = nil;
+    } // for
+    
+    free(chain);
+    free(objects);
+    free(results);
+    
+    return transformedStrings;
+}
+
 + (NSString *)stringHexadecimalRepresentationOfData:(NSData *)data {
+    MUK_INSTRUMENT([data length]);
     if (data == nil) return nil;
     
     NSMutableString *string = [[NSMutableString alloc] initWithCapacity:[data length]];
@@ -176,4 +291,135 @@
     return mutString;
 }
 
+#pragma mark - Private
+
++ (NSString *)string_:(NSString *)string applyingTransforms:(MUKStringTransform const *)transforms count:(NSUInteger)count scratch:(MUKStringScratch *)scratch
+{
+    NSString *output = string;
+    
+    for (NSUInteger t = 0; t < count; t++) {
+        MUKStringTransform const transform = transforms[t];
+        BOOL const digest = (transform == MUKStringTransformSHA1 || transform == MUKStringTransformMD5);
+        
+        if (digest && scratch->hexDigestLength > 0) {
+            // Hex digits are their own UTF-8 encoding
+            [self hexDigestOfBytes_:(uint8_t const *)scratch->hexDigest length:scratch->hexDigestLength transform:transform scratch:scratch];
+            continue;
+        }
+        
+        if (scratch->hexDigestLength > 0) {
+            output = MUKStringScratchHexDigestString(scratch);
+        }
+        
+        // nil stays nil through every transform
+        if (output == nil) break;
+        
+        switch (transform) {
+            case MUKStringTransformReverse: {
+                NSUInteger const length = [output length];
+                if (length > 0 && MUKStringScratchReserve((void **)&scratch->characters, &scratch->charactersCapacity, length * sizeof(unichar)))
+                {
+                    // Reverses UTF-16 units, like +string:applyingTransform:
+                    unichar *characters = scratch->characters;
+                    [output getCharacters:characters range:NSMakeRange(0, length)];
+                    
+                    for (NSUInteger i = 0, j = length - 1; i < j; i++, j--) {
+                        unichar const c = characters[i];
+                        characters[i] = characters[j];
+                        characters[j] = c;
+                    } // for
+                    
+                    output = [[NSString alloc] initWithCharacters:characters length:length];
+                }
+                else {
+                    output = [self string:output applyingTransform:transform];
+                }
+                
+                break;
+            }
+            
+            case MUKStringTransformUppercaseFirstLetter: {
+                NSUInteger const length = [output length];
+                unichar const first = (length > 0 ? [output characterAtIndex:0] : 0);
+                
+                if (length == 0 || (first < 0x80 && !(first >= 'a' && first <= 'z'))) {
+                    // Nothing to uppercase
+                    break;
+                }
+                else if (first < 0x80 && MUKStringScratchReserve((void **)&scratch->characters, &scratch->charactersCapacity, length * sizeof(unichar)))
+                {
+                    unichar *characters = scratch->characters;
+                    [output getCharacters:characters range:NSMakeRange(0, length)];
+                    characters[0] = first - ('a' - 'A');
+                    output = [[NSString alloc] initWithCharacters:characters length:length];
+                }
+                else {
+                    // Non-ASCII letters could change length (e.g. ß)
+                    output = [self string:output applyingTransform:transform];
+                }
+                
+                break;
+            }
+            
+            case MUKStringTransformSHA1:
+            case MUKStringTransformMD5: {
+                NSUInteger const length = [output length];
+                NSUInteger usedLength = 0;
+                NSRange remainingRange = NSMakeRange(0, 0);
+                
+                // A UTF-16 unit takes 3 UTF-8 bytes at most
+                BOOL converted = MUKStringScratchReserve((void **)&scratch->bytes, &scratch->bytesCapacity, MAX(length * 3, (NSUInteger)1));
+                if (converted) {
+                    converted = [output getBytes:scratch->bytes maxLength:scratch->bytesCapacity usedLength:&usedLength encoding:NSUTF8StringEncoding options:0 range:NSMakeRange(0, length) remainingRange:&remainingRange];
+                    converted = (converted || length == 0) && remainingRange.length == 0;
+                }
+                
+                if (converted) {
+                    [self hexDigestOfBytes_:scratch->bytes length:usedLength transform:transform scratch:scratch];
+                }
+                else {
+                    // Unpaired surrogates: let +string:applyingTransform: decide
+                    output = [self string:output applyingTransform:transform];
+                }
+                
+                break;
+            }
+            
+            default:
+                output = [self string:output applyingTransform:transform];
+                break;
+        }
+    } // for
+    
+    if (scratch->hexDigestLength > 0) {
+        output = MUKStringScratchHexDigestString(scratch);
+    }
+    
+    return output;
+}
+
++ (void)hexDigestOfBytes_:(uint8_t const *)bytes length:(NSUInteger)length transform:(MUKStringTransform)transform scratch:(MUKStringScratch *)scratch
+{
+    static char const kHexDigits[] = "0123456789abcdef";
+    unsigned char digest[CC_SHA1_DIGEST_LENGTH];
+    NSUInteger digestLength;
+    
+    if (transform == MUKStringTransformSHA1) {
+        CC_SHA1(bytes, (CC_LONG)length, digest);
+        digestLength = CC_SHA1_DIGEST_LENGTH;
+    }
+    else {
+        CC_MD5(bytes, (CC_LONG)length, digest);
+        digestLength = CC_MD5_DIGEST_LENGTH;
+    }
+    
+    // bytes could point to hexDigest itself: it is overwritten after hashing
+    for (NSUInteger i = 0; i < digestLength; i++) {
+        scratch->hexDigest[2 * i] = kHexDigits[digest[i] >> 4];
+        scratch->hexDigest[2 * i + 1] = kHexDigits[digest[i] & 0x0F];
+    } // for
+    
+    scratch->hexDigestLength = 2 * digestLength;
+}
+
 @end
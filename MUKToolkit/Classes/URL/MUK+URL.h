@@ -62,6 +62,7 @@
  @param hiRes Say if you want to search for high resolution version of 
  the image: if `YES`, this method searches for `name@2x` image before.
  @return File URL of image.
+ @see MUKImageResourceIndex
  */
 + (NSURL *)URLForImageFileWithName:(NSString *)name extension:(NSString *)extension bundle:(NSBundle *)bundle highResolution:(BOOL)hiRes;
 /**
@@ -69,7 +70,8 @@
  
  This method calls URLForImageFileWithName:extension:bundle:highResolution:
  with `name`=`name`, `extension`=`nil`, `bundle`=`bundle` and
- `highResolution` depending from main screen scale.
+ `highResolution` depending from main screen scale. On screens with a scale
+ of 3, `name@3x` image is searched before `name@2x` image.
  
  @param name Full name of image (e.g. `panda.png`).
  @param bundle Bundle where image is in. If `nil` defaults to 
@@ -24,6 +24,7 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #import "MUK+URL.h"
+#import "MUKImageResourceIndex.h"
 #import <UIKit/UIKit.h>
 
 @implementation MUK (URL)
@@ -57,15 +58,40 @@
         name = [name stringByDeletingPathExtension];
     }
     
-    NSString *hiResName = nil;
-    if (hiRes) {
-        // Try to find high resolution image
-        hiResName = [name stringByAppendingString:@"@2x"];
-    }
+    return [self URLForImageFileWithName_:name extension:extension bundle:bundle scale:(hiRes ? 2.0 : 1.0)];
+}
+
++ (NSURL *)URLForImageFileNamed:(NSString *)name bundle:(NSBundle *)bundle {
+    static CGFloat screenScale = 0.0;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        screenScale = [[UIScreen mainScreen] scale];
+    });
     
+    NSString *extension = [name pathExtension];
+    if ([extension length] == 0) extension = @"png";
+    
+    return [self URLForImageFileWithName_:[name stringByDeletingPathExtension] extension:extension bundle:(bundle ?: [NSBundle mainBundle]) scale:screenScale];
+}
+
+#pragma mark - Private
+
++ (NSURL *)URLForImageFileWithName_:(NSString *)name extension:(NSString *)extension bundle:(NSBundle *)bundle scale:(CGFloat)scale
+{
     NSURL *fileURL = nil;
-    if (hiResName) {
+    
+    // Index covers resources at top level of bundle (and localizations).
+    // Names of explicit variants (e.g. arrow@2x or panda~ipad) are not keys
+    // of index: let bundle find them.
+    if ([name rangeOfString:@"/"].location == NSNotFound) {
+        MUKImageResourceIndex *index = [MUKImageResourceIndex indexForBundle:bundle];
+        fileURL = [index URLForResourceWithName:name extension:extension scale:scale];
+        if (fileURL) return fileURL;
+    }
+    
+    if (scale > 1.1) {
         // Search URL for high resolution
+        NSString *hiResName = [name stringByAppendingString:@"@2x"];
         fileURL = [bundle URLForResource:hiResName withExtension:extension];
     }
     
@@ -78,9 +104,4 @@
     return fileURL;
 }
 
-+ (NSURL *)URLForImageFileNamed:(NSString *)name bundle:(NSBundle *)bundle {
-    BOOL hiRes = ([[UIScreen mainScreen] scale] > 1.1);
-    return [self URLForImageFileWithName:name extension:nil bundle:bundle highResolution:hiRes];
-}
-
 @end
@@ -0,0 +1,124 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+
+/**
+ An in-memory index of resources of a bundle, grouped by base name and 
+ extension, with a file URL for each scale variant (`@1x`, `@2x`, `@3x`).
+ 
+ Bundle is scanned once, when index is created: after that lookups do not
+ touch filesystem. Scan follows `-[NSBundle URLForResource:withExtension:]`
+ rules: nonlocalized resources come before localized resources (searched in
+ `preferredLocalizations` order) and device specific files (e.g.
+ `panda@2x~ipad.png`) win over generic ones on matching device.
+ 
+ An index never changes after creation, so you can query it from any 
+ thread.
+ 
+    MUKImageResourceIndex *index = [MUKImageResourceIndex indexForBundle:nil];
+    NSURL *imageURL = [index URLForResourceWithName:@"panda" extension:@"png"
+                        scale:2.0];
+ 
+ Index could be persisted to disk, so later launches load it instead of
+ scanning bundle again. Stored index is discarded when bundle version, 
+ bundle modification date, preferred localizations or device change.
+ 
+ URLForImageFileWithName:extension:bundle:highResolution: and
+ URLForImageFileNamed:bundle: in MUK(URL) use shared indexes.
+ */
+@interface MUKImageResourceIndex : NSObject
+/**
+ Indexed bundle.
+ */
+@property (nonatomic, strong, readonly) NSBundle *bundle;
+/**
+ Number of indexed resources (a resource is a base name with an extension,
+ regardless of how many scale variants it has).
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ Shared index of a bundle.
+ 
+ Index is created the first time it is requested: concurrent callers wait
+ for the same scan.
+ 
+ @param bundle Indexed bundle. If `nil` defaults to `[NSBundle mainBundle]`.
+ @return Shared index of `bundle`.
+ */
++ (MUKImageResourceIndex *)indexForBundle:(NSBundle *)bundle;
+/**
+ Tells if shared indexes are persisted into *Caches* directory.
+ @return `YES` if shared indexes are persisted. Default is `NO`.
+ */
++ (BOOL)persistsSharedIndexes;
+/**
+ Sets if shared indexes should be persisted into *Caches* directory.
+ 
+ Set it before first index is requested.
+ 
+ @param persists `YES` if shared indexes should be persisted.
+ */
++ (void)setPersistsSharedIndexes:(BOOL)persists;
+
+/**
+ Creates an index scanning a bundle.
+ @param bundle Bundle to scan. If `nil` defaults to `[NSBundle mainBundle]`.
+ @return A new index.
+ */
+- (id)initWithBundle:(NSBundle *)bundle;
+/**
+ Creates an index loading it from disk or scanning a bundle.
+ 
+ This is the designated initializer.
+ 
+ @param bundle Bundle to index. If `nil` defaults to `[NSBundle mainBundle]`.
+ @param storeURL File URL where index is persisted. If stored index is
+ missing or stale, bundle is scanned and index is written at `storeURL`.
+ Pass `nil` to always scan bundle without persisting.
+ @return A new index.
+ */
+- (id)initWithBundle:(NSBundle *)bundle persistentStoreURL:(NSURL *)storeURL;
+
+/**
+ Every scale variant of a resource.
+ @param name Base name of resource (e.g. `panda` for `panda@2x.png`).
+ @param extension Extension of resource (e.g. `png` for `panda@2x.png`).
+ @return A dictionary with scales (`NSNumber` objects) as keys and file URLs
+ as values. It returns `nil` if resource is not indexed.
+ */
+- (NSDictionary *)URLsForResourceWithName:(NSString *)name extension:(NSString *)extension;
+/**
+ File URL of the variant of a resource which fits a scale.
+ @param name Base name of resource (e.g. `panda` for `panda@2x.png`).
+ @param extension Extension of resource (e.g. `png` for `panda@2x.png`).
+ @param scale Requested scale.
+ @return File URL of the variant with the greatest scale which is not bigger
+ than `scale`. It returns `nil` if there is no such a variant.
+ */
+- (NSURL *)URLForResourceWithName:(NSString *)name extension:(NSString *)extension scale:(CGFloat)scale;
+@end
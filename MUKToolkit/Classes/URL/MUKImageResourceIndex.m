@@ -0,0 +1,333 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUKImageResourceIndex.h"
+#import "MUK+URL.h"
+#import "MUK+String.h"
+#import <UIKit/UIKit.h>
+
+#define MUK_IMAGE_RESOURCE_INDEX_MAX_SCALE          3
+#define MUK_IMAGE_RESOURCE_INDEX_STORE_VERSION      1
+
+static NSString *const kStoreVersionKey = @"version";
+static NSString *const kStoreSignatureKey = @"signature";
+static NSString *const kStoreResourcesKey = @"resources";
+
+static BOOL MUKImageResourceIndexPersistsSharedIndexes = NO;
+
+NS_INLINE NSString *MUKImageResourceIndexKey(NSString *name, NSString *extension)
+{
+    return [[name stringByAppendingString:@"."] stringByAppendingString:extension ?: @""];
+}
+
+// Splits "panda@2x~ipad.png" into "panda", "png", 2 and "ipad"
+static BOOL MUKImageResourceIndexParseFileName(NSString *fileName, NSString **name, NSString **extension, NSInteger *scale, NSString **device)
+{
+    if ([fileName hasPrefix:@"."]) return NO;
+    
+    *extension = [fileName pathExtension];
+    NSString *stem = [fileName stringByDeletingPathExtension];
+    
+    *device = nil;
+    NSRange range = [stem rangeOfString:@"~" options:NSBackwardsSearch];
+    if (range.location != NSNotFound) {
+        *device = [stem substringFromIndex:range.location + 1];
+        stem = [stem substringToIndex:range.location];
+    }
+    
+    *scale = 1;
+    if ([stem length] > 3 && [stem characterAtIndex:[stem length] - 3] == '@' && [stem hasSuffix:@"x"])
+    {
+        unichar const digit = [stem characterAtIndex:[stem length] - 2];
+        if (digit >= '2' && digit <= '0' + MUK_IMAGE_RESOURCE_INDEX_MAX_SCALE) {
+            *scale = digit - '0';
+            stem = [stem substringToIndex:[stem length] - 3];
+        }
+    }
+    
+    *name = stem;
+    return ([stem length] > 0);
+}
+
+@implementation MUKImageResourceIndex {
+    // Base name and extension -> array of relative paths, one per scale
+    // (empty string if variant is missing)
+    NSDictionary *relativePaths_;
+    NSURL *resourceURL_;
+}
+
+@synthesize bundle = bundle_;
+
++ (MUKImageResourceIndex *)indexForBundle:(NSBundle *)bundle {
+    static NSMutableDictionary *sharedIndexes = nil;
+    static NSMutableDictionary *bundleLocks = nil;
+    bundle = bundle ?: [NSBundle mainBundle];
+    
+    NSString *bundlePath = [bundle bundlePath];
+    MUKImageResourceIndex *index;
+    id bundleLock;
+    BOOL persists;
+    
+    // Class-wide lock only guards dictionaries
+    @synchronized(self) {
+        if (sharedIndexes == nil) {
+            sharedIndexes = [[NSMutableDictionary alloc] init];
+            bundleLocks = [[NSMutableDictionary alloc] init];
+        }
+        
+        index = sharedIndexes[bundlePath];
+        if (index) return index;
+        
+        bundleLock = bundleLocks[bundlePath];
+        if (bundleLock == nil) {
+            bundleLock = [[NSObject alloc] init];
+            bundleLocks[bundlePath] = bundleLock;
+        }
+        
+        persists = MUKImageResourceIndexPersistsSharedIndexes;
+    }
+    
+    // Bundle is scanned once, without blocking lookups into other bundles
+    @synchronized(bundleLock) {
+        @synchronized(self) {
+            index = sharedIndexes[bundlePath];
+        }
+        
+        if (index == nil) {
+            NSURL *storeURL = (persists ? [self sharedStoreURLForBundle_:bundle] : nil);
+            index = [[self alloc] initWithBundle:bundle persistentStoreURL:storeURL];
+            
+            @synchronized(self) {
+                sharedIndexes[bundlePath] = index;
+                [bundleLocks removeObjectForKey:bundlePath];
+            }
+        }
+    }
+    
+    return index;
+}
+
++ (BOOL)persistsSharedIndexes {
+    @synchronized(self) {
+        return MUKImageResourceIndexPersistsSharedIndexes;
+    }
+}
+
++ (void)setPersistsSharedIndexes:(BOOL)persists {
+    @synchronized(self) {
+        MUKImageResourceIndexPersistsSharedIndexes = persists;
+    }
+}
+
+- (id)init {
+    return [self initWithBundle:nil persistentStoreURL:nil];
+}
+
+- (id)initWithBundle:(NSBundle *)bundle {
+    return [self initWithBundle:bundle persistentStoreURL:nil];
+}
+
+- (id)initWithBundle:(NSBundle *)bundle persistentStoreURL:(NSURL *)storeURL
+{
+    self = [super init];
+    if (self) {
+        bundle_ = bundle ?: [NSBundle mainBundle];
+        resourceURL_ = [bundle_ resourceURL];
+        
+        NSDictionary *signature = [self signature_];
+        
+        if (storeURL) {
+            relativePaths_ = [[self class] relativePathsStoredAtURL_:storeURL signature:signature];
+        }
+        
+        if (relativePaths_ == nil) {
+            relativePaths_ = [self scan_];
+            
+            if (storeURL) {
+                [[self class] storeRelativePaths_:relativePaths_ signature:signature atURL:storeURL];
+            }
+        }
+    }
+    
+    return self;
+}
+
+- (NSUInteger)count {
+    return [relativePaths_ count];
+}
+
+- (NSDictionary *)URLsForResourceWithName:(NSString *)name extension:(NSString *)extension
+{
+    NSArray *paths = relativePaths_[MUKImageResourceIndexKey(name, extension)];
+    if (paths == nil) return nil;
+    
+    NSMutableDictionary *URLs = [NSMutableDictionary dictionaryWithCapacity:[paths count]];
+    [paths enumerateObjectsUsingBlock:^(NSString *path, NSUInteger idx, BOOL *stop)
+    {
+        if ([path length]) {
+            URLs[@(idx + 1)] = [resourceURL_ URLByAppendingPathComponent:path];
+        }
+    }];
+    
+    return URLs;
+}
+
+- (NSURL *)URLForResourceWithName:(NSString *)name extension:(NSString *)extension scale:(CGFloat)scale
+{
+    NSArray *paths = relativePaths_[MUKImageResourceIndexKey(name, extension)];
+    if (paths == nil) return nil;
+    
+    NSInteger idx = MIN((NSInteger)floor(scale + 0.1), MUK_IMAGE_RESOURCE_INDEX_MAX_SCALE) - 1;
+    for (; idx >= 0; idx--) {
+        NSString *path = paths[idx];
+        if ([path length]) {
+            return [resourceURL_ URLByAppendingPathComponent:path];
+        }
+    } // for
+    
+    return nil;
+}
+
+#pragma mark - Private
+
+- (NSString *)deviceModifier_ {
+    return (UI_USER_INTERFACE_IDIOM() == UIUserInterfaceIdiomPad ? @"ipad" : @"iphone");
+}
+
+- (NSDictionary *)signature_ {
+    NSDate *modificationDate = nil;
+    [resourceURL_ getResourceValue:&modificationDate forKey:NSURLContentModificationDateKey error:nil];
+    
+    NSDictionary *infoDictionary = [bundle_ infoDictionary];
+    
+    return @{
+        @"bundleVersion": infoDictionary[@"CFBundleVersion"] ?: @"",
+        @"shortVersion": infoDictionary[@"CFBundleShortVersionString"] ?: @"",
+        @"modificationDate": @([modificationDate timeIntervalSinceReferenceDate]),
+        @"localizations": [bundle_ preferredLocalizations] ?: @[],
+        @"device": [self deviceModifier_]
+    };
+}
+
+- (NSDictionary *)scan_ {
+    if (resourceURL_ == nil) return @{};
+    
+    // Nonlocalized resources win over localized ones
+    NSMutableArray *directories = [NSMutableArray arrayWithObject:@""];
+    for (NSString *localization in [bundle_ preferredLocalizations]) {
+        [directories addObject:[localization stringByAppendingPathExtension:@"lproj"]];
+    } // for
+    
+    NSString *const deviceModifier = [self deviceModifier_];
+    NSString *const resourcePath = [resourceURL_ path];
+    NSFileManager *fileManager = [[NSFileManager alloc] init];
+    NSMutableDictionary *relativePaths = [NSMutableDictionary dictionary];
+    
+    for (NSString *directory in directories) {
+        NSArray *fileNames = [fileManager contentsOfDirectoryAtPath:[resourcePath stringByAppendingPathComponent:directory] error:nil];
+        
+        // Device specific files first, so they win over generic ones
+        for (NSInteger pass = 0; pass < 2; pass++) {
+            BOOL const wantsDeviceSpecificFiles = (pass == 0);
+            
+            for (NSString *fileName in fileNames) {
+                NSString *name, *extension, *device;
+                NSInteger scale;
+                
+                if (!MUKImageResourceIndexParseFileName(fileName, &name, &extension, &scale, &device))
+                {
+                    continue;
+                }
+                
+                if (wantsDeviceSpecificFiles != (device != nil)) continue;
+                if (device && ![device isEqualToString:deviceModifier]) continue;
+                
+                NSString *key = MUKImageResourceIndexKey(name, extension);
+                NSMutableArray *paths = relativePaths[key];
+                
+                if (paths == nil) {
+                    paths = [NSMutableArray arrayWithCapacity:MUK_IMAGE_RESOURCE_INDEX_MAX_SCALE];
+                    for (NSInteger i = 0; i < MUK_IMAGE_RESOURCE_INDEX_MAX_SCALE; i++) {
+                        [paths addObject:@""];
+                    } // for
+                    
+                    relativePaths[key] = paths;
+                }
+                
+                if ([paths[scale - 1] length] == 0) {
+                    paths[scale - 1] = [directory stringByAppendingPathComponent:fileName];
+                }
+            } // for
+        } // for
+    } // for
+    
+    return relativePaths;
+}
+
++ (NSURL *)sharedStoreURLForBundle_:(NSBundle *)bundle {
+    NSString *identifier = [bundle bundleIdentifier];
+    if ([identifier length] == 0) {
+        identifier = [MUK string:[bundle bundlePath] applyingTransform:MUKStringTransformSHA1];
+    }
+    
+    NSURL *directoryURL = [[MUK URLForCachesDirectory] URLByAppendingPathComponent:@"MUKImageResourceIndex" isDirectory:YES];
+    [[NSFileManager defaultManager] createDirectoryAtURL:directoryURL withIntermediateDirectories:YES attributes:nil error:nil];
+    
+    return [directoryURL URLByAppendingPathComponent:[identifier stringByAppendingPathExtension:@"plist"]];
+}
+
++ (NSDictionary *)relativePathsStoredAtURL_:(NSURL *)storeURL signature:(NSDictionary *)signature
+{
+    NSData *data = [NSData dataWithContentsOfURL:storeURL];
+    if (data == nil) return nil;
+    
+    NSDictionary *store = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:nil];
+    if (![store isKindOfClass:[NSDictionary class]]) return nil;
+    
+    if ([store[kStoreVersionKey] integerValue] != MUK_IMAGE_RESOURCE_INDEX_STORE_VERSION ||
+        ![store[kStoreSignatureKey] isEqual:signature])
+    {
+        return nil;
+    }
+    
+    NSDictionary *relativePaths = store[kStoreResourcesKey];
+    if (![relativePaths isKindOfClass:[NSDictionary class]]) return nil;
+    
+    return relativePaths;
+}
+
++ (BOOL)storeRelativePaths_:(NSDictionary *)relativePaths signature:(NSDictionary *)signature atURL:(NSURL *)storeURL
+{
+    NSDictionary *store = @{
+        kStoreVersionKey: @(MUK_IMAGE_RESOURCE_INDEX_STORE_VERSION),
+        kStoreSignatureKey: signature,
+        kStoreResourcesKey: relativePaths
+    };
+    
+    NSData *data = [NSPropertyListSerialization dataWithPropertyList:store format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+    return [data writeToURL:storeURL atomically:YES];
+}
+
+@end
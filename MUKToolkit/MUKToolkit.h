@@ -3,12 +3,26 @@
 #import <UIKit/UIKit.h>
 
 #import <MUKToolkit/MUK.h>
+#import <MUKToolkit/MUKCompletion.h>
+#import <MUKToolkit/MUKBitset.h>
+#import <MUKToolkit/MUK+Instrumentation.h>
 #import <MUKToolkit/MUK+Array.h>
+#import <MUKToolkit/MUKArrayPipeline.h>
+#import <MUKToolkit/MUKArrayView.h>
+#import <MUKToolkit/MUKNumericArray.h>
+#import <MUKToolkit/MUKArrayDiff.h>
 #import <MUKToolkit/MUK+Color.h>
 #import <MUKToolkit/MUK+Data.h>
+#import <MUKToolkit/MUKDataCompressionStream.h>
+#import <MUKToolkit/MUKChunkedData.h>
+#import <MUKToolkit/MUKDiskCache.h>
 #import <MUKToolkit/MUK+Date.h>
 #import <MUKToolkit/MUK+Geometry.h>
+#import <MUKToolkit/MUKGeometrySpatialIndex.h>
 #import <MUKToolkit/MUK+Image.h>
+#import <MUKToolkit/MUKImagePalette.h>
+#import <MUKToolkit/MUKPixelKernels.h>
 #import <MUKToolkit/MUK+Object.h>
 #import <MUKToolkit/MUK+String.h>
 #import <MUKToolkit/MUK+URL.h>
+#import <MUKToolkit/MUKImageResourceIndex.h>
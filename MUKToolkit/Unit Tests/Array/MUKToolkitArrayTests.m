@@ -25,6 +25,10 @@
 
 #import "MUKToolkitArrayTests.h"
 #import "MUK+Array.h"
+#import "MUKArrayPipeline.h"
+#import "MUKArrayView.h"
+#import "MUKNumericArray.h"
+#import "MUKArrayDiff.h"
 
 @implementation MUKToolkitArrayTests
 
@@ -77,6 +81,44 @@
     STAssertEqualObjects(mappedArray, expectedArray, @"Arrays should match");
 }
 
+- (void)testConcurrentMapping {
+    NSArray *array = [NSArray arrayWithObjects:@"hello", @"world", @"this", @"is", @"me", nil];
+    NSArray *expectedArray = [NSArray arrayWithObjects:@"HELLO", @"WORLD", @"THIS", @"IS", @"ME", nil];
+    
+    NSArray *mappedArray = [MUK array:array concurrentlyMap:^id(id obj, NSInteger index, BOOL *exclude, BOOL *stop)
+    {
+        return [obj uppercaseString];
+    }];
+    STAssertEqualObjects(mappedArray, expectedArray, @"Arrays should match");
+    
+    // Nil
+    expectedArray = [NSArray arrayWithObjects:[NSNull null], [NSNull null], [NSNull null], [NSNull null], [NSNull null], nil];
+    mappedArray = [MUK array:array concurrentlyMap:^id(id obj, NSInteger index, BOOL *exclude, BOOL *stop)
+    {
+        return nil;
+    }];
+    STAssertEqualObjects(mappedArray, expectedArray, @"Arrays should match");
+    
+    // Large input with expensive mapping, which is dispatched on many threads
+    NSMutableArray *numbers = [NSMutableArray arrayWithCapacity:2000];
+    for (NSInteger i = 0; i < 2000; i++) {
+        [numbers addObject:@(i)];
+    }
+    
+    id (^expensiveMap)(id, NSInteger, BOOL *, BOOL *) = ^id(id obj, NSInteger index, BOOL *exclude, BOOL *stop)
+    {
+        [NSThread sleepForTimeInterval:0.0001];
+        *exclude = (index % 3 == 0);
+        *stop = (index == 1500);
+        return @([obj integerValue] * 2);
+    };
+    
+    expectedArray = [MUK array:numbers map:expensiveMap];
+    mappedArray = [MUK array:numbers concurrentlyMap:expensiveMap];
+    STAssertEqualObjects(mappedArray, expectedArray, @"Concurrent mapping should match serial mapping (order, exclusion and stop)");
+    STAssertEquals([mappedArray count], (NSUInteger)1000, @"Mapped until stop index, without excluded objects");
+}
+
 - (void)testIdentityTransform {
     NSArray *array = @[];
     NSArray *output = [MUK array:array applyingTransform:MUKArrayTransformIdentity];
@@ -97,6 +139,285 @@
     expected = @[@3, @2, @1];
     output = [MUK array:array applyingTransform:MUKArrayTransformReverse];
     STAssertEqualObjects(output, expected, nil);
+    
+    STAssertNil([MUK array:nil applyingTransform:MUKArrayTransformReverse], @"nil gives nil");
+}
+
+- (void)testPipeline {
+    NSMutableArray *numbers = [NSMutableArray arrayWithCapacity:100];
+    for (NSInteger i = 0; i < 100; i++) {
+        [numbers addObject:@(i)];
+    }
+    
+    // No stages
+    STAssertEqualObjects([[MUK pipelineWithArray:numbers] array], numbers, nil);
+    STAssertEqualObjects([[MUK pipelineWithArray:nil] array], @[], nil);
+    
+    // Window stages
+    NSArray *output = [[[[[MUK pipelineWithArray:numbers] reverse] drop:10] take:3] array];
+    STAssertEqualObjects(output, (@[@89, @88, @87]), @"Reverse, drop and take");
+    
+    output = [[[[MUK pipelineWithArray:numbers] take:200] drop:98] array];
+    STAssertEqualObjects(output, (@[@98, @99]), @"Counts are clamped");
+    
+    // Fused stages must match chained methods
+    id (^doubleMap)(id, NSInteger, BOOL *, BOOL *) = ^id(id obj, NSInteger index, BOOL *exclude, BOOL *stop)
+    {
+        *exclude = ([obj integerValue] % 5 == 0);
+        return @([obj integerValue] * 2);
+    };
+    
+    NSArray *expected = [MUK array:[MUK array:numbers map:doubleMap] applyingTransform:MUKArrayTransformReverse];
+    expected = [expected subarrayWithRange:NSMakeRange(2, 4)];
+    
+    MUKArrayPipeline *pipeline = [[[[[MUK pipelineWithArray:numbers] map:doubleMap] applyingTransform:MUKArrayTransformReverse] drop:2] take:4];
+    STAssertEqualObjects([pipeline array], expected, @"Pipeline should match chained methods");
+    STAssertEqualObjects([pipeline array], expected, @"Pipeline could be run many times");
+    
+    // Filter and stop
+    output = [[[[MUK pipelineWithArray:numbers] filter:^BOOL(id obj, NSInteger index) {
+        return [obj integerValue] % 2 == 1;
+    }] map:^id(id obj, NSInteger index, BOOL *exclude, BOOL *stop) {
+        *stop = (index == 3);
+        return obj;
+    }] array];
+    STAssertEqualObjects(output, (@[@1, @3, @5]), @"Map index counts objects which passed filter");
+    
+    // Take stops upstream stages
+    __block NSInteger mapCount = 0;
+    output = [[[[MUK pipelineWithArray:numbers] map:^id(id obj, NSInteger index, BOOL *exclude, BOOL *stop) {
+        mapCount++;
+        return obj;
+    }] take:5] array];
+    STAssertEquals([output count], (NSUInteger)5, nil);
+    STAssertEquals(mapCount, (NSInteger)5, @"Objects after take are not mapped");
+    
+    // Enumeration without materializing
+    __block NSInteger sum = 0;
+    [[[MUK pipelineWithArray:numbers] reverse] enumerateObjectsUsingBlock:^(id obj, NSUInteger idx, BOOL *stop)
+    {
+        sum += [obj integerValue];
+        *stop = (idx == 1);
+    }];
+    STAssertEquals(sum, (NSInteger)(99 + 98), @"Enumeration stopped");
+}
+
+- (void)testArrayViews {
+    NSArray *array = @[@0, @1, @2, @3, @4, @5, @6, @7, @8, @9];
+    
+    NSArray *view = [MUK array:array viewWithRange:NSMakeRange(7, 3) stride:-1];
+    STAssertEqualObjects(view, (@[@9, @8, @7]), @"Reversed slice");
+    
+    view = [MUK array:array viewWithRange:NSMakeRange(1, 8) stride:3];
+    STAssertEqualObjects(view, (@[@1, @4, @7]), @"Strided slice");
+    
+    view = [MUK array:array viewWithRange:NSMakeRange(0, 10) stride:-4];
+    STAssertEqualObjects(view, (@[@9, @5, @1]), @"Reversed strided slice");
+    
+    view = [MUK array:array viewWithRange:NSMakeRange(5, 0) stride:-1];
+    STAssertEquals([view count], (NSUInteger)0, @"Empty slice");
+    
+    STAssertThrows([MUK array:array viewWithRange:NSMakeRange(5, 6) stride:1], @"Range out of bounds");
+    STAssertThrows([[MUK array:array viewWithRange:NSMakeRange(0, 3) stride:1] objectAtIndex:3], @"Index out of bounds");
+    
+    // View of view
+    NSArray *reversedView = [MUK array:array viewWithRange:NSMakeRange(0, 10) stride:-1];
+    view = [MUK array:reversedView viewWithRange:NSMakeRange(2, 6) stride:-2];
+    STAssertEqualObjects(view, (@[@2, @4, @6]), @"Views are composed");
+    STAssertTrue([(MUKArrayView *)view baseArray] == array, @"Composed view refers to original array");
+    
+    // Fast enumeration with more objects than a single batch
+    NSMutableArray *numbers = [NSMutableArray arrayWithCapacity:1000];
+    for (NSInteger i = 0; i < 1000; i++) {
+        [numbers addObject:@(i)];
+    }
+    
+    NSInteger expectedNumber = 999;
+    for (NSNumber *number in [MUK array:numbers viewWithRange:NSMakeRange(0, 1000) stride:-1]) {
+        STAssertEquals([number integerValue], expectedNumber, @"Enumerated backwards");
+        expectedNumber--;
+    }
+    STAssertEquals(expectedNumber, (NSInteger)-1, @"Every object enumerated");
+    
+    // Copy on demand
+    NSArray *copy = [view copy];
+    STAssertFalse([copy isKindOfClass:[MUKArrayView class]], @"Copy is a real array");
+    STAssertEqualObjects(copy, view, nil);
+}
+
+- (void)testNumericArrays {
+    NSArray *numbers = @[@3, @-1, @4, @1, @5, [NSNull null]];
+    MUKNumericType types[] = { MUKNumericTypeInt32, MUKNumericTypeInt64, MUKNumericTypeFloat, MUKNumericTypeDouble };
+    
+    for (NSInteger t = 0; t < 4; t++) {
+        MUKNumericArray *array = [[MUKNumericArray alloc] initWithType:types[t] array:numbers];
+        STAssertEquals([array count], (NSUInteger)6, nil);
+        STAssertTrue(((uintptr_t)[array bytes] % 16) == 0, @"Aligned buffer");
+        
+        NSArray *expectedArray = @[@3, @-1, @4, @1, @5, @0];
+        STAssertEqualObjects([array array], expectedArray, @"NSNull converted to 0");
+        
+        STAssertEquals([array sum], 12.0, nil);
+        STAssertEquals([array minimum], -1.0, nil);
+        STAssertEquals([array maximum], 5.0, nil);
+        STAssertEquals([array reduceWithInitialValue:1.0 usingBlock:^double(double accumulator, double value, NSUInteger index) {
+            return accumulator + value * (double)index;
+        }], 1.0 + 0 - 1 + 8 + 3 + 20 + 0, nil);
+        
+        expectedArray = @[@3, @2, @6, @7, @12, @12];
+        STAssertEqualObjects([[array prefixSums] array], expectedArray, nil);
+        
+        expectedArray = @[@7, @-1, @9, @3, @11, @1];
+        STAssertEqualObjects([[array arrayByMultiplyingBy:2.0 adding:1.0] array], expectedArray, nil);
+        
+        expectedArray = @[@9, @1, @16, @1, @25, @0];
+        STAssertEqualObjects([[array arrayByMappingWithBlock:^double(double value, NSUInteger index) {
+            return value * value;
+        }] array], expectedArray, nil);
+        
+        expectedArray = @[@3, @4, @5];
+        MUKNumericArray *filteredArray = [array arrayByFilteringWithBlock:^BOOL(double value, NSUInteger index) {
+            return value > 2.0;
+        }];
+        STAssertEquals([filteredArray type], types[t], nil);
+        STAssertEqualObjects([filteredArray array], expectedArray, nil);
+        
+        expectedArray = @[@0, @5, @1, @4, @-1, @3];
+        STAssertEqualObjects([[array arrayByApplyingTransform:MUKArrayTransformReverse] array], expectedArray, nil);
+        STAssertEqualObjects([array arrayByApplyingTransform:MUKArrayTransformIdentity], array, nil);
+        
+        [array setDouble:42.0 atIndex:5];
+        STAssertEquals([array doubleAtIndex:5], 42.0, nil);
+        STAssertThrows([array doubleAtIndex:6], @"Out of bounds");
+    } // for
+    
+    // Empty arrays
+    MUKNumericArray *emptyArray = [[MUKNumericArray alloc] initWithType:MUKNumericTypeDouble count:0];
+    STAssertEquals([emptyArray sum], 0.0, nil);
+    STAssertTrue(isnan([emptyArray minimum]), nil);
+    STAssertTrue(isnan([emptyArray maximum]), nil);
+    STAssertEquals([[emptyArray prefixSums] count], (NSUInteger)0, nil);
+    
+    // Integer prefix sums do not overflow
+    int32_t const bigValues[] = { INT32_MAX, 1, -2 };
+    MUKNumericArray *bigArray = [[MUKNumericArray alloc] initWithType:MUKNumericTypeInt32 bytes:bigValues count:3];
+    MUKNumericArray *bigPrefixSums = [bigArray prefixSums];
+    int32_t const *prefixSums = [bigPrefixSums bytes];
+    STAssertEquals(prefixSums[1], (int32_t)INT32_MAX, @"Clamped");
+    STAssertEquals(prefixSums[2], (int32_t)(INT32_MAX - 1), @"Accumulated with 64 bits");
+    STAssertEquals([bigArray sum], (double)INT32_MAX - 1.0, nil);
+    
+    // 64-bit sums do not overflow
+    int64_t const hugeValues[] = { INT64_MAX, 1, -INT64_MAX, INT64_MAX };
+    MUKNumericArray *hugeArray = [[MUKNumericArray alloc] initWithType:MUKNumericTypeInt64 bytes:hugeValues count:3];
+    STAssertEquals([hugeArray sum], 1.0, @"Exact although partial sum wrapped around");
+    hugeArray = [[MUKNumericArray alloc] initWithType:MUKNumericTypeInt64 bytes:hugeValues count:4];
+    STAssertEquals([hugeArray sum], 0x1p63, @"Approximated when out of range");
+    
+    // Conversions from double saturate
+    MUKNumericArray *saturatedArray = [[MUKNumericArray alloc] initWithType:MUKNumericTypeInt32 array:@[@1, @2, @3] map:^double(id obj, NSInteger index)
+    {
+        double const results[] = { NAN, 1e20, -INFINITY };
+        return results[index];
+    }];
+    int32_t const *saturatedValues = [saturatedArray bytes];
+    STAssertEquals(saturatedValues[0], (int32_t)0, @"NaN becomes 0");
+    STAssertEquals(saturatedValues[1], (int32_t)INT32_MAX, nil);
+    STAssertEquals(saturatedValues[2], (int32_t)INT32_MIN, nil);
+    
+    saturatedArray = [[MUKNumericArray alloc] initWithType:MUKNumericTypeInt64 count:1];
+    [saturatedArray setDouble:1e30 atIndex:0];
+    STAssertEquals(((int64_t const *)[saturatedArray bytes])[0], (int64_t)INT64_MAX, nil);
+    STAssertEquals(((int64_t const *)[[saturatedArray arrayByMultiplyingBy:-2.0 adding:0.0] bytes])[0], (int64_t)INT64_MIN, nil);
+    
+    STAssertThrows([[MUKNumericArray alloc] initWithType:MUKNumericTypeDouble count:NSUIntegerMax], @"Size overflows");
+    
+    // Unboxed mapping
+    NSArray *strings = @[@"a", @"bb", @"ccc"];
+    MUKNumericArray *lengths = [[MUKNumericArray alloc] initWithType:MUKNumericTypeInt32 array:strings map:^double(id obj, NSInteger index)
+    {
+        return [obj length];
+    }];
+    STAssertEquals(((int32_t const *)[lengths bytes])[2], (int32_t)3, nil);
+    
+    // Large arrays
+    MUKNumericArray *largeArray = [[MUKNumericArray alloc] initWithType:MUKNumericTypeFloat count:1000];
+    float *values = [largeArray mutableBytes];
+    for (NSInteger i = 0; i < 1000; i++) {
+        values[i] = (float)i;
+    }
+    STAssertEquals([largeArray sum], 499500.0, nil);
+    STAssertEquals([[largeArray arrayByApplyingTransform:MUKArrayTransformReverse] doubleAtIndex:0], 999.0, nil);
+}
+
+- (void)testDiffing {
+    NSArray *oldArray = @[@"a", @"b", @"c", @"d", @"e"];
+    NSArray *newArray = @[@"b", @"a", @"c", @"f", @"e"];
+    
+    MUKArrayDiff *diff = [MUK diffFromArray:oldArray toArray:newArray algorithm:MUKArrayDiffAlgorithmHash identity:nil equality:nil];
+    STAssertTrue([diff hasChanges], nil);
+    STAssertEqualObjects([diff deletedIndexes], [NSIndexSet indexSetWithIndex:3], nil);
+    STAssertEqualObjects([diff insertedIndexes], [NSIndexSet indexSetWithIndex:3], nil);
+    STAssertEquals([[diff updatedIndexes] count], (NSUInteger)0, nil);
+    STAssertEquals([[diff movedIndexes] count], (NSUInteger)1, @"Only one move needed to swap a and b");
+    STAssertEquals([diff newIndexForOldIndex:0], (NSUInteger)1, nil);
+    STAssertEquals([diff oldIndexForNewIndex:3], (NSUInteger)NSNotFound, nil);
+    
+    // Myers never moves
+    diff = [MUK diffFromArray:oldArray toArray:newArray algorithm:MUKArrayDiffAlgorithmMyers identity:nil equality:nil];
+    STAssertEquals([[diff movedIndexes] count], (NSUInteger)0, nil);
+    STAssertEquals([[diff deletedIndexes] count], (NSUInteger)2, @"d and one of a, b");
+    STAssertEquals([[diff insertedIndexes] count], (NSUInteger)2, @"f and one of a, b");
+    
+    // Identity and equality
+    oldArray = @[@{@"id": @1, @"title": @"One"}, @{@"id": @2, @"title": @"Two"}];
+    newArray = @[@{@"id": @2, @"title": @"Two!"}, @{@"id": @1, @"title": @"One"}];
+    diff = [MUK diffFromArray:oldArray toArray:newArray algorithm:MUKArrayDiffAlgorithmHash identity:^id(id obj) {
+        return obj[@"id"];
+    } equality:^BOOL(id oldObj, id newObj) {
+        return [oldObj[@"title"] isEqualToString:newObj[@"title"]];
+    }];
+    STAssertEqualObjects([diff updatedIndexes], [NSIndexSet indexSetWithIndex:1], nil);
+    STAssertEquals([[diff deletedIndexes] count] + [[diff insertedIndexes] count], (NSUInteger)0, nil);
+    
+    __block NSUInteger moveCount = 0;
+    [diff enumerateMovesUsingBlock:^(NSUInteger fromIndex, NSUInteger toIndex, BOOL *stop) {
+        STAssertEquals([diff newIndexForOldIndex:fromIndex], toIndex, nil);
+        moveCount++;
+    }];
+    STAssertEquals(moveCount, (NSUInteger)1, nil);
+    
+    // Applying changes rebuilds new array
+    NSMutableArray *largeOldArray = [NSMutableArray array];
+    for (NSInteger i = 0; i < 2000; i++) {
+        [largeOldArray addObject:@(i % 700)];
+    }
+    NSMutableArray *largeNewArray = [largeOldArray mutableCopy];
+    [largeNewArray removeObjectsInRange:NSMakeRange(100, 50)];
+    [largeNewArray exchangeObjectAtIndex:10 withObjectAtIndex:1500];
+    [largeNewArray insertObject:@"new" atIndex:600];
+    
+    MUKArrayDiffAlgorithm algorithms[] = { MUKArrayDiffAlgorithmHash, MUKArrayDiffAlgorithmMyers };
+    for (NSInteger a = 0; a < 2; a++) {
+        diff = [MUK diffFromArray:largeOldArray toArray:largeNewArray algorithm:algorithms[a] identity:nil equality:nil];
+        
+        NSMutableArray *rebuiltArray = [NSMutableArray arrayWithCapacity:[largeNewArray count]];
+        for (NSUInteger j = 0; j < [largeNewArray count]; j++) {
+            NSUInteger oldIndex = [diff oldIndexForNewIndex:j];
+            
+            if (oldIndex == NSNotFound) {
+                STAssertTrue([[diff insertedIndexes] containsIndex:j], nil);
+                [rebuiltArray addObject:largeNewArray[j]];
+            }
+            else {
+                STAssertFalse([[diff deletedIndexes] containsIndex:oldIndex], nil);
+                [rebuiltArray addObject:largeOldArray[oldIndex]];
+            }
+        }
+        
+        STAssertEqualObjects(rebuiltArray, largeNewArray, nil);
+        STAssertEquals([largeOldArray count] - [[diff deletedIndexes] count] + [[diff insertedIndexes] count], [largeNewArray count], nil);
+    } // for
 }
 
 @end
@@ -26,6 +26,10 @@
 #import "MUKToolkitBaseTests.h"
 #import "MUK.h"
 #import "MUK+Date.h"
+#import "MUKCompletion.h"
+#import "MUKBitset.h"
+#import "MUK+Instrumentation.h"
+#import "MUK+Data.h"
 
 @implementation MUKToolkitBaseTests
 
@@ -37,6 +41,76 @@
     
     bitmask = (bitmask | flag);
     STAssertTrue([MUK bitmask:bitmask containsFlag:flag], @"%i contained in %i", flag, bitmask);
+    STAssertTrue(MUKBitmaskContainsFlag(bitmask, flag), @"Inline function should agree with method");
+    STAssertFalse(MUKBitmaskContainsFlag(bitmask, (1<<3)), @"Inline function should agree with method");
+}
+
+- (void)testBitset {
+    MUKBitset *bitset = [[MUKBitset alloc] initWithCapacity:100];
+    STAssertEquals([bitset count], (NSUInteger)0, @"Empty");
+    STAssertEquals([bitset firstIndex], (NSUInteger)NSNotFound, @"Empty");
+    
+    [bitset addIndex:3];
+    [bitset addIndexesInRange:NSMakeRange(60, 10)];
+    [bitset addIndex:1000];
+    STAssertEquals([bitset count], (NSUInteger)12, @"Count");
+    STAssertTrue([bitset containsIndex:65], @"Index in range");
+    STAssertFalse([bitset containsIndex:70], @"Index after range");
+    STAssertTrue([bitset containsIndexesInRange:NSMakeRange(60, 10)], @"Range crosses a word");
+    STAssertEquals([bitset countOfIndexesInRange:NSMakeRange(0, 64)], (NSUInteger)5, @"Count of first word");
+    STAssertEquals([bitset firstIndex], (NSUInteger)3, @"First index");
+    STAssertEquals([bitset lastIndex], (NSUInteger)1000, @"Bitset grows");
+    STAssertEquals([bitset indexGreaterThanIndex:69], (NSUInteger)1000, @"Next index");
+    
+    // Rank and select
+    STAssertEquals([bitset rankOfIndex:3], (NSUInteger)0, @"Rank of first index");
+    STAssertEquals([bitset rankOfIndex:65], (NSUInteger)6, @"Rank");
+    STAssertEquals([bitset rankOfIndex:5000], (NSUInteger)12, @"Rank beyond bitset");
+    STAssertEquals([bitset indexWithRank:6], (NSUInteger)65, @"Select");
+    STAssertEquals([bitset indexWithRank:11], (NSUInteger)1000, @"Select last");
+    STAssertEquals([bitset indexWithRank:12], (NSUInteger)NSNotFound, @"Select beyond count");
+    
+    [bitset removeIndex:60];
+    STAssertEquals([bitset rankOfIndex:65], (NSUInteger)5, @"Ranks follow changes");
+    
+    NSMutableArray *enumeratedIndexes = [NSMutableArray array];
+    [bitset enumerateIndexesInRange:NSMakeRange(2, 65) usingBlock:^(NSUInteger index, BOOL *stop) {
+        [enumeratedIndexes addObject:@(index)];
+    }];
+    NSArray *expectedIndexes = @[@3, @61, @62, @63, @64, @65, @66];
+    STAssertEqualObjects(enumeratedIndexes, expectedIndexes, @"Enumerated indexes");
+    
+    // Index sets
+    NSMutableIndexSet *indexSet = [NSMutableIndexSet indexSetWithIndexesInRange:NSMakeRange(61, 9)];
+    [indexSet addIndex:3];
+    [indexSet addIndex:1000];
+    STAssertEqualObjects([bitset indexSet], indexSet, @"Conversion to index set");
+    STAssertEqualObjects([[MUKBitset alloc] initWithIndexSet:indexSet], bitset, @"Conversion from index set");
+    
+    // Set operations
+    MUKBitset *evenBitset = [[MUKBitset alloc] init];
+    for (NSUInteger i = 0; i < 200; i += 2) {
+        [evenBitset addIndex:i];
+    } // for
+    
+    MUKBitset *unionBitset = [bitset copy];
+    [unionBitset unionWithBitset:evenBitset];
+    STAssertEquals([unionBitset count], (NSUInteger)(100 + 7), @"Union adds odd indexes and 1000");
+    
+    MUKBitset *intersectionBitset = [bitset copy];
+    [intersectionBitset intersectWithBitset:evenBitset];
+    STAssertEquals([intersectionBitset count], (NSUInteger)4, @"Intersection");
+    STAssertEquals([intersectionBitset firstIndex], (NSUInteger)62, @"Intersection");
+    STAssertEquals([intersectionBitset lastIndex], (NSUInteger)68, @"Intersection");
+    
+    MUKBitset *differenceBitset = [bitset copy];
+    [differenceBitset minusBitset:evenBitset];
+    STAssertEquals([differenceBitset count], (NSUInteger)(11 - 4), @"Difference");
+    STAssertTrue([differenceBitset containsIndex:1000], @"Index beyond other bitset");
+    
+    [bitset removeAllIndexes];
+    STAssertEquals([bitset count], (NSUInteger)0, @"Removed indexes");
+    STAssertEqualObjects(bitset, [[MUKBitset alloc] init], @"Trailing zero words do not matter");
 }
 
 - (void)testWaitForCompletion {
@@ -107,4 +181,120 @@
     dispatch_release(asyncQueue);
 }
 
+- (void)testCompletion {
+    dispatch_queue_t asyncQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    
+    // Blocking wait, signalled from another thread
+    MUKCompletion *completion = [[MUKCompletion alloc] init];
+    STAssertFalse([completion isCompleted], nil);
+    
+    __block BOOL firstSignalCompleted = NO, secondSignalCompleted = YES;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, 0.2 * NSEC_PER_SEC), asyncQueue, ^{
+        firstSignalCompleted = [completion signal];
+        secondSignalCompleted = [completion signal];
+    });
+    
+    NSTimeInterval waitDuration = 0.0;
+    STAssertTrue([completion waitWithTimeout:5.0 waitDuration:&waitDuration], nil);
+    STAssertTrue([completion isCompleted], nil);
+    STAssertTrue(firstSignalCompleted, @"First signal completes");
+    STAssertFalse(secondSignalCompleted, @"Further signals do nothing");
+    STAssertTrue(waitDuration >= 0.15 && waitDuration < 2.0, @"Woken when signalled (%f s)", waitDuration);
+    
+    // Already completed
+    STAssertTrue([completion waitWithTimeout:0.1 waitDuration:&waitDuration], nil);
+    
+    // Run loop wait, signalled by a block which needs main queue
+    completion = [[MUKCompletion alloc] init];
+    dispatch_async(asyncQueue, ^{
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [completion signal];
+        });
+    });
+    STAssertTrue([completion waitWithTimeout:5.0 runLoop:nil waitDuration:&waitDuration], nil);
+    
+    // Run loop wait, signalled from another thread
+    completion = [[MUKCompletion alloc] init];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, 0.1 * NSEC_PER_SEC), asyncQueue, ^{
+        [completion signal];
+    });
+    STAssertTrue([completion waitWithTimeout:5.0 runLoop:nil waitDuration:&waitDuration], nil);
+    STAssertTrue(waitDuration < 2.0, @"Run loop woken by signal");
+    
+    // Timeout
+    completion = [[MUKCompletion alloc] init];
+    STAssertFalse([completion waitWithTimeout:0.2 waitDuration:&waitDuration], nil);
+    STAssertTrue(waitDuration >= 0.15, nil);
+    STAssertFalse([completion waitWithTimeout:0.2 runLoop:nil waitDuration:NULL], nil);
+    
+    // Many completions
+    NSMutableArray *completions = [NSMutableArray array];
+    for (NSInteger i = 0; i < 8; i++) {
+        [completions addObject:[[MUKCompletion alloc] init]];
+    }
+    
+    STAssertEquals([MUKCompletion waitForAnyCompletion:completions timeout:0.1 runLoop:nil waitDuration:NULL], (NSUInteger)NSNotFound, @"Timeout");
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, 0.1 * NSEC_PER_SEC), asyncQueue, ^{
+        [completions[5] signal];
+    });
+    STAssertEquals([MUKCompletion waitForAnyCompletion:completions timeout:5.0 runLoop:nil waitDuration:NULL], (NSUInteger)5, nil);
+    
+    [completions[2] signal];
+    STAssertEquals([MUKCompletion waitForAnyCompletion:completions timeout:5.0 runLoop:nil waitDuration:NULL], (NSUInteger)5, @"First signalled completion");
+    STAssertFalse([MUKCompletion waitForAllCompletions:completions timeout:0.1 runLoop:nil waitDuration:NULL], nil);
+    
+    for (MUKCompletion *pendingCompletion in completions) {
+        dispatch_async(asyncQueue, ^{
+            [pendingCompletion signal];
+        });
+    }
+    STAssertTrue([MUKCompletion waitForAllCompletions:completions timeout:5.0 runLoop:[NSRunLoop currentRunLoop] waitDuration:&waitDuration], nil);
+    STAssertTrue([MUKCompletion waitForAllCompletions:@[] timeout:0.1 runLoop:nil waitDuration:NULL], @"Nothing to wait for");
+}
+
+- (void)testInstrumentation {
+    [MUK resetInstrumentation];
+    
+    NSData *data = [@"Instrumented" dataUsingEncoding:NSUTF8StringEncoding];
+    for (NSInteger i = 0; i < 3; i++) {
+        [MUK data:data applyingTransform:MUKDataTransformSHA1];
+    }
+    
+    NSDictionary *snapshot = [MUK instrumentationSnapshot];
+    NSString *json = [MUK instrumentationJSONString];
+    
+    if (![MUK isInstrumentationEnabled]) {
+        STAssertEquals([snapshot count], (NSUInteger)0, @"Nothing recorded without instrumentation");
+        STAssertEqualObjects(json, @"{}", nil);
+        return;
+    }
+    
+    NSString *methodName = nil;
+    for (NSString *name in snapshot) {
+        if ([name rangeOfString:@"data:applyingTransform:"].location != NSNotFound) {
+            methodName = name;
+        }
+    }
+    
+    STAssertNotNil(methodName, @"Method recorded");
+    
+    NSDictionary *counters = snapshot[methodName];
+    STAssertEquals([counters[@"calls"] unsignedLongLongValue], 3ULL, nil);
+    STAssertEquals([counters[@"bytes"] unsignedLongLongValue], 3ULL * [data length], nil);
+    STAssertTrue([counters[@"maxTime"] doubleValue] <= [counters[@"totalTime"] doubleValue], nil);
+    
+    // Counters from other threads are aggregated
+    dispatch_apply(4, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+        [MUK data:data applyingTransform:MUKDataTransformSHA1];
+    });
+    
+    counters = [MUK instrumentationSnapshot][methodName];
+    STAssertEquals([counters[@"calls"] unsignedLongLongValue], 7ULL, nil);
+    STAssertTrue([json hasPrefix:@"{\""] && [json hasSuffix:@"}"], @"JSON object");
+    
+    [MUK resetInstrumentation];
+    STAssertNil([MUK instrumentationSnapshot][methodName], @"Reset");
+}
+
 @end
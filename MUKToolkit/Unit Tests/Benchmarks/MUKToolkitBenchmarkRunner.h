@@ -0,0 +1,68 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import <Foundation/Foundation.h>
+
+/*
+ Runs micro-benchmarks of toolkit categories with many input sizes and
+ produces machine-readable results.
+ 
+ Every result is a dictionary with:
+ 
+ * `name`, benchmark name (e.g. `data.digest.SHA1`);
+ * `size`, input size (bytes, characters or objects, depending on benchmark);
+ * `opsPerSecond`, `nsPerOp` and `bytesPerSecond`;
+ * `retainedBlocksPerOp`, net growth of live heap blocks per operation 
+ before autorelease pool is drained (only where malloc zone statistics are 
+ available, so not on Linux). It is not a count of allocations: blocks
+ allocated and freed within an operation do not show up.
+ 
+ Benchmarks of Foundation-only categories (string, data, array, date) have no
+ UIKit dependency, so they run headless as a command line tool, on OS X or on
+ Linux with GNUstep: the Makefile in this directory builds runner and toolkit
+ sources with `-DMUK_BENCHMARK_MAIN`, which adds a `main` taking output and
+ baseline paths as arguments. Digests come from OpenSSL where CommonCrypto is
+ missing. Color, geometry and image benchmarks run on iOS only, testing
+ MUKToolkitBenchmarks target, which compares to 
+ MUKToolkitBenchmarksBaseline.json.
+ */
+@interface MUKToolkitBenchmarkRunner : NSObject
+// Minimum measured time of every benchmark and size (default: 0.2 s)
+@property (nonatomic) NSTimeInterval minimumDuration;
+// Allowed slowdown respect to baseline (default: 0.3, which is 30%)
+@property (nonatomic) double tolerance;
+
+// Runs every benchmark
+- (NSArray *)run;
+
+// Runs every benchmark, writes JSON results to outputPath and compares them
+// to baseline. Results missing from baseline are added to it, so a missing
+// or empty baseline is recorded by first run. If updateBaseline is YES
+// results replace baseline. Returns descriptions of regressions.
+- (NSArray *)runWritingResultsToPath:(NSString *)outputPath comparingToBaselineAtPath:(NSString *)baselinePath updateBaseline:(BOOL)updateBaseline;
+
+// Compares results with the same name and size
++ (NSArray *)regressionsOfResults:(NSArray *)results comparedToBaseline:(NSArray *)baseline tolerance:(double)tolerance;
+@end
@@ -0,0 +1,472 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUKToolkitBenchmarkRunner.h"
+#import "MUK+String.h"
+#import "MUK+Data.h"
+#import "MUK+Array.h"
+#import "MUK+Date.h"
+
+#if TARGET_OS_IPHONE
+#import "MUK+Color.h"
+#import "MUK+Geometry.h"
+#import "MUK+Image.h"
+#endif
+
+#ifdef __APPLE__
+#include <malloc/malloc.h>
+#endif
+
+// Batches are grown until they take this long, so clock reads do not count
+#define MUK_BENCHMARK_MINIMUM_BATCH_DURATION    0.01
+
+static BOOL MUKBenchmarkLiveBlocks(double *count) {
+#ifdef __APPLE__
+    malloc_statistics_t statistics;
+    malloc_zone_statistics(NULL, &statistics);
+    *count = (double)statistics.blocks_in_use;
+    return YES;
+#else
+    // No malloc zones to ask: results leave retained blocks out
+    *count = 0.0;
+    return NO;
+#endif
+}
+
+@implementation MUKToolkitBenchmarkRunner {
+    NSMutableArray *results_;
+}
+
+@synthesize minimumDuration = minimumDuration_;
+@synthesize tolerance = tolerance_;
+
+- (id)init {
+    self = [super init];
+    if (self) {
+        minimumDuration_ = 0.2;
+        tolerance_ = 0.3;
+    }
+    
+    return self;
+}
+
+- (NSArray *)run {
+    results_ = [[NSMutableArray alloc] init];
+    
+    [self runStringBenchmarks_];
+    [self runDataBenchmarks_];
+    [self runArrayBenchmarks_];
+    [self runDateBenchmarks_];
+
+#if TARGET_OS_IPHONE
+    [self runColorBenchmarks_];
+    [self runGeometryBenchmarks_];
+    [self runImageBenchmarks_];
+#endif
+
+    NSArray *results = [results_ copy];
+    results_ = nil;
+    return results;
+}
+
+- (NSArray *)runWritingResultsToPath:(NSString *)outputPath comparingToBaselineAtPath:(NSString *)baselinePath updateBaseline:(BOOL)updateBaseline
+{
+    NSArray *results = [self run];
+    NSData *data = [NSJSONSerialization dataWithJSONObject:results options:NSJSONWritingPrettyPrinted error:nil];
+    
+    if (outputPath) {
+        [data writeToFile:outputPath atomically:YES];
+    }
+    
+    if (baselinePath == nil) return @[];
+    
+    if (updateBaseline) {
+        [data writeToFile:baselinePath atomically:YES];
+        return @[];
+    }
+    
+    NSData *baselineData = [NSData dataWithContentsOfFile:baselinePath];
+    NSArray *baseline = (baselineData ? [NSJSONSerialization JSONObjectWithData:baselineData options:0 error:nil] : nil);
+    if (![baseline isKindOfClass:[NSArray class]]) {
+        baseline = @[];
+    }
+    
+    // Results missing from baseline (new benchmarks, or a baseline not
+    // recorded yet) become part of it
+    NSArray *mergedBaseline = [[self class] baseline_:baseline mergingResults:results];
+    if ([mergedBaseline count] > [baseline count]) {
+        NSData *mergedData = [NSJSONSerialization dataWithJSONObject:mergedBaseline options:NSJSONWritingPrettyPrinted error:nil];
+        [mergedData writeToFile:baselinePath atomically:YES];
+    }
+    
+    return [[self class] regressionsOfResults:results comparedToBaseline:baseline tolerance:tolerance_];
+}
+
++ (NSArray *)regressionsOfResults:(NSArray *)results comparedToBaseline:(NSArray *)baseline tolerance:(double)tolerance
+{
+    NSMutableDictionary *baselineByKey = [NSMutableDictionary dictionaryWithCapacity:[baseline count]];
+    for (NSDictionary *result in baseline) {
+        baselineByKey[[self keyOfResult_:result]] = result;
+    } // for
+    
+    NSMutableArray *regressions = [NSMutableArray array];
+    for (NSDictionary *result in results) {
+        NSString *key = [self keyOfResult_:result];
+        NSDictionary *baselineResult = baselineByKey[key];
+        if (baselineResult == nil) continue;
+        
+        double const time = [result[@"nsPerOp"] doubleValue];
+        double const baselineTime = [baselineResult[@"nsPerOp"] doubleValue];
+        
+        if (baselineTime > 0.0 && time > baselineTime * (1.0 + tolerance)) {
+            [regressions addObject:[NSString stringWithFormat:@"%@: %.1f ns/op, baseline %.1f ns/op (+%.0f%%)", key, time, baselineTime, (time / baselineTime - 1.0) * 100.0]];
+        }
+    } // for
+    
+    return regressions;
+}
+
+#pragma mark - Private
+
++ (NSString *)keyOfResult_:(NSDictionary *)result {
+    return [NSString stringWithFormat:@"%@/%@", result[@"name"], result[@"size"]];
+}
+
++ (NSArray *)baseline_:(NSArray *)baseline mergingResults:(NSArray *)results {
+    NSMutableSet *keys = [NSMutableSet setWithCapacity:[baseline count]];
+    for (NSDictionary *result in baseline) {
+        [keys addObject:[self keyOfResult_:result]];
+    } // for
+    
+    NSMutableArray *mergedBaseline = [baseline mutableCopy];
+    for (NSDictionary *result in results) {
+        if (![keys containsObject:[self keyOfResult_:result]]) {
+            [mergedBaseline addObject:result];
+        }
+    } // for
+    
+    return mergedBaseline;
+}
+
+- (void)measure_:(NSString *)name size:(NSUInteger)size bytesPerOperation:(NSUInteger)bytesPerOperation block:(void (^)(void))block
+{
+    // Warm up
+    @autoreleasepool {
+        block();
+    }
+    
+    NSUInteger batchSize = 1, operationsCount = 0;
+    double retainedBlocksCount = 0.0;
+    BOOL retainedBlocksAvailable = YES;
+    NSTimeInterval elapsedTime = 0.0;
+    
+    while (elapsedTime < minimumDuration_) {
+        NSTimeInterval batchTime;
+        
+        @autoreleasepool {
+            double liveBlocksBefore = 0.0, liveBlocksAfter = 0.0;
+            retainedBlocksAvailable = MUKBenchmarkLiveBlocks(&liveBlocksBefore) && retainedBlocksAvailable;
+            
+            NSTimeInterval const startTime = [NSDate timeIntervalSinceReferenceDate];
+            for (NSUInteger i = 0; i < batchSize; i++) {
+                block();
+            } // for
+            batchTime = [NSDate timeIntervalSinceReferenceDate] - startTime;
+            
+            if (MUKBenchmarkLiveBlocks(&liveBlocksAfter)) {
+                retainedBlocksCount += MAX(liveBlocksAfter - liveBlocksBefore, 0.0);
+            }
+        }
+        
+        elapsedTime += batchTime;
+        operationsCount += batchSize;
+        
+        if (batchTime < MUK_BENCHMARK_MINIMUM_BATCH_DURATION) {
+            batchSize *= 2;
+        }
+    } // while
+    
+    double const opsPerSecond = (double)operationsCount / elapsedTime;
+    NSMutableDictionary *result = [NSMutableDictionary dictionary];
+    result[@"name"] = name;
+    result[@"size"] = @(size);
+    result[@"opsPerSecond"] = @(opsPerSecond);
+    result[@"nsPerOp"] = @(elapsedTime * 1.0e9 / (double)operationsCount);
+    result[@"bytesPerSecond"] = @(opsPerSecond * (double)bytesPerOperation);
+    
+    if (retainedBlocksAvailable) {
+        result[@"retainedBlocksPerOp"] = @(retainedBlocksCount / (double)operationsCount);
+    }
+    
+    [results_ addObject:result];
+}
+
+- (NSArray *)sizes_ {
+    return @[@16, @1024, @65536];
+}
+
+- (NSString *)stringWithLength_:(NSUInteger)length {
+    static char const alphabet[] = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789&=/?%";
+    NSMutableString *string = [NSMutableString stringWithCapacity:length];
+    
+    for (NSUInteger i = 0; i < length; i++) {
+        [string appendFormat:@"%c", alphabet[(i * 7919) % (sizeof(alphabet) - 1)]];
+    } // for
+    
+    return string;
+}
+
+- (NSData *)dataWithLength_:(NSUInteger)length {
+    NSMutableData *data = [NSMutableData dataWithLength:length];
+    unsigned char *bytes = [data mutableBytes];
+    
+    for (NSUInteger i = 0; i < length; i++) {
+        bytes[i] = (unsigned char)((i * 2654435761u) >> 24);
+    } // for
+    
+    return data;
+}
+
+#pragma mark - Private: Foundation
+
+- (void)runStringBenchmarks_ {
+    NSDictionary *transforms = @{
+        @"Reverse": @(MUKStringTransformReverse),
+        @"URLEncode": @(MUKStringTransformURLEncode),
+        @"URLDecode": @(MUKStringTransformURLDecode),
+        @"UppercaseFirstLetter": @(MUKStringTransformUppercaseFirstLetter),
+        @"SHA1": @(MUKStringTransformSHA1),
+        @"MD5": @(MUKStringTransformMD5),
+        @"Normalize": @(MUKStringTransformNormalize)
+    };
+    
+    for (NSNumber *size in [self sizes_]) {
+        NSUInteger const length = [size unsignedIntegerValue];
+        NSString *string = [self stringWithLength_:length];
+        
+        for (NSString *transformName in [[transforms allKeys] sortedArrayUsingSelector:@selector(compare:)])
+        {
+            MUKStringTransform const transform = [transforms[transformName] unsignedIntegerValue];
+            NSString *name = [@"string.transform." stringByAppendingString:transformName];
+            
+            [self measure_:name size:length bytesPerOperation:length * sizeof(unichar) block:^{
+                [MUK string:string applyingTransform:transform];
+            }];
+        } // for
+        
+        NSData *data = [self dataWithLength_:length];
+        [self measure_:@"string.hexadecimal" size:length bytesPerOperation:length block:^{
+            [MUK stringHexadecimalRepresentationOfData:data];
+        }];
+        
+        // Many short fields through a chain of transforms
+        NSUInteger const fieldsCount = MAX(length / 32, (NSUInteger)1);
+        NSMutableArray *fields = [NSMutableArray arrayWithCapacity:fieldsCount];
+        for (NSUInteger i = 0; i < fieldsCount; i++) {
+            [fields addObject:[self stringWithLength_:32]];
+        }
+        
+        NSArray *chain = @[@(MUKStringTransformNormalize), @(MUKStringTransformUppercaseFirstLetter), @(MUKStringTransformSHA1)];
+        [self measure_:@"string.batch" size:length bytesPerOperation:fieldsCount * 32 * sizeof(unichar) block:^{
+            [MUK strings:fields applyingTransforms:chain];
+        }];
+    } // for
+}
+
+- (void)runDataBenchmarks_ {
+    for (NSNumber *size in [self sizes_]) {
+        NSUInteger const length = [size unsignedIntegerValue];
+        NSData *data = [self dataWithLength_:length];
+        
+        [self measure_:@"data.digest.SHA1" size:length bytesPerOperation:length block:^{
+            [MUK data:data applyingTransform:MUKDataTransformSHA1];
+        }];
+        
+        [self measure_:@"data.digest.MD5" size:length bytesPerOperation:length block:^{
+            [MUK data:data applyingTransform:MUKDataTransformMD5];
+        }];
+        
+        [self measure_:@"data.compress.deflate" size:length bytesPerOperation:length block:^{
+            [MUK data:data applyingTransform:MUKDataTransformDeflate];
+        }];
+        
+        [self measure_:@"data.compress.LZ4" size:length bytesPerOperation:length block:^{
+            [MUK data:data applyingTransform:MUKDataTransformLZ4Compress];
+        }];
+    } // for
+}
+
+- (void)runArrayBenchmarks_ {
+    for (NSNumber *size in [self sizes_]) {
+        NSUInteger const count = [size unsignedIntegerValue];
+        NSMutableArray *array = [NSMutableArray arrayWithCapacity:count];
+        
+        for (NSUInteger i = 0; i < count; i++) {
+            [array addObject:@(i)];
+        } // for
+        
+        [self measure_:@"array.map" size:count bytesPerOperation:count * sizeof(id) block:^{
+            [MUK array:array map:^id(id obj, NSInteger index, BOOL *exclude, BOOL *stop) {
+                return obj;
+            }];
+        }];
+        
+        // Enumerate reversed array, so views are not measured empty-handed
+        [self measure_:@"array.reverse" size:count bytesPerOperation:count * sizeof(id) block:^{
+            NSUInteger visitedCount = 0;
+            for (id object in [MUK array:array applyingTransform:MUKArrayTransformReverse]) {
+                visitedCount += (object != nil);
+            } // for
+        }];
+    } // for
+}
+
+- (void)runDateBenchmarks_ {
+    NSCalendar *calendar = [[NSCalendar alloc] initWithCalendarIdentifier:NSGregorianCalendar];
+    calendar.timeZone = [NSTimeZone timeZoneWithName:@"Europe/Rome"];
+    
+    for (NSNumber *size in [self sizes_]) {
+        NSUInteger const count = [size unsignedIntegerValue];
+        NSMutableArray *dates = [NSMutableArray arrayWithCapacity:count];
+        NSTimeInterval *timeIntervals = malloc(count * sizeof(NSTimeInterval));
+        NSInteger *dayKeys = malloc(count * sizeof(NSInteger));
+        
+        for (NSUInteger i = 0; i < count; i++) {
+            timeIntervals[i] = 400000000.0 + (NSTimeInterval)i * 3333.0;
+            [dates addObject:[NSDate dateWithTimeIntervalSinceReferenceDate:timeIntervals[i]]];
+        } // for
+        
+        [self measure_:@"date.sameDay" size:count bytesPerOperation:0 block:^{
+            for (NSUInteger i = 1; i < count; i++) {
+                [MUK date:dates[i] isInTheSameDayOfDate:dates[i-1] usingCalendar:calendar];
+            } // for
+        }];
+        
+        [self measure_:@"date.dayKeys" size:count bytesPerOperation:count * sizeof(NSTimeInterval) block:^{
+            [MUK timeIntervals:timeIntervals count:count getDayKeys:dayKeys usingCalendar:calendar];
+        }];
+        
+        free(timeIntervals);
+        free(dayKeys);
+    } // for
+}
+
+#if TARGET_OS_IPHONE
+
+#pragma mark - Private: UIKit
+
+- (void)runColorBenchmarks_ {
+    for (NSNumber *size in [self sizes_]) {
+        NSUInteger const count = [size unsignedIntegerValue];
+        NSMutableArray *strings = [NSMutableArray arrayWithCapacity:count];
+        
+        for (NSUInteger i = 0; i < count; i++) {
+            [strings addObject:[NSString stringWithFormat:@"#%06lX", (unsigned long)((i * 2654435761u) & 0xFFFFFF)]];
+        } // for
+        
+        [self measure_:@"color.hexadecimal" size:count bytesPerOperation:count * 7 * sizeof(unichar) block:^{
+            for (NSString *string in strings) {
+                [MUK colorWithHexadecimalString:string];
+            } // for
+        }];
+    } // for
+}
+
+- (void)runGeometryBenchmarks_ {
+    CGRect const baseRect = CGRectMake(0.0, 0.0, 320.0, 480.0);
+    
+    for (NSNumber *size in [self sizes_]) {
+        NSUInteger const count = [size unsignedIntegerValue];
+        CGRect *rects = malloc(count * sizeof(CGRect));
+        
+        for (NSUInteger i = 0; i < count; i++) {
+            rects[i] = CGRectMake((CGFloat)(i % 97), (CGFloat)(i % 89), 10.0 + (CGFloat)(i % 300), 10.0 + (CGFloat)(i % 500));
+        } // for
+        
+        [self measure_:@"geometry.transform" size:count bytesPerOperation:count * sizeof(CGRect) block:^{
+            for (NSUInteger i = 0; i < count; i++) {
+                MUKGeometryTransform const transform = (MUKGeometryTransform)(i % (MUKGeometryTransformBottomRight + 1));
+                [MUK rect:rects[i] transform:transform respectToRect:baseRect];
+            } // for
+        }];
+        
+        free(rects);
+    } // for
+}
+
+- (void)runImageBenchmarks_ {
+    NSArray *sides = @[@64, @256, @1024];
+    
+    for (NSNumber *side in sides) {
+        CGSize const size = CGSizeMake([side floatValue], [side floatValue]);
+        
+        UIGraphicsBeginImageContextWithOptions(size, YES, 1.0);
+        [[UIColor orangeColor] setFill];
+        UIRectFill(CGRectMake(0.0, 0.0, size.width, size.height * 0.5));
+        [[UIColor purpleColor] setFill];
+        UIRectFill(CGRectMake(0.0, size.height * 0.5, size.width, size.height * 0.5));
+        UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+        UIGraphicsEndImageContext();
+        
+        NSUInteger const pixelsCount = (NSUInteger)(size.width * size.height);
+        [self measure_:@"image.blur" size:pixelsCount bytesPerOperation:pixelsCount * 4 block:^{
+            [MUK image:image applyingBlurWithRadius:20.0 iterationsCount:3 tintColor:nil saturationDeltaFactor:1.8 maskImage:nil];
+        }];
+        
+        [self measure_:@"image.palette" size:pixelsCount bytesPerOperation:pixelsCount * 4 block:^{
+            [MUK paletteOfImage:image maximumColorsCount:5];
+        }];
+        
+        [self measure_:@"image.blend" size:pixelsCount bytesPerOperation:pixelsCount * 8 block:^{
+            [MUK image:image blendedWithImage:image fraction:0.5];
+        }];
+    } // for
+}
+
+#endif
+
+@end
+
+#ifdef MUK_BENCHMARK_MAIN
+
+// Usage: benchmarks [output.json [baseline.json [--update-baseline]]]
+int main(int argc, char const *argv[]) {
+    @autoreleasepool {
+        NSString *outputPath = (argc > 1 ? @(argv[1]) : nil);
+        NSString *baselinePath = (argc > 2 ? @(argv[2]) : nil);
+        BOOL const updateBaseline = (argc > 3 && strcmp(argv[3], "--update-baseline") == 0);
+        
+        MUKToolkitBenchmarkRunner *runner = [[MUKToolkitBenchmarkRunner alloc] init];
+        NSArray *regressions = [runner runWritingResultsToPath:outputPath comparingToBaselineAtPath:baselinePath updateBaseline:updateBaseline];
+        
+        for (NSString *regression in regressions) {
+            fprintf(stderr, "Regression: %s\n", [regression UTF8String]);
+        } // for
+        
+        return ([regressions count] > 0 ? 1 : 0);
+    }
+}
+
+#endif
@@ -0,0 +1,59 @@
+// Copyright (c) 2014, Marco Muccinelli
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// * Neither the name of the <organization> nor the
+// names of its contributors may be used to endorse or promote products
+// derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MUKToolkitBenchmarks.h"
+#import "MUKToolkitBenchmarkRunner.h"
+
+/*
+ Built by MUKToolkitBenchmarks target only (test it to run benchmarks), so
+ unit tests stay fast. Environment variables of the scheme:
+    MUK_BENCHMARK_OUTPUT            where results JSON is written
+    MUK_BENCHMARK_BASELINE          baseline JSON to compare with
+    MUK_BENCHMARK_UPDATE_BASELINE   overwrite baseline with results
+ */
+@implementation MUKToolkitBenchmarks
+
+- (void)testBenchmarks {
+    NSDictionary *environment = [[NSProcessInfo processInfo] environment];
+    
+    NSString *outputPath = environment[@"MUK_BENCHMARK_OUTPUT"];
+    if (outputPath == nil) {
+        outputPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"MUKToolkitBenchmarks.json"];
+    }
+    
+    NSString *baselinePath = environment[@"MUK_BENCHMARK_BASELINE"];
+    if (baselinePath == nil) {
+        NSString *sourceDirectory = [@(__FILE__) stringByDeletingLastPathComponent];
+        baselinePath = [sourceDirectory stringByAppendingPathComponent:@"MUKToolkitBenchmarksBaseline.json"];
+    }
+    
+    MUKToolkitBenchmarkRunner *runner = [[MUKToolkitBenchmarkRunner alloc] init];
+    NSArray *regressions = [runner runWritingResultsToPath:outputPath comparingToBaselineAtPath:baselinePath updateBaseline:(environment[@"MUK_BENCHMARK_UPDATE_BASELINE"] != nil)];
+    
+    STAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:outputPath], @"Results should be written");
+    STAssertEquals([regressions count], (NSUInteger)0, @"Regressions found: %@", regressions);
+}
+
+@end
@@ -112,4 +112,30 @@
     STAssertEqualsWithAccuracy(a, transformedAlpha, 0.0001f, nil);
 }
 
+- (void)testColorBlend {
+    CGFloat r, g, b, a;
+    UIColor *color = [MUK color:[UIColor redColor] blendedWithColor:[UIColor blueColor] fraction:0.5f];
+    [color getRed:&r green:&g blue:&b alpha:&a];
+    
+    // Half linear light is 0.735 in sRGB, not 0.5
+    STAssertEqualsWithAccuracy(r, (CGFloat)0.7354f, 0.001f, @"Blended in linear light");
+    STAssertEqualsWithAccuracy(g, (CGFloat)0.0f, 0.0001f, nil);
+    STAssertEqualsWithAccuracy(b, (CGFloat)0.7354f, 0.001f, @"Blended in linear light");
+    STAssertEqualsWithAccuracy(a, (CGFloat)1.0f, 0.0001f, nil);
+    
+    color = [MUK color:[UIColor redColor] blendedWithColor:[UIColor blueColor] fraction:0.0f];
+    [color getRed:&r green:&g blue:&b alpha:&a];
+    STAssertEqualsWithAccuracy(r, (CGFloat)1.0f, 0.0001f, @"No blend");
+    STAssertEqualsWithAccuracy(b, (CGFloat)0.0f, 0.0001f, @"No blend");
+    
+    // Grayscale colors; transparent colors do not darken
+    color = [MUK color:[UIColor whiteColor] blendedWithColor:[UIColor clearColor] fraction:0.5f];
+    [color getRed:&r green:&g blue:&b alpha:&a];
+    STAssertEqualsWithAccuracy(r, (CGFloat)1.0f, 0.0001f, @"Transparent color does not darken");
+    STAssertEqualsWithAccuracy(a, (CGFloat)0.5f, 0.0001f, @"Alpha is interpolated");
+    
+    color = [UIColor colorWithPatternImage:[[UIImage alloc] init]];
+    STAssertNil([MUK color:color blendedWithColor:[UIColor redColor] fraction:0.5f], @"No RGBA components");
+}
+
 @end
@@ -26,6 +26,10 @@
 #import "MUKToolkitDataTests.h"
 #import "MUK+Data.h"
 #import "MUK+String.h"
+#import "MUK+URL.h"
+#import "MUKDiskCache.h"
+#import "MUKDataCompressionStream.h"
+#import "MUKChunkedData.h"
 #import <CommonCrypto/CommonDigest.h>
 
 @implementation MUKToolkitDataTests
@@ -87,4 +91,315 @@
     STAssertEqualObjects(expectedHash, [MUK stringHexadecimalRepresentationOfData:transformedData], @"MD5 of 'Hello' is '%@'", expectedHash);
 }
 
+- (void)testByteScanning {
+    NSMutableData *data = [NSMutableData data];
+    for (NSInteger i = 0; i < 100; i++) {
+        [data appendData:[@"lorem,ipsum;dolor\n" dataUsingEncoding:NSUTF8StringEncoding]];
+    } // for
+    
+    NSRange const wholeRange = NSMakeRange(0, NSUIntegerMax);
+    NSUInteger const lineLength = 18;
+    
+    STAssertEquals([MUK data:data indexOfByte:',' inRange:wholeRange], (NSUInteger)5, @"First comma");
+    STAssertEquals([MUK data:data indexOfByte:',' inRange:NSMakeRange(6, 100)], lineLength + 5, @"Comma of second line");
+    STAssertEquals([MUK data:data indexOfByte:'z' inRange:wholeRange], (NSUInteger)NSNotFound, @"Missing byte");
+    STAssertEquals([MUK data:data indexOfByte:',' inRange:NSMakeRange(10000, 10)], (NSUInteger)NSNotFound, @"Range out of data");
+    
+    NSMutableIndexSet *byteSet = [NSMutableIndexSet indexSet];
+    [byteSet addIndex:';'];
+    [byteSet addIndex:'\n'];
+    STAssertEquals([MUK data:data indexOfByteInSet:byteSet inRange:wholeRange], (NSUInteger)11, @"First delimiter");
+    STAssertEquals([MUK data:data indexOfByteInSet:byteSet inRange:NSMakeRange(12, 100)], (NSUInteger)17, @"Second delimiter");
+    
+    [byteSet addIndexesInRange:NSMakeRange('w', 4)];
+    STAssertEquals([MUK data:data indexOfByteInSet:byteSet inRange:wholeRange], (NSUInteger)11, @"Big set");
+    
+    NSData *pattern = [@"dolor\nlorem" dataUsingEncoding:NSUTF8StringEncoding];
+    STAssertEquals([MUK data:data rangeOfBytes:pattern inRange:wholeRange], NSMakeRange(12, [pattern length]), @"Subsequence found");
+    STAssertEquals([MUK data:data rangeOfBytes:pattern inRange:NSMakeRange(13, NSUIntegerMax)], NSMakeRange(lineLength + 12, [pattern length]), @"Subsequence found in range");
+    STAssertEquals([MUK data:data rangeOfBytes:pattern inRange:NSMakeRange([data length] - 10, 10)].location, (NSUInteger)NSNotFound, @"Subsequence does not fit");
+    STAssertEquals([MUK data:data rangeOfBytes:[NSData data] inRange:wholeRange].location, (NSUInteger)NSNotFound, @"Empty subsequence");
+    
+    STAssertEquals([MUK data:data countOfByte:'o'], (NSUInteger)300, @"Three o per line");
+    STAssertEquals([MUK data:data countOfByte:'z'], (NSUInteger)0, @"No z");
+    
+    NSUInteger histogram[256];
+    [MUK data:data getByteHistogram:histogram];
+    STAssertEquals(histogram['m'], (NSUInteger)200, @"Two m per line");
+    STAssertEquals(histogram['\n'], (NSUInteger)100, @"A newline per line");
+    
+    NSArray *ranges = [MUK data:data rangesSeparatedByByte:'\n'];
+    STAssertEquals([ranges count], (NSUInteger)101, @"Trailing newline gives an empty range");
+    STAssertEquals([ranges[1] rangeValue], NSMakeRange(lineLength, lineLength - 1), @"Second line");
+    STAssertEquals([[ranges lastObject] rangeValue], NSMakeRange([data length], 0), @"Empty last range");
+    
+    ranges = [MUK data:[NSData data] rangesSeparatedByByte:'\n'];
+    STAssertEquals([ranges count], (NSUInteger)1, @"Empty data gives a single range");
+    
+    __block NSUInteger enumeratedLength = 0;
+    __block NSUInteger spansCount = 0;
+    [MUK data:data enumerateSpansOfMaximumLength:512 usingBlock:^(unsigned char const *bytes, NSRange range, BOOL *stop)
+    {
+        STAssertEquals(range.location, enumeratedLength, @"Spans are consecutive");
+        STAssertTrue(memcmp(bytes, (unsigned char const *)[data bytes] + range.location, range.length) == 0, @"Span points to data");
+        enumeratedLength += range.length;
+        spansCount++;
+    }];
+    
+    STAssertEquals(enumeratedLength, [data length], @"Whole data enumerated");
+    STAssertEquals(spansCount, ([data length] + 511) / 512, @"Spans are limited");
+    
+    spansCount = 0;
+    [MUK data:data enumerateSpansOfMaximumLength:0 usingBlock:^(unsigned char const *bytes, NSRange range, BOOL *stop)
+    {
+        spansCount++;
+        *stop = YES;
+    }];
+    STAssertEquals(spansCount, (NSUInteger)1, @"Enumeration stopped");
+}
+
+- (void)testCompression {
+    NSMutableData *data = [NSMutableData data];
+    for (NSInteger i = 0; i < 20000; i++) {
+        [data appendData:[[NSString stringWithFormat:@"line %ld lorem ipsum dolor sit amet\n", (long)i] dataUsingEncoding:NSUTF8StringEncoding]];
+    } // for
+    
+    NSArray *transforms = @[
+        @[@(MUKDataTransformDeflate), @(MUKDataTransformInflate)],
+        @[@(MUKDataTransformGzip), @(MUKDataTransformGunzip)],
+        @[@(MUKDataTransformLZ4Compress), @(MUKDataTransformLZ4Decompress)]
+    ];
+    
+    for (NSArray *pair in transforms) {
+        MUKDataTransform const compression = [pair[0] unsignedIntegerValue];
+        MUKDataTransform const decompression = [pair[1] unsignedIntegerValue];
+        
+        NSData *compressedData = [MUK data:data applyingTransform:compression];
+        STAssertTrue([compressedData length] < [data length] / 4, @"Data is compressed");
+        STAssertEqualObjects([MUK data:compressedData applyingTransform:decompression], data, @"Round trip");
+        
+        NSData *truncatedData = [compressedData subdataWithRange:NSMakeRange(0, [compressedData length] - 5)];
+        STAssertNil([MUK data:truncatedData applyingTransform:decompression], @"Truncated data is refused");
+        
+        NSData *emptyData = [MUK data:[NSData data] applyingTransform:compression];
+        STAssertEqualObjects([MUK data:emptyData applyingTransform:decompression], [NSData data], @"Empty round trip");
+    } // for
+    
+    // Standard formats
+    unsigned char const lz4Bytes[] = {
+        0x04, 0x22, 0x4d, 0x18, 0x64, 0x40, 0xa7, 0x0f, 0x00, 0x00, 0x00, 0x6e,
+        0x68, 0x65, 0x6c, 0x6c, 0x6f, 0x20, 0x06, 0x00, 0x50, 0x68, 0x65, 0x6c,
+        0x6c, 0x6f, 0x00, 0x00, 0x00, 0x00, 0x79, 0xb1, 0xff, 0xf9
+    };
+    
+    unsigned char const gzipBytes[] = {
+        0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xcb, 0x48,
+        0xcd, 0xc9, 0xc9, 0x57, 0xc8, 0xc0, 0x4e, 0x02, 0x00, 0xf6, 0xd2, 0x53,
+        0x38, 0x1d, 0x00, 0x00, 0x00
+    };
+    
+    NSData *helloData = [@"hello hello hello hello hello" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *lz4Data = [NSData dataWithBytes:lz4Bytes length:sizeof(lz4Bytes)];
+    NSData *gzipData = [NSData dataWithBytes:gzipBytes length:sizeof(gzipBytes)];
+    
+    STAssertEqualObjects([MUK data:lz4Data applyingTransform:MUKDataTransformLZ4Decompress], helloData, @"Frame written by lz4 command");
+    STAssertEqualObjects([MUK data:helloData applyingTransform:MUKDataTransformLZ4Compress], lz4Data, @"Same frame as lz4 command");
+    STAssertEqualObjects([MUK data:gzipData applyingTransform:MUKDataTransformGunzip], helloData, @"Data written by gzip command");
+    
+    unsigned char const *gzipHeader = [[MUK data:helloData applyingTransform:MUKDataTransformGzip] bytes];
+    STAssertTrue(gzipHeader[0] == 0x1f && gzipHeader[1] == 0x8b, @"gzip magic number");
+    
+    NSMutableData *corruptedData = [lz4Data mutableCopy];
+    ((unsigned char *)[corruptedData mutableBytes])[[corruptedData length] - 1] ^= 0xFF;
+    STAssertNil([MUK data:corruptedData applyingTransform:MUKDataTransformLZ4Decompress], @"Checksum mismatch");
+    
+    // Streams, chunk by chunk
+    for (NSNumber *format in @[@(MUKDataCompressionFormatZlib), @(MUKDataCompressionFormatGzip), @(MUKDataCompressionFormatLZ4)])
+    {
+        for (NSNumber *level in @[@(MUKDataCompressionLevelFastest), @(MUKDataCompressionLevelBest)])
+        {
+            MUKDataCompressionStream *compressor = [[MUKDataCompressionStream alloc] initForCompressionWithFormat:[format unsignedIntegerValue] level:[level integerValue]];
+            MUKDataCompressionStream *decompressor = [[MUKDataCompressionStream alloc] initForDecompressionWithFormat:[format unsignedIntegerValue]];
+            NSMutableData *compressedData = [NSMutableData data];
+            NSMutableData *decompressedData = [NSMutableData data];
+            
+            for (NSUInteger offset = 0; offset < [data length]; offset += 10000) {
+                NSData *chunk = [data subdataWithRange:NSMakeRange(offset, MIN((NSUInteger)10000, [data length] - offset))];
+                [compressedData appendData:[compressor processData:chunk]];
+            } // for
+            [compressedData appendData:[compressor finish]];
+            STAssertNil([compressor processData:data], @"Finished stream");
+            
+            for (NSUInteger offset = 0; offset < [compressedData length]; offset += 777) {
+                NSData *chunk = [compressedData subdataWithRange:NSMakeRange(offset, MIN((NSUInteger)777, [compressedData length] - offset))];
+                NSData *output = [decompressor processData:chunk];
+                STAssertNotNil(output, @"Valid chunk");
+                [decompressedData appendData:output];
+            } // for
+            
+            NSData *finalOutput = [decompressor finish];
+            STAssertNotNil(finalOutput, @"Complete data");
+            [decompressedData appendData:finalOutput];
+            
+            STAssertEqualObjects(decompressedData, data, @"Round trip by chunks");
+        } // for
+    } // for
+}
+
+- (void)testChunkedData {
+    NSData *line = [@"lorem,ipsum;dolor\n" dataUsingEncoding:NSUTF8StringEncoding];
+    NSMutableData *flatData = [NSMutableData data];
+    MUKMutableChunkedData *chunkedData = [[MUKMutableChunkedData alloc] init];
+    
+    // Segments of different length, so boundaries fall everywhere
+    for (NSInteger i = 0; i < 100; i++) {
+        [flatData appendData:line];
+    } // for
+    
+    for (NSUInteger location = 0; location < [flatData length]; ) {
+        NSUInteger const length = MIN((NSUInteger)(location % 7 + 1), [flatData length] - location);
+        [chunkedData appendData:[flatData subdataWithRange:NSMakeRange(location, length)]];
+        location += length;
+    } // for
+    
+    STAssertEquals([chunkedData length], [flatData length], @"Same length");
+    STAssertTrue([chunkedData segmentsCount] > 100, @"Many segments");
+    STAssertEqualObjects(chunkedData, flatData, @"Same bytes");
+    STAssertEqualObjects(flatData, [chunkedData flattenedData], @"Same bytes once flattened");
+    STAssertEquals([chunkedData hash], [flatData hash], @"Equal data has equal hash");
+    
+    // Spans
+    __block NSUInteger enumeratedLength = 0;
+    __block BOOL contiguous = YES;
+    [chunkedData enumerateSpansInRange:NSMakeRange(10, 50) usingBlock:^(unsigned char const *bytes, NSRange range, BOOL *stop)
+    {
+        contiguous = contiguous && (range.location == 10 + enumeratedLength);
+        contiguous = contiguous && (memcmp(bytes, (unsigned char const *)[flatData bytes] + range.location, range.length) == 0);
+        enumeratedLength += range.length;
+    }];
+    STAssertTrue(contiguous, @"Spans follow each other");
+    STAssertEquals(enumeratedLength, (NSUInteger)50, @"Whole range enumerated");
+    
+    // Slices
+    NSRange const sliceRange = NSMakeRange(20, 100);
+    NSData *slice = [chunkedData subdataWithRange:sliceRange];
+    STAssertTrue([slice isKindOfClass:[MUKChunkedData class]], @"Slices are chunked");
+    STAssertEqualObjects(slice, [flatData subdataWithRange:sliceRange], @"Slice bytes");
+    STAssertEqualObjects([slice subdataWithRange:NSMakeRange(3, 4)], [flatData subdataWithRange:NSMakeRange(23, 4)], @"Slice of slice");
+    STAssertThrowsSpecificNamed([chunkedData subdataWithRange:NSMakeRange([flatData length], 1)], NSException, NSRangeException, @"Slice out of bounds");
+    
+    // Copies are snapshots
+    NSData *snapshot = [chunkedData copy];
+    [chunkedData appendData:line];
+    STAssertEquals([snapshot length], [flatData length], @"Snapshot does not grow");
+    STAssertEquals([chunkedData length], [flatData length] + [line length], @"Chunked data grows");
+    [flatData appendData:line];
+    
+    // Nested chunked data
+    MUKMutableChunkedData *nestedData = [[MUKMutableChunkedData alloc] init];
+    [nestedData appendData:snapshot];
+    [nestedData appendData:line];
+    STAssertEqualObjects(nestedData, flatData, @"Nested chunked data");
+    
+    // MUK(Data) never needs contiguous bytes
+    NSRange const wholeRange = NSMakeRange(0, NSUIntegerMax);
+    NSData *pattern = [@"dolor\nlorem" dataUsingEncoding:NSUTF8StringEncoding];
+    STAssertEquals([MUK data:nestedData rangeOfBytes:pattern inRange:wholeRange], [MUK data:flatData rangeOfBytes:pattern inRange:wholeRange], @"Subsequence across segments");
+    STAssertEquals([MUK data:nestedData rangeOfBytes:pattern inRange:NSMakeRange(13, NSUIntegerMax)], [MUK data:flatData rangeOfBytes:pattern inRange:NSMakeRange(13, NSUIntegerMax)], @"Subsequence across segments in range");
+    STAssertEquals([MUK data:nestedData indexOfByte:'\n' inRange:NSMakeRange(20, 100)], [MUK data:flatData indexOfByte:'\n' inRange:NSMakeRange(20, 100)], @"Byte");
+    STAssertEquals([MUK data:nestedData countOfByte:'o'], [MUK data:flatData countOfByte:'o'], @"Count");
+    STAssertEqualObjects([MUK data:nestedData rangesSeparatedByByte:','], [MUK data:flatData rangesSeparatedByByte:','], @"Components");
+    
+    NSUInteger chunkedHistogram[256], flatHistogram[256];
+    [MUK data:nestedData getByteHistogram:chunkedHistogram];
+    [MUK data:flatData getByteHistogram:flatHistogram];
+    STAssertTrue(memcmp(chunkedHistogram, flatHistogram, sizeof(flatHistogram)) == 0, @"Histogram");
+    
+    STAssertEqualObjects([MUK data:nestedData applyingTransform:MUKDataTransformSHA1], [MUK data:flatData applyingTransform:MUKDataTransformSHA1], @"SHA1");
+    STAssertEqualObjects([MUK data:nestedData applyingTransform:MUKDataTransformMD5], [MUK data:flatData applyingTransform:MUKDataTransformMD5], @"MD5");
+    
+    NSData *compressedData = [MUK data:nestedData applyingTransform:MUKDataTransformLZ4Compress];
+    STAssertEqualObjects(compressedData, [MUK data:flatData applyingTransform:MUKDataTransformLZ4Compress], @"LZ4");
+    STAssertEqualObjects([MUK data:compressedData applyingTransform:MUKDataTransformLZ4Decompress], flatData, @"LZ4 round trip");
+    STAssertEqualObjects([MUK data:[MUK data:nestedData applyingTransform:MUKDataTransformGzip] applyingTransform:MUKDataTransformGunzip], flatData, @"Gzip round trip");
+}
+
+- (void)testDiskCache {
+    NSURL *directoryURL = [[MUK URLForTemporaryDirectory] URLByAppendingPathComponent:@"MUKDiskCacheTest" isDirectory:YES];
+    [[NSFileManager defaultManager] removeItemAtURL:directoryURL error:nil];
+    
+    MUKDiskCache *cache = [[MUKDiskCache alloc] initWithDirectoryURL:directoryURL sizeLimit:1000 ageLimit:0.0];
+    NSData *data = [@"hello" dataUsingEncoding:NSUTF8StringEncoding];
+    
+    STAssertNil([cache dataForKey:@"a"], @"Empty cache");
+    STAssertTrue([cache setData:data forKey:@"a"], @"Data stored");
+    STAssertEqualObjects([cache dataForKey:@"a"], data, @"Data read back");
+    STAssertTrue([cache containsDataForKey:@"a"], @"Entry exists");
+    STAssertEquals(cache.totalSize, (unsigned long long)[data length], @"Size is tracked");
+    
+    // Entry file is named after SHA-1 digest of key, sharded by first byte
+    NSData *keyDigest = [MUK data:[@"a" dataUsingEncoding:NSUTF8StringEncoding] applyingTransform:MUKDataTransformSHA1];
+    NSString *hexDigest = [MUK stringHexadecimalRepresentationOfData:keyDigest];
+    NSString *entryPath = [[[directoryURL path] stringByAppendingPathComponent:[hexDigest substringToIndex:2]] stringByAppendingPathComponent:[hexDigest substringFromIndex:2]];
+    STAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:entryPath], @"Sharded file");
+    
+    // Content addressing
+    NSString *key = [cache addData:data];
+    STAssertEqualObjects(key, [MUK string:@"hello" applyingTransform:MUKStringTransformSHA1], @"Key is digest of content");
+    STAssertEqualObjects([cache dataForKey:key], data, @"Data read back");
+    
+    [cache removeDataForKey:key];
+    STAssertFalse([cache containsDataForKey:key], @"Entry removed");
+    
+    // Batch
+    NSMutableDictionary *dataByKeys = [NSMutableDictionary dictionary];
+    for (NSInteger i = 0; i < 5; i++) {
+        NSMutableData *entryData = [NSMutableData dataWithLength:100];
+        memset([entryData mutableBytes], (int)i, 100);
+        dataByKeys[[NSString stringWithFormat:@"batch%ld", (long)i]] = entryData;
+    } // for
+    
+    STAssertTrue([cache setDataByKeys:dataByKeys], @"Batch stored");
+    NSDictionary *readDataByKeys = [cache dataForKeys:[[dataByKeys allKeys] arrayByAddingObject:@"missing"]];
+    STAssertEqualObjects(readDataByKeys, dataByKeys, @"Batch read back, without missing key");
+    
+    // LRU eviction: "a" is used, so "batch*" entries are evicted first
+    [cache dataForKey:@"a"];
+    NSMutableData *bigData = [NSMutableData dataWithLength:800];
+    STAssertTrue([cache setData:bigData forKey:@"big"], @"Data stored");
+    STAssertTrue(cache.totalSize <= 1000, @"Size limit enforced");
+    STAssertTrue([cache containsDataForKey:@"a"], @"Recently used entry survives");
+    STAssertTrue([cache containsDataForKey:@"big"], @"New entry survives");
+    STAssertEquals(cache.count, (NSUInteger)3, @"Four oldest batch entries evicted");
+    
+    // Journal is replayed
+    NSUInteger const count = cache.count;
+    unsigned long long const totalSize = cache.totalSize;
+    cache = nil;
+    
+    cache = [[MUKDiskCache alloc] initWithDirectoryURL:directoryURL sizeLimit:1000 ageLimit:0.0];
+    STAssertEquals(cache.count, count, @"Same entries");
+    STAssertEquals(cache.totalSize, totalSize, @"Same size");
+    STAssertEqualObjects([cache dataForKey:@"big"], bigData, @"Data read back");
+    
+    // Asynchronous API
+    __block BOOL done = NO;
+    __block NSData *asyncData = nil;
+    [cache setData:data forKey:@"async" completionHandler:^(BOOL success) {
+        [cache dataForKey:@"async" completionHandler:^(NSData *readData) {
+            asyncData = readData;
+            done = YES;
+        }];
+    }];
+    
+    STAssertTrue([MUK waitForCompletion:&done timeout:5.0 runLoop:nil], @"Completion handlers called");
+    STAssertEqualObjects(asyncData, data, @"Data read back");
+    
+    [cache removeAllData];
+    STAssertEquals(cache.count, (NSUInteger)0, @"Cache is empty");
+    STAssertNil([cache dataForKey:@"big"], @"Entries removed");
+    
+    [[NSFileManager defaultManager] removeItemAtURL:directoryURL error:nil];
+}
+
 @end
@@ -104,4 +104,144 @@
     STAssertFalse([MUK date:now isEarlierThanDate:sameDate], @"Same date doesn't come before now");
 }
 
+- (void)testDayKeys {
+    NSArray *timeZoneNames = @[@"Europe/Rome", @"America/New_York", @"Australia/Lord_Howe", @"America/Sao_Paulo", @"UTC"];
+    
+    for (NSString *timeZoneName in timeZoneNames) {
+        NSCalendar *calendar = [[NSCalendar alloc] initWithCalendarIdentifier:NSGregorianCalendar];
+        calendar.timeZone = [NSTimeZone timeZoneWithName:timeZoneName];
+        
+        // Every 37 minutes for two years, crossing many transitions
+        NSUInteger const count = 2 * 365 * 24 * 60 / 37;
+        NSTimeInterval *timeIntervals = malloc(count * sizeof(NSTimeInterval));
+        NSInteger *dayKeys = malloc(count * sizeof(NSInteger));
+        
+        for (NSUInteger i = 0; i < count; i++) {
+            timeIntervals[i] = 350000000.0 + (NSTimeInterval)i * 37.0 * 60.0;
+        }
+        
+        [MUK timeIntervals:timeIntervals count:count getDayKeys:dayKeys usingCalendar:calendar];
+        
+        for (NSUInteger i = 1; i < count; i++) {
+            NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:timeIntervals[i]];
+            NSDate *previousDate = [NSDate dateWithTimeIntervalSinceReferenceDate:timeIntervals[i-1]];
+            
+            BOOL sameDay = [MUK date:date isInTheSameDayOfDate:previousDate usingCalendar:calendar];
+            STAssertEquals(sameDay, (BOOL)(dayKeys[i] == dayKeys[i-1]), @"Day keys agree with comparison in %@", timeZoneName);
+            STAssertEquals(dayKeys[i], [MUK dayKeyOfDate:date usingCalendar:calendar], @"Batch and single keys agree");
+            STAssertTrue(dayKeys[i] - dayKeys[i-1] <= 1, @"Keys do not skip days");
+        }
+        
+        free(timeIntervals);
+        free(dayKeys);
+    }
+    
+    // Array of dates
+    NSCalendar *calendar = [NSCalendar currentCalendar];
+    NSDate *now = [NSDate date];
+    NSArray *dates = @[now, [now dateByAddingTimeInterval:-3.0 * 86400.0], [now dateByAddingTimeInterval:1.0]];
+    NSInteger dayKeys[3];
+    
+    [MUK dates:dates getDayKeys:dayKeys usingCalendar:calendar];
+    STAssertEquals(dayKeys[0], [MUK dayKeyOfDate:now usingCalendar:calendar], nil);
+    STAssertEquals(dayKeys[0] - dayKeys[1], (NSInteger)3, nil);
+    STAssertEquals(dayKeys[0] == dayKeys[2], [MUK date:dates[0] isInTheSameDayOfDate:dates[2] usingCalendar:calendar], nil);
+    
+    // Reference date starts day 0 in UTC
+    calendar = [[NSCalendar alloc] initWithCalendarIdentifier:NSGregorianCalendar];
+    calendar.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+    STAssertEquals([MUK dayKeyOfDate:[NSDate dateWithTimeIntervalSinceReferenceDate:0.0] usingCalendar:calendar], (NSInteger)0, nil);
+    STAssertEquals([MUK dayKeyOfDate:[NSDate dateWithTimeIntervalSinceReferenceDate:-1.0] usingCalendar:calendar], (NSInteger)-1, nil);
+}
+
+- (void)testBatchNormalization {
+    NSArray *timeZoneNames = @[@"Europe/Rome", @"Asia/Kolkata", @"Australia/Lord_Howe", @"America/Sao_Paulo"];
+    NSArray *unitsArray = @[@(MUKDateOnlyCalendarUnits), @(MUKDateOnlyCalendarUnits|NSHourCalendarUnit), @(MUKDateOnlyCalendarUnits|NSHourCalendarUnit|NSMinuteCalendarUnit), @(NSYearCalendarUnit|NSMonthCalendarUnit|NSDayCalendarUnit), @(NSYearCalendarUnit|NSWeekdayCalendarUnit)];
+    
+    NSUInteger const count = 3000;
+    NSTimeInterval *timeIntervals = malloc(count * sizeof(NSTimeInterval));
+    NSTimeInterval *originalTimeIntervals = malloc(count * sizeof(NSTimeInterval));
+    
+    for (NSUInteger i = 0; i < count; i++) {
+        // About 4 hours apart, with fractions of second, for about a year
+        originalTimeIntervals[i] = 380000000.0 + (NSTimeInterval)i * 14417.25;
+    }
+    
+    for (NSString *timeZoneName in timeZoneNames) {
+        NSCalendar *calendar = [[NSCalendar alloc] initWithCalendarIdentifier:NSGregorianCalendar];
+        calendar.timeZone = [NSTimeZone timeZoneWithName:timeZoneName];
+        
+        for (NSNumber *unitsNumber in unitsArray) {
+            NSCalendarUnit units = [unitsNumber unsignedIntegerValue];
+            memcpy(timeIntervals, originalTimeIntervals, count * sizeof(NSTimeInterval));
+            
+            [MUK timeIntervals:timeIntervals count:count normalizeUsingCalendar:calendar units:units];
+            
+            for (NSUInteger i = 0; i < count; i++) {
+                NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:originalTimeIntervals[i]];
+                NSDate *expectedDate = [MUK date:date normalizeUsingCalendar:calendar units:units];
+                STAssertEquals(timeIntervals[i], [expectedDate timeIntervalSinceReferenceDate], @"Batch normalization agrees in %@", timeZoneName);
+            }
+        }
+    }
+    
+    free(timeIntervals);
+    free(originalTimeIntervals);
+}
+
+- (void)testISO8601 {
+    NSDate *date = [MUK dateFromISO8601String:@"2014-05-11T10:20:30.25+02:00"];
+    NSCalendar *calendar = [[NSCalendar alloc] initWithCalendarIdentifier:NSGregorianCalendar];
+    calendar.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+    
+    NSDateComponents *components = [calendar components:MUKDateAndTimeCalendarUnits fromDate:date];
+    STAssertEquals(components.year, (NSInteger)2014, nil);
+    STAssertEquals(components.month, (NSInteger)5, nil);
+    STAssertEquals(components.day, (NSInteger)11, nil);
+    STAssertEquals(components.hour, (NSInteger)8, @"Offset applied");
+    STAssertEquals(components.minute, (NSInteger)20, nil);
+    STAssertEquals(components.second, (NSInteger)30, nil);
+    STAssertEqualsWithAccuracy(fmod([date timeIntervalSinceReferenceDate], 1.0), 0.25, 1.0e-6, @"Fraction parsed");
+    
+    STAssertEqualObjects([MUK dateFromISO8601String:@"2001-01-01T00:00:00Z"], [NSDate dateWithTimeIntervalSinceReferenceDate:0.0], nil);
+    STAssertEqualObjects([MUK dateFromISO8601String:@"2001-01-01"], [NSDate dateWithTimeIntervalSinceReferenceDate:0.0], @"Date only");
+    STAssertEqualObjects([MUK dateFromISO8601String:@"2001-01-01 01:00:00+0100"], [NSDate dateWithTimeIntervalSinceReferenceDate:0.0], nil);
+    
+    NSArray *invalidStrings = @[@"", @"2014", @"2014-13-01", @"2013-02-29", @"2014-05-11T25:00Z", @"2014-05-11T10:20:30.Z", @"2014-05-11T10:20:30Z ", @"2014-05-11T10:20:30+2"];
+    for (NSString *string in invalidStrings) {
+        STAssertNil([MUK dateFromISO8601String:string], @"%@ is invalid", string);
+    }
+    
+    // Bytes
+    char const *bytes = "2014-05-11T10:20:30Zjunk";
+    NSTimeInterval timeInterval = 0.0;
+    STAssertTrue([MUK getTimeInterval:&timeInterval fromISO8601Bytes:bytes length:20], nil);
+    STAssertFalse([MUK getTimeInterval:&timeInterval fromISO8601Bytes:bytes length:strlen(bytes)], nil);
+    
+    // Formatting
+    STAssertEqualObjects([MUK ISO8601StringFromDate:[NSDate dateWithTimeIntervalSinceReferenceDate:0.5] timeZone:nil fractionDigits:3], @"2001-01-01T00:00:00.500Z", nil);
+    STAssertEqualObjects([MUK ISO8601StringFromDate:[NSDate dateWithTimeIntervalSinceReferenceDate:0.0] timeZone:[NSTimeZone timeZoneForSecondsFromGMT:-19800] fractionDigits:0], @"2000-12-31T18:30:00-05:30", nil);
+    STAssertEqualObjects([MUK ISO8601StringFromDate:[NSDate dateWithTimeIntervalSinceReferenceDate:0.9999] timeZone:nil fractionDigits:2], @"2001-01-01T00:00:01.00Z", @"Rounding carries");
+    
+    char buffer[32];
+    NSUInteger length = [MUK getISO8601Bytes:buffer maxLength:sizeof(buffer) fromTimeInterval:0.0 timeZoneOffset:3600 fractionDigits:6];
+    STAssertEquals(length, (NSUInteger)32, nil);
+    STAssertEquals([MUK getISO8601Bytes:buffer maxLength:10 fromTimeInterval:0.0 timeZoneOffset:0 fractionDigits:0], (NSUInteger)0, @"Buffer too short");
+    
+    // Round trip
+    for (NSInteger i = 0; i < 1000; i++) {
+        NSDate *originalDate = [NSDate dateWithTimeIntervalSinceReferenceDate:(NSTimeInterval)(i * 7919 * 3571) - 1.0e10];
+        NSString *string = [MUK ISO8601StringFromDate:originalDate timeZone:[NSTimeZone timeZoneWithName:@"Europe/Rome"] fractionDigits:0];
+        STAssertEqualObjects([MUK dateFromISO8601String:string], originalDate, @"Round trip of %@", string);
+    }
+    
+    // Batch
+    NSArray *strings = @[@"2001-01-01T00:00:00Z", [NSNull null], @"nope", @"2001-01-02T00:00:00.5Z"];
+    NSTimeInterval timeIntervals[4];
+    STAssertEquals([MUK ISO8601Strings:strings getTimeIntervals:timeIntervals], (NSUInteger)2, nil);
+    STAssertEquals(timeIntervals[0], 0.0, nil);
+    STAssertTrue(isnan(timeIntervals[1]) && isnan(timeIntervals[2]), nil);
+    STAssertEquals(timeIntervals[3], 86400.5, nil);
+}
+
 @end
@@ -25,6 +25,7 @@
 
 #import "MUKToolkitGeometryTests.h"
 #import "MUK+Geometry.h"
+#import "MUKGeometrySpatialIndex.h"
 
 @interface MUKToolkitGeometryTests ()
 - (CGPoint)centerOfRect_:(CGRect)rect;
@@ -253,6 +254,132 @@
     STAssertEqualsWithAccuracy(CGRectGetMaxY(transformedRect), CGRectGetMaxY(baseRect), 0.000000001, @"Stays at bottom");
 }
 
+- (void)testInlineFunctions {
+    // Expected values are hard-coded: methods wrap these same functions
+    CGFloat const accuracy = (CGFLOAT_IS_DOUBLE ? 0.000000001 : 0.0001);
+    
+    // Halfway cases round away from zero
+    CGRect roundedRect = MUKRectGeometricRounding(CGRectMake(0.5, -0.5, 2.5, 3.5), MUKGeometricDimensionRect);
+    STAssertTrue(CGRectEqualToRect(roundedRect, CGRectMake(1.0, -1.0, 3.0, 4.0)), @"Every rounding should be applied");
+    
+    CGPoint roundedPoint = MUKPointGeometricRounding(CGPointMake(1.5, -2.5), MUKGeometricDimensionY);
+    STAssertEqualsWithAccuracy(roundedPoint.x, (CGFloat)1.5, accuracy, @"x untouched");
+    STAssertEqualsWithAccuracy(roundedPoint.y, (CGFloat)-3.0, accuracy, @"y should be rounded");
+    
+    STAssertEqualsWithAccuracy(MUKGeometricRoundingOfValue(NAN), (CGFloat)0.0, accuracy, @"NaN should be converted to 0.0");
+    
+    // Aspect ratios are not representable in float: narrowing them would
+    // shift results beyond accuracy
+    CGRect rect = CGRectMake(0.0, 0.0, 70.0, 30.0);
+    CGRect baseRect = CGRectMake(10.0, 20.0, 400.0, 100.0);
+    
+    CGRect transformedRect = MUKRectTransform(rect, MUKGeometryTransformScaleAspectFit, baseRect);
+    STAssertEqualsWithAccuracy(transformedRect.origin.x, (CGFloat)(10.0 + (400.0 - 700.0/3.0)/2.0), accuracy, nil);
+    STAssertEqualsWithAccuracy(transformedRect.origin.y, (CGFloat)20.0, accuracy, nil);
+    STAssertEqualsWithAccuracy(transformedRect.size.width, (CGFloat)(700.0/3.0), accuracy, nil);
+    STAssertEqualsWithAccuracy(transformedRect.size.height, (CGFloat)100.0, accuracy, nil);
+    
+    transformedRect = MUKRectTransform(rect, MUKGeometryTransformScaleAspectFill, baseRect);
+    STAssertEqualsWithAccuracy(transformedRect.origin.x, (CGFloat)10.0, accuracy, nil);
+    STAssertEqualsWithAccuracy(transformedRect.origin.y, (CGFloat)(20.0 + (100.0 - 1200.0/7.0)/2.0), accuracy, nil);
+    STAssertEqualsWithAccuracy(transformedRect.size.width, (CGFloat)400.0, accuracy, nil);
+    STAssertEqualsWithAccuracy(transformedRect.size.height, (CGFloat)(1200.0/7.0), accuracy, nil);
+    
+    rect = CGRectMake(0.0, 0.0, 100.0, 300.0);
+    baseRect = CGRectMake(0.0, 0.0, 200.0, 200.0);
+    
+    transformedRect = MUKRectTransform(rect, MUKGeometryTransformScaleAspectFit, baseRect);
+    STAssertEqualsWithAccuracy(transformedRect.origin.x, (CGFloat)(200.0/3.0), accuracy, nil);
+    STAssertEqualsWithAccuracy(transformedRect.origin.y, (CGFloat)0.0, accuracy, nil);
+    STAssertEqualsWithAccuracy(transformedRect.size.width, (CGFloat)(200.0/3.0), accuracy, nil);
+    STAssertEqualsWithAccuracy(transformedRect.size.height, (CGFloat)200.0, accuracy, nil);
+    
+    transformedRect = MUKRectTransform(rect, MUKGeometryTransformScaleAspectFill, baseRect);
+    STAssertEqualsWithAccuracy(transformedRect.origin.x, (CGFloat)0.0, accuracy, nil);
+    STAssertEqualsWithAccuracy(transformedRect.origin.y, (CGFloat)-200.0, accuracy, nil);
+    STAssertEqualsWithAccuracy(transformedRect.size.width, (CGFloat)200.0, accuracy, nil);
+    STAssertEqualsWithAccuracy(transformedRect.size.height, (CGFloat)600.0, accuracy, nil);
+}
+
+- (void)testSpatialIndex {
+    // 10x10 grid of 10x10 cells
+    NSUInteger const kCount = 100;
+    CGRect rects[kCount];
+    for (NSUInteger i = 0; i < kCount; i++) {
+        rects[i] = CGRectMake((i % 10) * 10.0, (i / 10) * 10.0, 10.0, 10.0);
+    }
+    
+    MUKGeometrySpatialIndex *index = [[MUKGeometrySpatialIndex alloc] initWithRects:rects payloads:NULL count:kCount];
+    STAssertEquals(index.count, kCount, @"Every rect is loaded");
+    STAssertTrue(CGRectEqualToRect([index rectForEntry:42], rects[42]), @"Entry i is rects[i]");
+    STAssertEquals([index payloadForEntry:42], (NSUInteger)42, @"Payload defaults to index");
+    
+    // Hit-test
+    NSIndexSet *payloads = [index payloadsContainingPoint:CGPointMake(15.0, 25.0)];
+    STAssertEqualObjects(payloads, [NSIndexSet indexSetWithIndex:21], @"Only one cell contains point");
+    
+    payloads = [index payloadsContainingPoint:CGPointMake(200.0, 200.0)];
+    STAssertEquals([payloads count], (NSUInteger)0, @"No cell outside grid");
+    
+    // Viewport (touching edges do not intersect)
+    payloads = [index payloadsIntersectingRect:CGRectMake(10.0, 0.0, 20.0, 10.0)];
+    STAssertEqualObjects(payloads, [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(1, 2)], @"Two cells in viewport");
+    
+    // Brute force comparison
+    CGRect viewport = CGRectMake(23.0, 31.0, 40.0, 27.0);
+    NSMutableIndexSet *expectedPayloads = [NSMutableIndexSet indexSet];
+    for (NSUInteger i = 0; i < kCount; i++) {
+        if (CGRectIntersectsRect(rects[i], viewport)) {
+            [expectedPayloads addIndex:i];
+        }
+    }
+    STAssertEqualObjects([index payloadsIntersectingRect:viewport], expectedPayloads, @"Same result of a linear scan");
+    
+    // Move
+    STAssertTrue([index moveEntry:0 toRect:CGRectMake(500.0, 500.0, 10.0, 10.0)], @"Valid entry is moved");
+    STAssertEqualObjects([index payloadsContainingPoint:CGPointMake(505.0, 505.0)], [NSIndexSet indexSetWithIndex:0], @"Entry found in new position");
+    STAssertEquals([[index payloadsContainingPoint:CGPointMake(5.0, 5.0)] count], (NSUInteger)0, @"Entry not found in old position");
+    
+    // Insert
+    NSInteger entry = [index insertRect:CGRectMake(0.0, 0.0, 100.0, 100.0) payload:1000];
+    STAssertTrue(entry != NSNotFound, @"Rect inserted");
+    STAssertEquals(index.count, kCount + 1, @"Count updated");
+    payloads = [index payloadsContainingPoint:CGPointMake(15.0, 25.0)];
+    STAssertTrue([payloads containsIndex:21] && [payloads containsIndex:1000], @"Overlapping rects are both found");
+    STAssertEquals([index insertRect:CGRectNull payload:0], (NSInteger)NSNotFound, @"Null rect is not inserted");
+    STAssertEquals([index insertRect:CGRectInfinite payload:0], (NSInteger)NSNotFound, @"Infinite rect is not inserted");
+    
+    // Remove
+    STAssertTrue([index removeEntry:entry], @"Valid entry is removed");
+    STAssertFalse([index removeEntry:entry], @"Entry is not valid anymore");
+    STAssertEquals([index payloadForEntry:entry], (NSUInteger)NSNotFound, @"Entry is not valid anymore");
+    STAssertEqualObjects([index payloadsContainingPoint:CGPointMake(15.0, 25.0)], [NSIndexSet indexSetWithIndex:21], @"Removed rect not found");
+    
+    // Stop enumeration
+    __block NSInteger enumeratedCount = 0;
+    [index enumerateEntriesIntersectingRect:CGRectMake(0.0, 0.0, 100.0, 100.0) usingBlock:^(NSInteger entry, NSUInteger payload, CGRect rect, BOOL *stop)
+    {
+        enumeratedCount++;
+        *stop = YES;
+    }];
+    STAssertEquals(enumeratedCount, (NSInteger)1, @"Enumeration stopped");
+    
+    [index removeAllEntries];
+    STAssertEquals(index.count, (NSUInteger)0, @"Index is empty");
+    STAssertEquals([[index payloadsIntersectingRect:CGRectInfinite] count], (NSUInteger)0, @"Index is empty");
+    
+    // Bulk load skips rects which can not be stored
+    CGRect const mixedRects[] = { CGRectMake(0.0, 0.0, 10.0, 10.0), CGRectNull, CGRectInfinite, CGRectMake(20.0, 0.0, 10.0, 10.0) };
+    NSUInteger const mixedPayloads[] = { 7, 8, 9, 7 };
+    index = [[MUKGeometrySpatialIndex alloc] initWithRects:mixedRects payloads:mixedPayloads count:4];
+    STAssertEquals(index.count, (NSUInteger)2, @"Null and infinite rects are skipped");
+    STAssertEquals([index payloadForEntry:1], (NSUInteger)NSNotFound, @"Skipped entry is not valid");
+    STAssertEquals([index payloadForEntry:3], (NSUInteger)7, @"Later entries are not shifted");
+    STAssertTrue(CGRectEqualToRect([index rectForEntry:3], mixedRects[3]), @"Later entries are not shifted");
+    STAssertEquals([[index payloadsContainingPoint:CGPointMake(50.0, 50.0)] count], (NSUInteger)0, @"Bounds not corrupted");
+    STAssertEqualObjects([index payloadsIntersectingRect:CGRectMake(0.0, 0.0, 30.0, 10.0)], [NSIndexSet indexSetWithIndex:7], @"Duplicate payloads collapse");
+}
+
 #pragma mark - Private
 
 - (CGPoint)centerOfRect_:(CGRect)rect {
@@ -26,6 +26,8 @@
 
 #import <SenTestingKit/SenTestingKit.h>
 #import "MUK+Image.h"
+#import "MUKImagePalette.h"
+#import "MUKPixelKernels.h"
 
 @interface MUKToolkitImageTests : SenTestCase
 - (UIImage *)newImageOfSize:(CGSize)size;
@@ -60,6 +62,143 @@
     STAssertTrue(CGSizeEqualToSize(image.size, blurredImage.size), @"Image sizes match");
 }
 
+- (void)testPalette {
+    // 60% red, 30% blue, 10% transparent
+    NSUInteger const width = 400, height = 300, bytesPerRow = width * 4;
+    uint8_t *bytes = calloc(height, bytesPerRow);
+    
+    for (NSUInteger y = 0; y < height; y++) {
+        for (NSUInteger x = 0; x < width; x++) {
+            uint8_t *pixel = bytes + y * bytesPerRow + 4 * x;
+            
+            if (x < 240) {
+                pixel[0] = 200 + (x % 8);
+                pixel[1] = 30;
+                pixel[2] = 30;
+                pixel[3] = 255;
+            }
+            else if (x < 360) {
+                pixel[0] = 20;
+                pixel[1] = 20;
+                pixel[2] = 220;
+                pixel[3] = 255;
+            }
+        } // for
+    } // for
+    
+    MUKImagePalette *palette = [[MUKImagePalette alloc] initWithRGBABytes:bytes width:width height:height bytesPerRow:bytesPerRow maximumColorsCount:6 options:MUKImagePaletteOptionRefine];
+    free(bytes);
+    
+    STAssertEquals([palette.colors count], (NSUInteger)2, @"Shades of red are merged, transparent pixels are skipped");
+    STAssertTrue(palette.samplesCount > 0 && palette.samplesCount <= width * height, @"Pixels are sampled");
+    STAssertEqualsWithAccuracy([palette weightOfColorAtIndex:0], (CGFloat)(2.0/3.0), 0.02, @"Red weight");
+    STAssertEqualsWithAccuracy([palette weightOfColorAtIndex:1], (CGFloat)(1.0/3.0), 0.02, @"Blue weight");
+    STAssertThrows([palette weightOfColorAtIndex:2], @"Index out of bounds");
+    
+    CGFloat red, green, blue, alpha;
+    [[palette dominantColor] getRed:&red green:&green blue:&blue alpha:&alpha];
+    STAssertEqualsWithAccuracy(red, (CGFloat)(203.5/255.0), 2.0/255.0, @"Dominant color is mean red");
+    STAssertEqualsWithAccuracy(green, (CGFloat)(30.0/255.0), 1.0/255.0, @"Dominant color is mean red");
+    
+    // Images are drawn into a premultiplied buffer
+    UIGraphicsBeginImageContext(CGSizeMake(1000.0f, 1000.0f));
+    [[UIColor greenColor] setFill];
+    UIRectFill(CGRectMake(0.0f, 0.0f, 1000.0f, 1000.0f));
+    UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+    
+    palette = [MUK paletteOfImage:image maximumColorsCount:4];
+    STAssertEquals([palette.colors count], (NSUInteger)1, @"Single color");
+    STAssertTrue(palette.samplesCount <= 16384, @"Big images are sampled");
+    [[palette dominantColor] getRed:&red green:&green blue:&blue alpha:&alpha];
+    STAssertEqualsWithAccuracy(green, (CGFloat)1.0, 0.01, @"Green");
+    
+    STAssertNil([MUK paletteOfImage:[[UIImage alloc] init] maximumColorsCount:4], @"No CGImage");
+    STAssertNil([[[MUKImagePalette alloc] init] dominantColor], @"Empty palette");
+}
+
+- (void)testPixelKernels {
+    // 7 pixels: a vector of 4 plus a tail of 3
+    NSUInteger const count = 7;
+    uint8_t pixels[7 * 4], original[7 * 4];
+    for (NSUInteger i = 0; i < count * 4; i++) {
+        original[i] = (uint8_t)(i * 37 + 11);
+    }
+    
+    // Swizzle in place and back
+    memcpy(pixels, original, sizeof(pixels));
+    MUKPixelsSwizzle(pixels, MUKPixelFormatRGBA8888, pixels, MUKPixelFormatBGRA8888, count);
+    STAssertEquals(pixels[4 * 6], original[4 * 6 + 2], @"Blue comes first");
+    STAssertEquals(pixels[4 * 6 + 3], original[4 * 6 + 3], @"Alpha stays last");
+    
+    MUKPixelsSwizzle(pixels, MUKPixelFormatBGRA8888, pixels, MUKPixelFormatARGB8888, count);
+    STAssertEquals(pixels[4 * 6], original[4 * 6 + 3], @"Alpha comes first");
+    STAssertEquals(pixels[4 * 6 + 1], original[4 * 6], @"Red follows alpha");
+    
+    MUKPixelsSwizzle(pixels, MUKPixelFormatARGB8888, pixels, MUKPixelFormatRGBA8888, count);
+    STAssertTrue(memcmp(pixels, original, sizeof(pixels)) == 0, @"Swizzles are reversible");
+    
+    // Premultiply
+    memcpy(pixels, original, sizeof(pixels));
+    MUKPixelsPremultiply(pixels, MUKPixelFormatRGBA8888, count);
+    for (NSUInteger i = 0; i < count; i++) {
+        uint8_t const *pixel = original + 4 * i;
+        for (NSUInteger c = 0; c < 3; c++) {
+            STAssertEquals(pixels[4 * i + c], (uint8_t)((pixel[c] * pixel[3] + 127) / 255), @"Premultiplied component");
+        }
+        STAssertEquals(pixels[4 * i + 3], pixel[3], @"Alpha is untouched");
+    } // for
+    
+    // Unpremultiply
+    uint8_t pixel[4] = { 64, 32, 0, 128 };
+    MUKPixelsUnpremultiply(pixel, MUKPixelFormatRGBA8888, 1);
+    STAssertEquals(pixel[0], (uint8_t)128, nil);
+    STAssertEquals(pixel[1], (uint8_t)64, nil);
+    STAssertEquals(pixel[3], (uint8_t)128, nil);
+    
+    // sRGB to linear and back
+    uint16_t linear[7 * 4];
+    MUKPixelsConvertSRGBToLinear(original, linear, MUKPixelFormatBGRA8888, count);
+    MUKPixelsConvertLinearToSRGB(linear, pixels, MUKPixelFormatBGRA8888, count);
+    STAssertTrue(memcmp(pixels, original, sizeof(pixels)) == 0, @"Conversions are reversible");
+    
+    uint8_t const gray[4] = { 128, 128, 128, 255 };
+    MUKPixelsConvertSRGBToLinear(gray, linear, MUKPixelFormatRGBA8888, 1);
+    STAssertEqualsWithAccuracy(linear[0] / 65535.0, MUKPixelSRGBToLinear(128.0 / 255.0), 0.0001, @"Linear gray");
+    STAssertEquals(linear[3], (uint16_t)65535, @"Alpha is scaled");
+    
+    // Blend opaque red with transparent blue
+    uint16_t first[4] = { 65535, 0, 0, 65535 };
+    uint16_t const second[4] = { 0, 0, 65535, 0 };
+    MUKPixelsBlendLinear(first, second, MUKPixelFormatRGBA8888, 1, 0.5f);
+    STAssertEquals(first[0], (uint16_t)65535, @"Transparent pixels do not contribute color");
+    STAssertEquals(first[2], (uint16_t)0, @"Transparent pixels do not contribute color");
+    STAssertEquals(first[3], (uint16_t)32768, @"Alpha is interpolated");
+}
+
+- (void)testImageBlend {
+    UIGraphicsBeginImageContext(CGSizeMake(10.0f, 10.0f));
+    [[UIColor blackColor] setFill];
+    UIRectFill(CGRectMake(0.0f, 0.0f, 10.0f, 10.0f));
+    UIImage *blackImage = UIGraphicsGetImageFromCurrentImageContext();
+    
+    [[UIColor whiteColor] setFill];
+    UIRectFill(CGRectMake(0.0f, 0.0f, 10.0f, 10.0f));
+    UIImage *whiteImage = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+    
+    UIImage *image = [MUK image:blackImage blendedWithImage:whiteImage fraction:0.5f];
+    STAssertNotNil(image, @"Images are blended");
+    STAssertTrue(CGSizeEqualToSize(image.size, blackImage.size), @"Image sizes match");
+    
+    MUKImagePalette *palette = [[MUKImagePalette alloc] initWithImage:image maximumColorsCount:1 options:MUKImagePaletteOptionNone];
+    CGFloat red, green, blue, alpha;
+    [[palette dominantColor] getRed:&red green:&green blue:&blue alpha:&alpha];
+    STAssertEqualsWithAccuracy(green, (CGFloat)(188.0/255.0), 2.0/255.0, @"Half linear light");
+    
+    STAssertNil([MUK image:blackImage blendedWithImage:[[UIImage alloc] init] fraction:0.5f], @"No CGImage");
+}
+
 #pragma mark - Private
 
 - (UIImage *)newImageOfSize:(CGSize)size {
@@ -137,6 +137,40 @@
     STAssertEqualObjects(hash, expectedHash, @"MD5 hash of '%@' is '%@'", string, expectedHash);
 }
 
+- (void)testBatchTransforms {
+    NSMutableArray *strings = [NSMutableArray arrayWithObjects:@"hello", @"Purché", @"ßtraße", @"", @"😀 emoji", @"a%zz", @"%41b c", [NSNull null], nil];
+    for (NSUInteger i = 0; i < 1000; i++) {
+        [strings addObject:[NSString stringWithFormat:@"item %lu é", (unsigned long)i]];
+    }
+    
+    NSArray *chains = @[
+        @[@(MUKStringTransformNormalize), @(MUKStringTransformUppercaseFirstLetter), @(MUKStringTransformURLEncode)],
+        @[@(MUKStringTransformNormalize), @(MUKStringTransformSHA1)],
+        @[@(MUKStringTransformSHA1), @(MUKStringTransformMD5), @(MUKStringTransformSHA1)],
+        @[@(MUKStringTransformReverse), @(MUKStringTransformIdentity), @(MUKStringTransformReverse), @(MUKStringTransformUppercaseFirstLetter)],
+        @[@(MUKStringTransformURLDecode), @(MUKStringTransformReverse), @(MUKStringTransformMD5)],
+        @[]
+    ];
+    
+    for (NSArray *chain in chains) {
+        NSArray *transformedStrings = [MUK strings:strings applyingTransforms:chain];
+        STAssertEquals([transformedStrings count], [strings count], @"A result per string");
+        
+        [strings enumerateObjectsUsingBlock:^(id obj, NSUInteger idx, BOOL *stop) {
+            NSString *expected = ([obj isKindOfClass:[NSString class]] ? obj : nil);
+            for (NSNumber *transform in chain) {
+                if (expected == nil) break;
+                expected = [MUK string:expected applyingTransform:[transform unsignedIntegerValue]];
+            }
+            
+            STAssertEqualObjects([transformedStrings objectAtIndex:idx], (expected ?: [NSNull null]), @"Chain %@ of '%@' is the same of sequential transforms", chain, obj);
+        }];
+    } // for
+    
+    STAssertEqualObjects([MUK strings:@[@"Hello"] applyingTransforms:@[@(MUKStringTransformSHA1)]], @[@"f7ff9e8b7bb2e09b70935a5d785e0cc5d9d0abf0"], nil);
+    STAssertEqualObjects([MUK strings:nil applyingTransforms:@[@(MUKStringTransformSHA1)]], @[], @"No strings");
+}
+
 - (void)testNormalization {
     NSString *string = @"Hello";
     NSString *expected = @"hello";
@@ -25,6 +25,7 @@
 
 #import "MUKToolkitURLTests.h"
 #import "MUK+URL.h"
+#import "MUKImageResourceIndex.h"
 
 @implementation MUKToolkitURLTests
 
@@ -73,6 +74,54 @@
     image = [[UIImage alloc] initWithContentsOfFile:[imageURL path]];
     STAssertTrue([[imageURL path] rangeOfString:@"@2x"].location == NSNotFound, @"Image does not exist at high resolution");
     STAssertNotNil(image, @"Image does not exist at high resolution, but is returned at @1x");
+    
+    // Explicit variants
+    imageURL = [MUK URLForImageFileNamed:@"arrow@2x.png" bundle:bundle];
+    STAssertEqualObjects([imageURL lastPathComponent], @"arrow@2x.png", @"Explicit variant is found");
+    
+    imageURL = [MUK URLForImageFileWithName:@"arrow@2x" extension:@"png" bundle:bundle highResolution:NO];
+    STAssertEqualObjects([imageURL lastPathComponent], @"arrow@2x.png", @"Explicit variant is found");
+}
+
+- (void)testImageResourceIndex {
+    NSBundle *bundle = [NSBundle bundleForClass:[self class]];
+    MUKImageResourceIndex *index = [[MUKImageResourceIndex alloc] initWithBundle:bundle];
+    STAssertTrue(index.count > 0, @"Bundle is indexed");
+    
+    NSURL *imageURL = [index URLForResourceWithName:@"arrow" extension:@"png" scale:1.0];
+    STAssertEqualObjects([imageURL lastPathComponent], @"arrow.png", @"@1x variant");
+    
+    imageURL = [index URLForResourceWithName:@"arrow" extension:@"png" scale:2.0];
+    STAssertEqualObjects([imageURL lastPathComponent], @"arrow@2x.png", @"@2x variant");
+    
+    imageURL = [index URLForResourceWithName:@"arrow" extension:@"png" scale:3.0];
+    STAssertEqualObjects([imageURL lastPathComponent], @"arrow@2x.png", @"Best variant under @3x");
+    
+    imageURL = [index URLForResourceWithName:@"arrows" extension:@"png" scale:2.0];
+    STAssertEqualObjects([imageURL lastPathComponent], @"arrows.png", @"Falls back to @1x");
+    
+    imageURL = [index URLForResourceWithName:@"arrow" extension:@"jpg" scale:1.0];
+    STAssertNil(imageURL, @"Image does not exist");
+    
+    NSDictionary *URLs = [index URLsForResourceWithName:@"arrow" extension:@"png"];
+    STAssertEquals([URLs count], (NSUInteger)2, @"Two variants");
+    STAssertEqualObjects(URLs[@2], [index URLForResourceWithName:@"arrow" extension:@"png" scale:2.0], @"Same URL");
+    STAssertNil([index URLsForResourceWithName:@"gnegne" extension:@"jpg"], @"Image does not exist");
+    
+    STAssertEqualObjects([MUK URLForImageFileWithName:@"arrow" extension:@"png" bundle:bundle highResolution:YES], URLs[@2], @"Shared index gives same URL");
+    
+    // Persistence
+    NSURL *storeURL = [[MUK URLForTemporaryDirectory] URLByAppendingPathComponent:@"MUKImageResourceIndexTest.plist"];
+    [[NSFileManager defaultManager] removeItemAtURL:storeURL error:nil];
+    
+    MUKImageResourceIndex *storedIndex = [[MUKImageResourceIndex alloc] initWithBundle:bundle persistentStoreURL:storeURL];
+    STAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:[storeURL path]], @"Index is stored");
+    
+    MUKImageResourceIndex *loadedIndex = [[MUKImageResourceIndex alloc] initWithBundle:bundle persistentStoreURL:storeURL];
+    STAssertEquals(loadedIndex.count, storedIndex.count, @"Same resources");
+    STAssertEqualObjects([loadedIndex URLsForResourceWithName:@"arrow" extension:@"png"], URLs, @"Same URLs");
+    
+    [[NSFileManager defaultManager] removeItemAtURL:storeURL error:nil];
 }
 
 @end